@@ -1,6 +1,9 @@
 struct Attributes
 {
-    float3 pos : POSITION;
+    float2 pos : POSITION;
+
+    float4 basis : BASIS;
+    float2 translation : TRANSLATION;
     float4 color : COLOR;
 };
 
@@ -18,8 +21,10 @@ cbuffer CameraBuffer : register(b0)
 
 Varyings main(Attributes attribs)
 {
+    float2 world = attribs.basis.xy * attribs.pos.x + attribs.basis.zw * attribs.pos.y + attribs.translation;
+
     Varyings varyings;
-    varyings.pos = mul(mul(float4(attribs.pos, 1.0), matrix_v), matrix_p);
+    varyings.pos = mul(mul(float4(world, 0.0, 1.0), matrix_v), matrix_p);
     varyings.color = attribs.color;
     return varyings;
 }
\ No newline at end of file
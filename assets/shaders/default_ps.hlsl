@@ -9,8 +9,8 @@ SamplerState point_sampler : register(s0);
 
 float4 main(Varyings varyings) : SV_TARGET
 {
+    // The atlas is baked with premultiplied alpha
     float4 col = tex.Sample(point_sampler, varyings.uv);
-    col.rgb *= col.a;
     if (col.a < 0.5)
         discard;
     return col;
@@ -3,11 +3,9 @@ struct Attributes
     float3 pos : POSITION;
     float2 uv : TEXCOORD;
 
-    float4 matrix0 : MODEL0;
-    float4 matrix1 : MODEL1;
-    float4 matrix2 : MODEL2;
-    float4 matrix3 : MODEL3;
-    float4 st : ST;
+    float4 basis : BASIS;
+    float2 translation : TRANSLATION;
+    uint sprite : SPRITE;
 };
 
 struct Varyings
@@ -22,12 +20,28 @@ cbuffer CameraBuffer : register(b0)
     matrix matrix_p;
 }
 
+struct SpriteTableEntry
+{
+    float4 quad;
+    float4 st;
+    uint rotated;
+};
+
+StructuredBuffer<SpriteTableEntry> sprite_table : register(t0);
+
 Varyings main(Attributes attribs)
 {
-    float4x4 matrix_m = float4x4(attribs.matrix0, attribs.matrix1, attribs.matrix2, attribs.matrix3);
+    SpriteTableEntry entry = sprite_table[attribs.sprite];
+
+    // Trimmed sprites only cover part of the quad
+    float2 pos = attribs.uv * entry.quad.xy + entry.quad.zw - 0.5;
+    float2 world = attribs.basis.xy * pos.x + attribs.basis.zw * pos.y + attribs.translation;
+
+    // Rotated sprites are stored turned clockwise in the atlas
+    float2 uv = entry.rotated ? float2(1.0 - attribs.uv.y, attribs.uv.x) : attribs.uv;
 
     Varyings varyings;
-    varyings.pos = mul(mul(mul(float4(attribs.pos, 1.0), matrix_m), matrix_v), matrix_p);
-    varyings.uv = attribs.uv * attribs.st.xy + attribs.st.zw;
+    varyings.pos = mul(mul(float4(world, attribs.pos.z, 1.0), matrix_v), matrix_p);
+    varyings.uv = uv * entry.st.xy + entry.st.zw;
     return varyings;
 }
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cmath>
+
+#include "math.hpp"
+#include "physics/bounding_box.hpp"
+
+// 2D affine transform, a point p is placed at x * p.x + y * p.y + translation
+// Everything is drawn in 2D, so this replaces glm::mat4 for transforms and is the same layout as the basis and translation of SpriteDrawable
+struct Affine2D {
+	glm::vec2 x = glm::vec2(1.0f, 0.0f);
+	glm::vec2 y = glm::vec2(0.0f, 1.0f);
+	glm::vec2 translation = glm::vec2(0.0f);
+
+	[[nodiscard]] static constexpr Affine2D translate(glm::vec2 offset) { return { .translation = offset }; }
+	[[nodiscard]] static constexpr Affine2D scale(glm::vec2 factor) { return { .x = glm::vec2(factor.x, 0.0f), .y = glm::vec2(0.0f, factor.y) }; }
+	[[nodiscard]] static Affine2D rotate(float radians) {
+		float c = std::cos(radians);
+		float s = std::sin(radians);
+		return { .x = glm::vec2(c, s), .y = glm::vec2(-s, c) };
+	}
+	// Only the 2D part of the matrix is kept
+	[[nodiscard]] static constexpr Affine2D fromMatrix(const glm::mat4& matrix) {
+		return { .x = glm::vec2(matrix[0]), .y = glm::vec2(matrix[1]), .translation = glm::vec2(matrix[3]) };
+	}
+
+	[[nodiscard]] constexpr glm::vec2 apply(glm::vec2 point) const { return (x * point.x) + (y * point.y) + translation; }
+	[[nodiscard]] constexpr glm::vec2 applyVector(glm::vec2 vector) const { return (x * vector.x) + (y * vector.y); }
+	// Bounds of the transformed box, the center is transformed and the extent grows by the absolute axes
+	[[nodiscard]] BoundingBox apply(const BoundingBox& box) const {
+		glm::vec2 center = apply((box.min + box.max) * 0.5f);
+		glm::vec2 extent = (glm::abs(x) * ((box.max.x - box.min.x) * 0.5f)) + (glm::abs(y) * ((box.max.y - box.min.y) * 0.5f));
+		return { .min = center - extent, .max = center + extent };
+	}
+
+	// Applies other first and then this
+	[[nodiscard]] constexpr Affine2D operator*(const Affine2D& other) const {
+		return { .x = applyVector(other.x), .y = applyVector(other.y), .translation = apply(other.translation) };
+	}
+
+	[[nodiscard]] constexpr float getDeterminant() const { return (x.x * y.y) - (y.x * x.y); }
+	// The transform has to be invertible, check the determinant first when it might not be
+	[[nodiscard]] constexpr Affine2D inverse() const {
+		float inverseDeterminant = 1.0f / getDeterminant();
+		glm::vec2 inverseX = glm::vec2(y.y, -x.y) * inverseDeterminant;
+		glm::vec2 inverseY = glm::vec2(-y.x, x.x) * inverseDeterminant;
+		return { .x = inverseX, .y = inverseY, .translation = -((inverseX * translation.x) + (inverseY * translation.y)) };
+	}
+
+	[[nodiscard]] constexpr glm::vec4 getBasis() const { return glm::vec4(x, y); }
+
+	bool operator==(const Affine2D&) const = default;
+};
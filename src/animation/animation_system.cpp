@@ -0,0 +1,115 @@
+#include "animation_system.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+AnimationSystem::Handle AnimationSystem::add(const ClipPlayback& playback, SpriteDrawable& target) {
+	Handle handle;
+	if(m_freeHandles.empty()) {
+		handle = Handle(m_indices.size());
+		m_indices.push_back(0);
+	} else {
+		handle = m_freeHandles.back();
+		m_freeHandles.pop_back();
+	}
+
+	auto index = uint32_t(m_targets.size());
+	m_indices[handle] = index;
+	m_handles.push_back(handle);
+	m_startTicks.push_back(playback.startTick);
+	m_rates.push_back(playback.rate);
+	m_clips.push_back(playback.clip);
+	m_framesPerTick.push_back(0.0f);
+	m_frameCounts.push_back(0.0f);
+	m_inverseFrameCounts.push_back(0.0f);
+	m_frames.push_back(0);
+	m_lastFrames.push_back(-1);
+	m_targets.push_back(&target);
+	prepare(index);
+	return handle;
+}
+
+void AnimationSystem::remove(Handle handle) {
+	if(handle >= m_indices.size()) return;
+
+	uint32_t index = m_indices[handle];
+	auto last = uint32_t(m_targets.size() - 1);
+	m_indices[m_handles[last]] = index;
+	m_handles[index] = m_handles[last];
+	m_startTicks[index] = m_startTicks[last];
+	m_rates[index] = m_rates[last];
+	m_clips[index] = m_clips[last];
+	m_framesPerTick[index] = m_framesPerTick[last];
+	m_frameCounts[index] = m_frameCounts[last];
+	m_inverseFrameCounts[index] = m_inverseFrameCounts[last];
+	m_frames[index] = m_frames[last];
+	m_lastFrames[index] = m_lastFrames[last];
+	m_targets[index] = m_targets[last];
+
+	m_handles.pop_back();
+	m_startTicks.pop_back();
+	m_rates.pop_back();
+	m_clips.pop_back();
+	m_framesPerTick.pop_back();
+	m_frameCounts.pop_back();
+	m_inverseFrameCounts.pop_back();
+	m_frames.pop_back();
+	m_lastFrames.pop_back();
+	m_targets.pop_back();
+	m_freeHandles.push_back(handle);
+}
+
+void AnimationSystem::play(Handle handle, Clip clip, uint32_t startTick) {
+	uint32_t index = m_indices[handle];
+	m_clips[index] = clip;
+	m_startTicks[index] = startTick;
+	m_lastFrames[index] = -1;
+	prepare(index);
+}
+
+void AnimationSystem::sync(Handle handle, Handle leader) {
+	m_startTicks[m_indices[handle]] = m_startTicks[m_indices[leader]];
+}
+
+void AnimationSystem::setRate(Handle handle, float rate) {
+	uint32_t index = m_indices[handle];
+	m_rates[index] = rate;
+	prepare(index);
+}
+
+void AnimationSystem::update(const Time& time) {
+	uint32_t tick = ClipLibrary::getTick(time);
+	size_t count = m_targets.size();
+
+	// Only arithmetic on the arrays, so the compiler can turn this into vector instructions
+	// Rounding can leave the loop count one off at a multiple of the frame count, the frame is moved back into range afterwards
+	for(size_t i = 0; i < count; ++i) {
+		float frame = std::floor(float(tick - m_startTicks[i]) * m_framesPerTick[i]);
+		float loops = std::floor(frame * m_inverseFrameCounts[i]);
+		auto wrapped = int32_t(frame - (loops * m_frameCounts[i]));
+		auto frameCount = int32_t(m_frameCounts[i]);
+		wrapped = wrapped >= frameCount ? wrapped - frameCount : wrapped;
+		wrapped = wrapped < 0 ? wrapped + frameCount : wrapped;
+		// Clips that play for days get past the precision of a float, the frames get coarse but stay in range
+		m_frames[i] = std::clamp(wrapped, 0, frameCount - 1);
+	}
+
+	for(size_t i = 0; i < count; ++i) {
+		if(m_frames[i] == m_lastFrames[i]) continue;
+
+		m_lastFrames[i] = m_frames[i];
+		m_targets[i]->sprite = ClipLibrary::getFrames(m_clips[i])[size_t(m_frames[i])];
+	}
+}
+
+ClipPlayback AnimationSystem::getPlayback(Handle handle) const {
+	uint32_t index = m_indices[handle];
+	return { .startTick = m_startTicks[index], .rate = m_rates[index], .clip = m_clips[index] };
+}
+
+void AnimationSystem::prepare(uint32_t index) {
+	const AnimationClip& clip = ClipLibrary::getClip(m_clips[index]);
+	m_framesPerTick[index] = float(clip.frameRate) * m_rates[index] / (float(ClipPlayback::TickRate) * float(clip.animateOn));
+	m_frameCounts[index] = float(clip.frameCount);
+	m_inverseFrameCounts[index] = 1.0f / float(clip.frameCount);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "clip_library.hpp"
+#include "rendering/sprite_drawable.hpp"
+#include "time.hpp"
+
+// Plays the clips of all animators in one pass over flat arrays and writes the visible frame straight into their drawables
+// The frame is found with a multiply by the precomputed frames per tick and the reciprocal of the frame count, without any division
+// Drawables are only written when their frame changed since the last update
+class AnimationSystem {
+public:
+	using Handle = uint32_t;
+
+	constexpr static Handle InvalidHandle = UINT32_MAX;
+
+public:
+	// The drawable has to stay at the same address until the animator is removed
+	Handle add(const ClipPlayback& playback, SpriteDrawable& target);
+	void remove(Handle handle);
+
+	// Starts the clip from its first frame at the tick
+	void play(Handle handle, Clip clip, uint32_t startTick);
+	// Makes the animator run in step with the leader, both clips continue from the start tick of the leader
+	void sync(Handle handle, Handle leader);
+	void setRate(Handle handle, float rate);
+
+	void update(const Time& time);
+
+	[[nodiscard]] ClipPlayback getPlayback(Handle handle) const;
+	[[nodiscard]] size_t getCount() const { return m_targets.size(); }
+
+private:
+	// Recomputes the per animator constants after the clip or rate changed
+	void prepare(uint32_t index);
+
+private:
+	// Indexed by handle, the animators themselves are kept packed and the last one fills the gap of a removed one
+	std::vector<uint32_t> m_indices;
+	std::vector<Handle> m_freeHandles;
+
+	std::vector<Handle> m_handles;
+	std::vector<uint32_t> m_startTicks;
+	std::vector<float> m_rates;
+	std::vector<Clip> m_clips;
+	// Frames per tick of the clip, including the rate and how many ticks each frame is held for
+	std::vector<float> m_framesPerTick;
+	std::vector<float> m_frameCounts;
+	std::vector<float> m_inverseFrameCounts;
+	std::vector<int32_t> m_frames;
+	std::vector<int32_t> m_lastFrames;
+	std::vector<SpriteDrawable*> m_targets;
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <string_view>
+
+// Every clip of the game, the value is the id clips are referenced by
+enum class Clip : uint16_t {
+	PlayerIdle,
+	PlayerRun,
+	PlayerJump,
+	PlayerFall,
+	PlayerSlide,
+	PlayerDuck,
+	Mouse,
+	Count,
+};
+
+// Names clips are referred to by in data files
+constexpr std::string_view ClipNames[] = { "PlayerIdle", "PlayerRun", "PlayerJump", "PlayerFall", "PlayerSlide", "PlayerDuck", "Mouse" };
+static_assert(std::size(ClipNames) == size_t(Clip::Count), "Every clip needs a name");
+
+[[nodiscard]] constexpr std::optional<Clip> findClip(std::string_view name) {
+	for(size_t i = 0; i < std::size(ClipNames); ++i)
+		if(ClipNames[i] == name) return Clip(i);
+	return std::nullopt;
+}
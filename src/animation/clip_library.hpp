@@ -0,0 +1,97 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include "clip.hpp"
+#include "rendering/sprite_atlas.hpp"
+#include "time.hpp"
+
+struct AnimationClip {
+	uint16_t firstFrame = 0;
+	uint16_t frameCount = 0;
+	uint16_t frameRate = 0;
+	// Every frame is held for this many ticks of the frame rate
+	uint16_t animateOn = 1;
+};
+
+// State of a playing clip, small enough to keep one per pet in flat arrays
+struct ClipPlayback {
+	// Ticks wrap around after about 49 days, the difference to the start tick is still right when they do
+	constexpr static uint32_t TickRate = 1000;
+
+	uint32_t startTick = 0;
+	// Speed relative to the frame rate of the clip
+	float rate = 1.0f;
+	Clip clip = Clip::PlayerIdle;
+};
+
+struct ClipDefinition {
+	// Bounds the average clip length, the frame table has room for this many frames per clip
+	constexpr static size_t MaxFrames = 8;
+
+	// Sprite names separated by spaces
+	std::string_view frames;
+	unsigned frameRate = 24;
+	unsigned animateOn = 1;
+};
+
+// The frames of all clips back to back as sprite ids
+struct ClipTable {
+	std::array<AnimationClip, size_t(Clip::Count)> clips = {};
+	std::array<SpriteId, size_t(Clip::Count) * ClipDefinition::MaxFrames> frames = {};
+	size_t frameCount = 0;
+
+	// Fails to compile when a frame is not in the atlas
+	template<size_t Count>
+	static consteval ClipTable build(const ClipDefinition (&definitions)[Count]) {
+		static_assert(Count == size_t(Clip::Count), "Every clip needs a definition");
+		ClipTable table;
+		for(size_t i = 0; i < Count; ++i) {
+			AnimationClip& clip = table.clips[i];
+			clip.firstFrame = uint16_t(table.frameCount);
+			clip.frameRate = uint16_t(definitions[i].frameRate);
+			clip.animateOn = uint16_t(definitions[i].animateOn);
+			std::string_view frames = definitions[i].frames;
+			while(!frames.empty()) {
+				size_t end = std::min(frames.find(' '), frames.size());
+				table.frames[table.frameCount++] = SpriteAtlas::find(frames.substr(0, end)).value();
+				frames.remove_prefix(std::min(end + 1, frames.size()));
+				++clip.frameCount;
+			}
+		}
+		return table;
+	}
+};
+
+// Clips are immutable and shared by everything that plays them, they are baked at compile time from the sprite names
+// Playing a clip only takes a ClipPlayback and does not allocate
+class ClipLibrary {
+public:
+	[[nodiscard]] static constexpr const AnimationClip& getClip(Clip clip) { return s_table.clips[size_t(clip)]; }
+	[[nodiscard]] static constexpr std::span<const SpriteId> getFrames(Clip clip) {
+		return std::span(s_table.frames).subspan(getClip(clip).firstFrame, getClip(clip).frameCount);
+	}
+
+	[[nodiscard]] static uint32_t getTick(const Time& time) { return uint32_t(uint64_t(time.time() * double(ClipPlayback::TickRate))); }
+
+private:
+	constexpr static ClipDefinition s_definitions[] = {
+		{ .frames = "player_idle_2.png player_idle_1.png", .frameRate = 24, .animateOn = 8 },
+		{
+		    .frames = "player_run_1.png player_run_2.png player_run_3.png player_run_4.png player_run_5.png player_run_6.png",
+		    .frameRate = 24,
+		    .animateOn = 2,
+		},
+		{ .frames = "player_jump.png", .frameRate = 24, .animateOn = 2 },
+		{ .frames = "player_fall.png", .frameRate = 24, .animateOn = 2 },
+		{ .frames = "player_slide.png", .frameRate = 24, .animateOn = 2 },
+		{ .frames = "player_duck.png", .frameRate = 24, .animateOn = 2 },
+		{ .frames = "mouse.png mouse_left.png", .frameRate = 24, .animateOn = 8 },
+	};
+	constexpr static ClipTable s_table = ClipTable::build(s_definitions);
+};
@@ -0,0 +1,126 @@
+#include "squash_system.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+// e^x for x <= 0, the power of two is built in the exponent bits and the rest is a polynomial, accurate to about 1e-7
+static float decay(float x) {
+	float y = std::max(x * (1.0f / glm::ln_two<float>()), -126.0f);
+	float whole = std::floor(y + 0.5f);
+	float f = (y - whole) * glm::ln_two<float>();
+	float p = 1.0f / 720.0f;
+	p = (p * f) + (1.0f / 120.0f);
+	p = (p * f) + (1.0f / 24.0f);
+	p = (p * f) + (1.0f / 6.0f);
+	p = (p * f) + (1.0f / 2.0f);
+	p = (p * f) + 1.0f;
+	p = (p * f) + 1.0f;
+	return p * std::bit_cast<float>(int32_t(whole + 127.0f) << 23);
+}
+
+// sin(x) from a polynomial on -pi/2 to pi/2 after folding x into that range, accurate to about 4e-6
+static float sine(float x) {
+	float turns = std::floor((x * glm::one_over_two_pi<float>()) + 0.5f);
+	float r = x - (turns * glm::two_pi<float>());
+	r = r > glm::half_pi<float>() ? glm::pi<float>() - r : r;
+	r = r < -glm::half_pi<float>() ? -glm::pi<float>() - r : r;
+	float r2 = r * r;
+	float p = 1.0f / 362880.0f;
+	p = (p * r2) - (1.0f / 5040.0f);
+	p = (p * r2) + (1.0f / 120.0f);
+	p = (p * r2) - (1.0f / 6.0f);
+	p = (p * r2) + 1.0f;
+	return p * r;
+}
+
+SquashSystem::Handle SquashSystem::add(const SquashSettings& settings, SpriteDrawable& target) {
+	Handle handle;
+	if(m_freeHandles.empty()) {
+		handle = Handle(m_indices.size());
+		m_indices.push_back(0);
+	} else {
+		handle = m_freeHandles.back();
+		m_freeHandles.pop_back();
+	}
+
+	m_indices[handle] = uint32_t(m_targets.size());
+	m_handles.push_back(handle);
+	m_starts.push_back(0.0);
+	m_intensities.push_back(0.0f);
+	m_amplitudes.push_back(settings.amplitude);
+	m_angularFrequencies.push_back(settings.frequency * glm::two_pi<float>());
+	m_falloffs.push_back(settings.falloff);
+	m_origins.push_back(settings.origin);
+	m_scales.push_back(glm::vec2(1.0f));
+	m_targets.push_back(&target);
+	return handle;
+}
+
+void SquashSystem::remove(Handle handle) {
+	if(handle >= m_indices.size()) return;
+
+	uint32_t index = m_indices[handle];
+	auto last = uint32_t(m_targets.size() - 1);
+	m_indices[m_handles[last]] = index;
+	m_handles[index] = m_handles[last];
+	m_starts[index] = m_starts[last];
+	m_intensities[index] = m_intensities[last];
+	m_amplitudes[index] = m_amplitudes[last];
+	m_angularFrequencies[index] = m_angularFrequencies[last];
+	m_falloffs[index] = m_falloffs[last];
+	m_origins[index] = m_origins[last];
+	m_scales[index] = m_scales[last];
+	m_targets[index] = m_targets[last];
+
+	m_handles.pop_back();
+	m_starts.pop_back();
+	m_intensities.pop_back();
+	m_amplitudes.pop_back();
+	m_angularFrequencies.pop_back();
+	m_falloffs.pop_back();
+	m_origins.pop_back();
+	m_scales.pop_back();
+	m_targets.pop_back();
+	m_freeHandles.push_back(handle);
+}
+
+void SquashSystem::squish(Handle handle, const Time& time, float intensity) {
+	uint32_t index = m_indices[handle];
+	m_starts[index] = time.time();
+	m_intensities[index] = intensity * m_amplitudes[index];
+}
+
+bool SquashSystem::isSettled(Handle handle, const Time& time) const {
+	uint32_t index = m_indices[handle];
+	return std::abs(m_intensities[index]) * std::exp(-m_falloffs[index] * float(time.time() - m_starts[index])) < SettledAmplitude;
+}
+
+void SquashSystem::update(const Time& time) {
+	evaluate(time.time());
+	apply();
+}
+
+void SquashSystem::evaluate(double time) {
+	size_t count = m_targets.size();
+	for(size_t i = 0; i < count; ++i) {
+		auto t = float(time - m_starts[i]);
+		float jiggle = m_intensities[i] * sine(t * m_angularFrequencies[i]) * decay(-m_falloffs[i] * t);
+		// Stretching one axis squashes the other, so the area stays the same
+		m_scales[i] = glm::vec2(1.0f / (1.0f + jiggle), 1.0f + jiggle);
+	}
+}
+
+void SquashSystem::apply() {
+	// Same as multiplying the transform with translate(origin) * scale * translate(-origin)
+	size_t count = m_targets.size();
+	for(size_t i = 0; i < count; ++i) {
+		SpriteDrawable& target = *m_targets[i];
+		glm::vec2 axisX = glm::vec2(target.basis.x, target.basis.y);
+		glm::vec2 axisY = glm::vec2(target.basis.z, target.basis.w);
+		glm::vec2 scale = m_scales[i];
+		glm::vec2 shift = m_origins[i] * (1.0f - scale);
+		target.translation += (axisX * shift.x) + (axisY * shift.y);
+		target.basis = glm::vec4(axisX * scale.x, axisY * scale.y);
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "math.hpp"
+#include "rendering/sprite_drawable.hpp"
+#include "time.hpp"
+
+struct SquashSettings {
+	float amplitude = 1.0f;
+	// Oscillations per second
+	float frequency = 8.0f;
+	// How fast the oscillation decays, per second
+	float falloff = 20.0f;
+	// Point of the unit quad that stays in place, (0, 0.5) keeps the feet on the ground
+	glm::vec2 origin = glm::vec2(0.0f);
+};
+
+// Squash and stretch of all drawables in one pass over flat arrays
+// Every jiggle is a decaying sine, evaluated with polynomials instead of std::sin and std::exp so the loop has no calls and vectorizes
+// The scale is applied straight to the compact transform of the drawable, scaling it about the origin in its local space
+class SquashSystem {
+public:
+	using Handle = uint32_t;
+
+	constexpr static Handle InvalidHandle = UINT32_MAX;
+	// Jiggles below this amplitude count as settled
+	constexpr static float SettledAmplitude = 0.001f;
+
+public:
+	// The drawable has to stay at the same address until it is removed
+	// Its transform is scaled in place on every update, so the entity has to set the transform again before each update
+	Handle add(const SquashSettings& settings, SpriteDrawable& target);
+	void remove(Handle handle);
+
+	// Starts a new jiggle, squishing stretches the drawable upwards first and squashing flattens it first
+	void squish(Handle handle, const Time& time, float intensity = 1.0f);
+	void squash(Handle handle, const Time& time, float intensity = 1.0f) { squish(handle, time, -intensity); }
+
+	[[nodiscard]] bool isSettled(Handle handle, const Time& time) const;
+
+	void update(const Time& time);
+
+	// Scale of the last update
+	[[nodiscard]] glm::vec2 getScale(Handle handle) const { return m_scales[m_indices[handle]]; }
+	[[nodiscard]] size_t getCount() const { return m_targets.size(); }
+
+private:
+	void evaluate(double time);
+	void apply();
+
+private:
+	// Indexed by handle, the drawables themselves are kept packed and the last one fills the gap of a removed one
+	std::vector<uint32_t> m_indices;
+	std::vector<Handle> m_freeHandles;
+
+	std::vector<Handle> m_handles;
+	std::vector<double> m_starts;
+	// Signed amplitude of the current jiggle, the intensity times the amplitude of the settings
+	std::vector<float> m_intensities;
+	std::vector<float> m_amplitudes;
+	// Radians per second
+	std::vector<float> m_angularFrequencies;
+	std::vector<float> m_falloffs;
+	std::vector<glm::vec2> m_origins;
+	std::vector<glm::vec2> m_scales;
+	std::vector<SpriteDrawable*> m_targets;
+};
@@ -0,0 +1,80 @@
+#include "state_machine.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+static std::string_view getName(const StateMachineDefinition::Name& name) {
+	return std::string_view(name.data(), std::ranges::find(name, '\0') - name.begin());
+}
+
+std::optional<unsigned> StateMachineDefinition::findParameter(std::string_view name) const {
+	for(size_t i = 0; i < parameterNames.size(); ++i)
+		if(getName(parameterNames[i]) == name) return unsigned(i);
+	return std::nullopt;
+}
+
+std::optional<uint16_t> StateMachineDefinition::findState(std::string_view name) const {
+	for(size_t i = 0; i < stateNames.size(); ++i)
+		if(getName(stateNames[i]) == name) return uint16_t(i);
+	return std::nullopt;
+}
+
+template<typename T>
+static void appendTable(std::vector<std::byte>& data, const std::vector<T>& table) {
+	size_t offset = data.size();
+	data.resize(offset + (sizeof(T) * table.size()));
+	std::memcpy(data.data() + offset, table.data(), sizeof(T) * table.size());
+}
+
+template<typename T>
+static bool readTable(std::span<const std::byte>& data, std::vector<T>& table, size_t count) {
+	if(data.size() < sizeof(T) * count) return false;
+	table.resize(count);
+	std::memcpy(table.data(), data.data(), sizeof(T) * count);
+	data = data.subspan(sizeof(T) * count);
+	return true;
+}
+
+std::vector<std::byte> bakeStateMachine(const StateMachineDefinition& definition) {
+	BakedStateMachineHeader header;
+	header.parameterCount = uint16_t(definition.parameterNames.size());
+	header.stateCount = uint16_t(definition.states.size());
+	header.transitionCount = uint16_t(definition.transitions.size());
+	header.initialState = definition.initialState;
+
+	std::vector<std::byte> data(sizeof(header));
+	std::memcpy(data.data(), &header, sizeof(header));
+	appendTable(data, definition.parameterNames);
+	appendTable(data, definition.stateNames);
+	appendTable(data, definition.states);
+	appendTable(data, definition.transitions);
+	return data;
+}
+
+std::optional<StateMachineDefinition> readBakedStateMachine(std::span<const std::byte> data) {
+	BakedStateMachineHeader header;
+	if(data.size() < sizeof(header)) return std::nullopt;
+	std::memcpy(&header, data.data(), sizeof(header));
+	data = data.subspan(sizeof(header));
+
+	if(header.magic != BakedStateMachineHeader::Magic || header.version != BakedStateMachineHeader::Version) return std::nullopt;
+	if(header.parameterCount > StateMachineDefinition::MaxParameters || header.initialState >= header.stateCount) return std::nullopt;
+
+	StateMachineDefinition definition;
+	definition.initialState = header.initialState;
+	if(!readTable(data, definition.parameterNames, header.parameterCount)) return std::nullopt;
+	if(!readTable(data, definition.stateNames, header.stateCount)) return std::nullopt;
+	if(!readTable(data, definition.states, header.stateCount)) return std::nullopt;
+	if(!readTable(data, definition.transitions, header.transitionCount)) return std::nullopt;
+
+	// Evaluation does not check any indices, so they are all checked once here
+	for(const StateMachineDefinition::State& state : definition.states) {
+		if(state.clip >= Clip::Count || state.firstTransition + state.transitionCount > header.transitionCount) return std::nullopt;
+	}
+	for(const StateMachineDefinition::Transition& transition : definition.transitions) {
+		if(transition.target >= header.stateCount) return std::nullopt;
+		if(std::ranges::any_of(transition.parameters, [&](uint8_t parameter) { return parameter >= header.parameterCount; })) return std::nullopt;
+	}
+
+	return definition;
+}
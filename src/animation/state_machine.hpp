@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "clip.hpp"
+
+// Animation states of a character and the transitions between them, as flat tables that are evaluated without branches
+// Every condition of a transition compares one parameter as parameter * scale > threshold, so greater, less and boolean tests are the same operation
+// Unused condition slots always pass, the first transition of a state with all conditions passing is taken
+struct StateMachineDefinition {
+	constexpr static size_t MaxParameters = 8;
+	constexpr static size_t MaxConditions = 4;
+	constexpr static size_t MaxNameLength = 15;
+
+	using Name = std::array<char, MaxNameLength + 1>;
+
+	struct Transition {
+		std::array<uint8_t, MaxConditions> parameters = {};
+		std::array<float, MaxConditions> scales = {};
+		std::array<float, MaxConditions> thresholds = { -1.0f, -1.0f, -1.0f, -1.0f };
+		uint16_t target = 0;
+		// Sprites cannot be blended, so a cross-fade continues the timing of the previous clip instead of starting the new one over
+		uint16_t crossFade = 0;
+	};
+
+	struct State {
+		Clip clip = Clip::PlayerIdle;
+		uint16_t firstTransition = 0;
+		uint16_t transitionCount = 0;
+	};
+
+	std::vector<Name> parameterNames;
+	std::vector<Name> stateNames;
+	std::vector<State> states;
+	std::vector<Transition> transitions;
+	uint16_t initialState = 0;
+
+	[[nodiscard]] std::optional<unsigned> findParameter(std::string_view name) const;
+	[[nodiscard]] std::optional<uint16_t> findState(std::string_view name) const;
+};
+
+// The baked file is the header followed by the tables in the order of the definition, so loading is a copy per table
+struct BakedStateMachineHeader {
+	constexpr static uint32_t Magic = 0x4843534d; // "MSCH"
+	constexpr static uint32_t Version = 1;
+
+	uint32_t magic = Magic;
+	uint32_t version = Version;
+	uint16_t parameterCount = 0;
+	uint16_t stateCount = 0;
+	uint16_t transitionCount = 0;
+	uint16_t initialState = 0;
+};
+
+[[nodiscard]] std::vector<std::byte> bakeStateMachine(const StateMachineDefinition& definition);
+// Validates the header and every index in the tables
+[[nodiscard]] std::optional<StateMachineDefinition> readBakedStateMachine(std::span<const std::byte> data);
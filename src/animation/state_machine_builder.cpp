@@ -0,0 +1,136 @@
+#include "state_machine_builder.hpp"
+
+#include <format>
+
+#include <nlohmann/json.hpp>
+
+static bool setName(StateMachineDefinition::Name& name, const std::string& value) {
+	if(value.empty() || value.size() > StateMachineDefinition::MaxNameLength) return false;
+	name = {};
+	value.copy(name.data(), value.size());
+	return true;
+}
+
+// Every comparison becomes parameter * scale > threshold
+static bool setCondition(StateMachineDefinition::Transition& transition, size_t slot, unsigned parameter, const std::string& op, float value) {
+	transition.parameters[slot] = uint8_t(parameter);
+	if(op == ">") {
+		transition.scales[slot] = 1.0f;
+		transition.thresholds[slot] = value;
+	} else if(op == "<") {
+		transition.scales[slot] = -1.0f;
+		transition.thresholds[slot] = -value;
+	} else if(op == "true") {
+		transition.scales[slot] = 1.0f;
+		transition.thresholds[slot] = 0.5f;
+	} else if(op == "false") {
+		transition.scales[slot] = -1.0f;
+		transition.thresholds[slot] = -0.5f;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+static std::optional<StateMachineDefinition> parse(const nlohmann::json& json, std::string& error) {
+	StateMachineDefinition definition;
+
+	const nlohmann::json& parameters = json.at("parameters");
+	if(parameters.size() > StateMachineDefinition::MaxParameters) {
+		error = std::format("More than {} parameters", StateMachineDefinition::MaxParameters);
+		return std::nullopt;
+	}
+	for(const auto& parameter : parameters) {
+		auto name = parameter.get<std::string>();
+		if(definition.findParameter(name) || !setName(definition.parameterNames.emplace_back(), name)) {
+			error = std::format("Invalid parameter name {}", name);
+			return std::nullopt;
+		}
+	}
+
+	for(const auto& state : json.at("states")) {
+		auto name = state.at("name").get<std::string>();
+		auto clipName = state.at("clip").get<std::string>();
+		std::optional<Clip> clip = findClip(clipName);
+		if(!clip) {
+			error = std::format("Unknown clip {} in state {}", clipName, name);
+			return std::nullopt;
+		}
+		if(definition.findState(name) || !setName(definition.stateNames.emplace_back(), name)) {
+			error = std::format("Invalid state name {}", name);
+			return std::nullopt;
+		}
+		definition.states.push_back({ .clip = *clip });
+	}
+
+	auto initial = json.at("initial").get<std::string>();
+	std::optional<uint16_t> initialState = definition.findState(initial);
+	if(!initialState) {
+		error = std::format("Unknown initial state {}", initial);
+		return std::nullopt;
+	}
+	definition.initialState = *initialState;
+
+	// Parsed once, then copied into every state they leave from so each state has its transitions back to back
+	std::vector<std::pair<std::string, StateMachineDefinition::Transition>> transitions;
+	for(const auto& entry : json.at("transitions")) {
+		auto target = entry.at("to").get<std::string>();
+		std::optional<uint16_t> targetState = definition.findState(target);
+		if(!targetState) {
+			error = std::format("Unknown transition target {}", target);
+			return std::nullopt;
+		}
+
+		StateMachineDefinition::Transition transition = { .target = *targetState, .crossFade = uint16_t(entry.value("crossFade", false)) };
+		const nlohmann::json& conditions = entry.value("conditions", nlohmann::json::array());
+		if(conditions.size() > StateMachineDefinition::MaxConditions) {
+			error = std::format("More than {} conditions on a transition to {}", StateMachineDefinition::MaxConditions, target);
+			return std::nullopt;
+		}
+		for(size_t i = 0; i < conditions.size(); ++i) {
+			auto parameterName = conditions[i].at("parameter").get<std::string>();
+			std::optional<unsigned> parameter = definition.findParameter(parameterName);
+			auto op = conditions[i].at("op").get<std::string>();
+			if(!parameter || !setCondition(transition, i, *parameter, op, conditions[i].value("value", 0.0f))) {
+				error = std::format("Invalid condition {} {} on a transition to {}", parameterName, op, target);
+				return std::nullopt;
+			}
+		}
+
+		auto source = entry.value("from", std::string("*"));
+		if(source != "*" && !definition.findState(source)) {
+			error = std::format("Unknown transition source {}", source);
+			return std::nullopt;
+		}
+		transitions.emplace_back(std::move(source), transition);
+	}
+
+	for(size_t i = 0; i < definition.states.size(); ++i) {
+		StateMachineDefinition::State& state = definition.states[i];
+		state.firstTransition = uint16_t(definition.transitions.size());
+		for(const auto& [source, transition] : transitions)
+			if(source == "*" || definition.findState(source) == i) definition.transitions.push_back(transition);
+		state.transitionCount = uint16_t(definition.transitions.size() - state.firstTransition);
+	}
+
+	if(definition.transitions.size() > UINT16_MAX) {
+		error = "Too many transitions";
+		return std::nullopt;
+	}
+	return definition;
+}
+
+std::optional<StateMachineDefinition> parseStateMachine(std::string_view json, std::string& error) {
+	nlohmann::json parsed = nlohmann::json::parse(json, nullptr, false);
+	if(parsed.is_discarded()) {
+		error = "Invalid JSON";
+		return std::nullopt;
+	}
+
+	try {
+		return parse(parsed, error);
+	} catch(const nlohmann::json::exception& exception) {
+		error = exception.what();
+		return std::nullopt;
+	}
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "state_machine.hpp"
+
+// Compiles the JSON description of a state machine into its flat tables
+// Transitions from "*" are added to every state, each state checks its transitions in the order they are listed
+// Conditions compare a parameter with ">" or "<" against a value, or test it with "true" and "false"
+[[nodiscard]] std::optional<StateMachineDefinition> parseStateMachine(std::string_view json, std::string& error);
@@ -0,0 +1,31 @@
+#include "state_machine_library.hpp"
+
+#include <algorithm>
+#include <span>
+
+#include "platform.hpp"
+
+std::vector<std::pair<std::string_view, StateMachineDefinition>> StateMachineLibrary::s_machines;
+
+void StateMachineLibrary::load() {
+	alignas(uint32_t) constexpr static unsigned char player[] = {
+#embed "embed/animations/player.bin"
+	};
+
+	struct BakedMachine {
+		std::string_view name;
+		std::span<const unsigned char> data;
+	};
+	constexpr static BakedMachine bakedMachines[] = { { .name = "player", .data = player } };
+
+	for(const BakedMachine& baked : bakedMachines) {
+		std::optional<StateMachineDefinition> definition = readBakedStateMachine(std::as_bytes(baked.data));
+		if(!definition) fatalError("An embedded animation state machine is invalid");
+		s_machines.emplace_back(baked.name, std::move(*definition));
+	}
+}
+
+const StateMachineDefinition* StateMachineLibrary::find(std::string_view name) {
+	auto it = std::ranges::find(s_machines, name, &std::pair<std::string_view, StateMachineDefinition>::first);
+	return it != s_machines.end() ? &it->second : nullptr;
+}
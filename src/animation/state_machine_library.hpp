@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "state_machine.hpp"
+
+// State machines baked from assets/animations at build time, they are loaded once and shared by every character that uses them
+class StateMachineLibrary {
+public:
+	static void load();
+
+	// The definition stays valid until the program exits
+	[[nodiscard]] static const StateMachineDefinition* find(std::string_view name);
+
+private:
+	static std::vector<std::pair<std::string_view, StateMachineDefinition>> s_machines;
+};
@@ -0,0 +1,117 @@
+#include "state_machine_system.hpp"
+
+#include <algorithm>
+
+StateMachineSystem::Handle StateMachineSystem::add(const StateMachineDefinition& definition, AnimationSystem::Handle animator) {
+	uint32_t firstState = addDefinition(definition);
+
+	Handle handle;
+	if(m_freeHandles.empty()) {
+		handle = Handle(m_indices.size());
+		m_indices.push_back(0);
+	} else {
+		handle = m_freeHandles.back();
+		m_freeHandles.pop_back();
+	}
+
+	m_indices[handle] = uint32_t(m_handles.size());
+	m_handles.push_back(handle);
+	m_firstStates.push_back(firstState);
+	m_currentStates.push_back(firstState + definition.initialState);
+	m_nextStates.push_back(firstState + definition.initialState);
+	m_crossFades.push_back(0);
+	m_started.push_back(0);
+	m_parameters.push_back({});
+	m_animators.push_back(animator);
+	return handle;
+}
+
+void StateMachineSystem::remove(Handle handle) {
+	if(handle >= m_indices.size()) return;
+
+	uint32_t index = m_indices[handle];
+	auto last = uint32_t(m_handles.size() - 1);
+	m_indices[m_handles[last]] = index;
+	m_handles[index] = m_handles[last];
+	m_firstStates[index] = m_firstStates[last];
+	m_currentStates[index] = m_currentStates[last];
+	m_nextStates[index] = m_nextStates[last];
+	m_crossFades[index] = m_crossFades[last];
+	m_started[index] = m_started[last];
+	m_parameters[index] = m_parameters[last];
+	m_animators[index] = m_animators[last];
+
+	m_handles.pop_back();
+	m_firstStates.pop_back();
+	m_currentStates.pop_back();
+	m_nextStates.pop_back();
+	m_crossFades.pop_back();
+	m_started.pop_back();
+	m_parameters.pop_back();
+	m_animators.pop_back();
+	m_freeHandles.push_back(handle);
+}
+
+void StateMachineSystem::setParameter(Handle handle, unsigned parameter, float value) {
+	m_parameters[m_indices[handle]][parameter] = value;
+}
+
+void StateMachineSystem::update(AnimationSystem& animations, const Time& time) {
+	size_t count = m_handles.size();
+
+	// The loop over the transitions of a state is the only branch, which transition is taken is a select
+	for(size_t i = 0; i < count; ++i) {
+		const State& state = m_states[m_currentStates[i]];
+		const Parameters& parameters = m_parameters[i];
+		uint32_t next = m_currentStates[i];
+		uint32_t crossFade = 0;
+		uint32_t found = 0;
+		for(uint32_t t = state.firstTransition; t < state.firstTransition + state.transitionCount; ++t) {
+			const StateMachineDefinition::Transition& transition = m_transitions[t];
+			uint32_t pass = 1;
+			for(size_t c = 0; c < StateMachineDefinition::MaxConditions; ++c)
+				pass &= uint32_t(parameters[transition.parameters[c]] * transition.scales[c] > transition.thresholds[c]);
+
+			uint32_t take = pass & (found ^ 1);
+			next = take ? m_firstStates[i] + transition.target : next;
+			crossFade = take ? transition.crossFade : crossFade;
+			found |= pass;
+		}
+		m_nextStates[i] = next;
+		m_crossFades[i] = uint8_t(crossFade);
+	}
+
+	// Taking a transition to the current state keeps its clip playing
+	uint32_t tick = ClipLibrary::getTick(time);
+	for(size_t i = 0; i < count; ++i) {
+		if(m_nextStates[i] == m_currentStates[i] && m_started[i]) continue;
+
+		uint32_t startTick = m_crossFades[i] && m_started[i] ? animations.getPlayback(m_animators[i]).startTick : tick;
+		animations.play(m_animators[i], m_states[m_nextStates[i]].clip, startTick);
+		m_currentStates[i] = m_nextStates[i];
+		m_started[i] = 1;
+	}
+}
+
+unsigned StateMachineSystem::getState(Handle handle) const {
+	uint32_t index = m_indices[handle];
+	return m_currentStates[index] - m_firstStates[index];
+}
+
+uint32_t StateMachineSystem::addDefinition(const StateMachineDefinition& definition) {
+	auto it = std::ranges::find(m_machines, &definition, &Machine::definition);
+	if(it != m_machines.end()) return it->firstState;
+
+	auto firstState = uint32_t(m_states.size());
+	auto firstTransition = uint32_t(m_transitions.size());
+	for(const StateMachineDefinition::State& state : definition.states) {
+		m_states.push_back({
+		    .firstTransition = firstTransition + state.firstTransition,
+		    .transitionCount = state.transitionCount,
+		    .clip = state.clip,
+		});
+	}
+	m_transitions.insert(m_transitions.end(), definition.transitions.begin(), definition.transitions.end());
+	m_machines.push_back({ .definition = &definition, .firstState = firstState });
+	return firstState;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "animation_system.hpp"
+#include "state_machine.hpp"
+#include "time.hpp"
+
+// Runs the state machines of all characters in one pass and switches their animators to the clip of the new state
+// The tables of every definition in use are merged, so a character is only its current state and parameters
+// Transitions are evaluated without branches, every condition of every transition of the current state is tested and the first passing one wins
+class StateMachineSystem {
+public:
+	using Handle = uint32_t;
+	using Parameters = std::array<float, StateMachineDefinition::MaxParameters>;
+
+	constexpr static Handle InvalidHandle = UINT32_MAX;
+
+public:
+	// The definition has to stay at the same address as long as the system exists, the animator plays the clips of the states
+	Handle add(const StateMachineDefinition& definition, AnimationSystem::Handle animator);
+	void remove(Handle handle);
+
+	void setParameter(Handle handle, unsigned parameter, float value);
+	void setParameter(Handle handle, unsigned parameter, bool value) { setParameter(handle, parameter, value ? 1.0f : 0.0f); }
+
+	// Has to run before the animation system, so the frames of a new clip are shown in the same update
+	void update(AnimationSystem& animations, const Time& time);
+
+	// Index of the state in the definition
+	[[nodiscard]] unsigned getState(Handle handle) const;
+	[[nodiscard]] size_t getCount() const { return m_handles.size(); }
+
+private:
+	struct Machine {
+		const StateMachineDefinition* definition;
+		uint32_t firstState;
+	};
+
+	struct State {
+		uint32_t firstTransition;
+		uint32_t transitionCount;
+		Clip clip;
+	};
+
+private:
+	// Returns the index of the first state of the definition in the merged tables
+	uint32_t addDefinition(const StateMachineDefinition& definition);
+
+private:
+	// Definitions stay merged once they were used, there are only a few of them
+	std::vector<Machine> m_machines;
+	std::vector<State> m_states;
+	// Targets are relative to the first state of the definition
+	std::vector<StateMachineDefinition::Transition> m_transitions;
+
+	// Indexed by handle, the characters themselves are kept packed and the last one fills the gap of a removed one
+	std::vector<uint32_t> m_indices;
+	std::vector<Handle> m_freeHandles;
+
+	std::vector<Handle> m_handles;
+	std::vector<uint32_t> m_firstStates;
+	std::vector<uint32_t> m_currentStates;
+	std::vector<uint32_t> m_nextStates;
+	std::vector<uint8_t> m_crossFades;
+	// The clip of the initial state is only started in the first update, it needs the time
+	std::vector<uint8_t> m_started;
+	std::vector<Parameters> m_parameters;
+	std::vector<AnimationSystem::Handle> m_animators;
+};
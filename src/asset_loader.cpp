@@ -0,0 +1,59 @@
+#include "asset_loader.hpp"
+
+#include <algorithm>
+
+#include "logger.hpp"
+
+AssetLoader::AssetLoader(Clock::time_point start) : m_start(start) {}
+
+AssetLoader::~AssetLoader() {
+	waitAll();
+}
+
+void AssetLoader::waitAll() {
+	for(unsigned pending = m_pending.load(std::memory_order_acquire); pending != 0; pending = m_pending.load(std::memory_order_acquire))
+		m_pending.wait(pending, std::memory_order_acquire);
+}
+
+void AssetLoader::logTimings() const {
+	std::vector<Timing> timings = getTimings();
+	std::ranges::sort(timings, {}, &Timing::started);
+
+	double busy = 0.0;
+	double finished = 0.0;
+	for(const Timing& timing : timings) {
+		busy += timing.finished - timing.started;
+		finished = std::max(finished, timing.finished);
+	}
+
+	// More work than time means the loads overlapped each other
+	logger::log("Assets: {} loads, {:.2f} ms of work done after {:.2f} ms", timings.size(), busy, finished);
+	for(const Timing& timing : timings) {
+		logger::log(
+		    "  {}: {:.2f} ms, started at {:.2f} ms after waiting {:.2f} ms",
+		    timing.name,
+		    timing.finished - timing.started,
+		    timing.started,
+		    timing.started - timing.queued
+		);
+	}
+}
+
+double AssetLoader::getElapsedMilliseconds() const {
+	return std::chrono::duration<double, std::milli>(Clock::now() - m_start).count();
+}
+
+std::vector<AssetLoader::Timing> AssetLoader::getTimings() const {
+	std::lock_guard lock(m_mutex);
+	return m_timings;
+}
+
+void AssetLoader::finish(std::string_view name, double queued, double started) {
+	{
+		std::lock_guard lock(m_mutex);
+		m_timings.push_back({ .name = name, .queued = queued, .started = started, .finished = getElapsedMilliseconds() });
+	}
+
+	m_pending.fetch_sub(1, std::memory_order_release);
+	m_pending.notify_all();
+}
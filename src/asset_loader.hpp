@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "thread_pool.hpp"
+
+// Loads assets in parallel on its own thread pool, so decoding and uploading overlaps with the work left on the main thread
+// Every load is timed, the timings show which asset holds up startup
+class AssetLoader {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	struct Timing {
+		std::string_view name;
+		// All in milliseconds since the loader was created
+		double queued;
+		double started;
+		double finished;
+	};
+
+public:
+	explicit AssetLoader(Clock::time_point start = Clock::now());
+	AssetLoader(const AssetLoader&) = delete;
+	AssetLoader& operator=(const AssetLoader&) = delete;
+	AssetLoader(AssetLoader&&) = delete;
+	AssetLoader& operator=(AssetLoader&&) = delete;
+	~AssetLoader();
+
+	// Runs the task on the pool, the name has to outlive the loader
+	// The future can be waited on by anything that needs the asset, loads that nothing waits for are covered by waitAll
+	template<typename F>
+	std::shared_future<std::invoke_result_t<F>> load(std::string_view name, F&& task) {
+		double queued = getElapsedMilliseconds();
+		m_pending.fetch_add(1, std::memory_order_relaxed);
+
+		return m_threadPool
+		    .submit([this, name, queued, task = std::forward<F>(task)]() mutable {
+			    double started = getElapsedMilliseconds();
+			    if constexpr(std::is_void_v<std::invoke_result_t<F>>) {
+				    task();
+				    finish(name, queued, started);
+			    } else {
+				    auto asset = task();
+				    finish(name, queued, started);
+				    return asset;
+			    }
+		    })
+		    .share();
+	}
+
+	// Blocks until every load so far is done
+	void waitAll();
+	void logTimings() const;
+
+	[[nodiscard]] double getElapsedMilliseconds() const;
+	[[nodiscard]] std::vector<Timing> getTimings() const;
+
+private:
+	void finish(std::string_view name, double queued, double started);
+
+private:
+	Clock::time_point m_start;
+	std::atomic_uint m_pending = 0;
+
+	mutable std::mutex m_mutex;
+	std::vector<Timing> m_timings;
+
+	// Declared last so the workers are joined before anything they use is destroyed
+	ThreadPool m_threadPool;
+};
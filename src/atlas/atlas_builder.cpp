@@ -0,0 +1,187 @@
+#include "atlas_builder.hpp"
+
+#include <algorithm>
+#include <optional>
+#include <utility>
+
+#include <nlohmann/json.hpp>
+
+AtlasBuilder::AtlasBuilder(const Options& options) :
+    m_options(options), m_packer(options.width, options.height, options.padding, options.allowRotation) {}
+
+const AtlasBuilder::Sprite* AtlasBuilder::add(std::string name, const Image& image) {
+	Bounds bounds = findOpaqueBounds(image);
+
+	std::optional<AtlasPacker::Rect> rect;
+	while(!(rect = m_packer.insert(bounds.width, bounds.height)))
+		if(!grow()) return nullptr;
+
+	// The trimmed pixels go into an image of the size of the rect, laid out like they will be in the atlas
+	Image& spriteImage = m_spriteImages.emplace_back();
+	spriteImage.width = rect->width;
+	spriteImage.height = rect->height;
+	spriteImage.pixels.resize(size_t(rect->width) * rect->height);
+
+	AtlasPacker::Rect local = { .x = 0, .y = 0, .width = rect->width, .height = rect->height, .rotated = rect->rotated };
+	for(unsigned y = 0; y < bounds.height; ++y) {
+		for(unsigned x = 0; x < bounds.width; ++x)
+			spriteImage.pixels[atlasIndex(spriteImage, local, x, y)] = image.pixels[(size_t(bounds.y + y) * image.width) + bounds.x + x];
+	}
+
+	return &m_sprites.emplace_back(
+	    Sprite{
+	        .name = std::move(name),
+	        .rect = *rect,
+	        .trimX = bounds.x,
+	        .trimY = bounds.y,
+	        .sourceWidth = image.width,
+	        .sourceHeight = image.height,
+	    }
+	);
+}
+
+const AtlasBuilder::Sprite* AtlasBuilder::restore(const Sprite& sprite, const Image& previousAtlas) {
+	const AtlasPacker::Rect& rect = sprite.rect;
+	if(rect.x + rect.width > previousAtlas.width || rect.y + rect.height > previousAtlas.height) return nullptr;
+
+	while(rect.x + rect.width > m_packer.getWidth() || rect.y + rect.height > m_packer.getHeight())
+		if(!grow()) return nullptr;
+
+	if(!m_packer.place(rect)) return nullptr;
+
+	// The pixels are already in atlas orientation, so they are copied row by row
+	Image& spriteImage = m_spriteImages.emplace_back();
+	spriteImage.width = rect.width;
+	spriteImage.height = rect.height;
+	spriteImage.pixels.resize(size_t(rect.width) * rect.height);
+	for(unsigned y = 0; y < rect.height; ++y) {
+		const uint32_t* source = &previousAtlas.pixels[(size_t(rect.y + y) * previousAtlas.width) + rect.x];
+		std::copy_n(source, rect.width, &spriteImage.pixels[size_t(y) * rect.width]);
+	}
+
+	return &m_sprites.emplace_back(sprite);
+}
+
+Image AtlasBuilder::getImage() const {
+	Bounds bounds = getUsedBounds();
+
+	Image image;
+	image.width = bounds.width;
+	image.height = bounds.height;
+	image.pixels.resize(size_t(image.width) * image.height);
+	for(size_t i = 0; i < m_sprites.size(); ++i) {
+		const AtlasPacker::Rect& rect = m_sprites[i].rect;
+		for(unsigned y = 0; y < rect.height; ++y) {
+			const uint32_t* source = &m_spriteImages[i].pixels[size_t(y) * rect.width];
+			std::copy_n(source, rect.width, &image.pixels[(size_t(rect.y + y) * image.width) + rect.x]);
+		}
+	}
+
+	return image;
+}
+
+float AtlasBuilder::getOccupancy() const {
+	Bounds bounds = getUsedBounds();
+	if(bounds.width == 0 || bounds.height == 0) return 0.0f;
+	return float(double(m_packer.getUsedArea()) / (double(bounds.width) * double(bounds.height)));
+}
+
+std::string AtlasBuilder::toJson(std::span<const AtlasBuilder> pages) {
+	// The runtime parser relies on the key order, so this has to stay an ordered json
+	nlohmann::ordered_json json;
+	json["pages"] = nlohmann::ordered_json::array();
+	json["sprites"] = nlohmann::ordered_json::array();
+
+	for(size_t page = 0; page < pages.size(); ++page) {
+		Bounds bounds = pages[page].getUsedBounds();
+		nlohmann::ordered_json& pageEntry = json["pages"].emplace_back();
+		pageEntry["width"] = bounds.width;
+		pageEntry["height"] = bounds.height;
+
+		for(const Sprite& sprite : pages[page].m_sprites) {
+			nlohmann::ordered_json& entry = json["sprites"].emplace_back();
+			entry["name"] = sprite.name;
+			entry["page"] = page;
+			entry["x"] = sprite.rect.x;
+			entry["y"] = sprite.rect.y;
+			entry["width"] = sprite.rect.width;
+			entry["height"] = sprite.rect.height;
+			entry["rotated"] = sprite.rect.rotated;
+			entry["trimX"] = sprite.trimX;
+			entry["trimY"] = sprite.trimY;
+			entry["sourceWidth"] = sprite.sourceWidth;
+			entry["sourceHeight"] = sprite.sourceHeight;
+		}
+	}
+
+	return json.dump(1, '\t');
+}
+
+bool AtlasBuilder::matches(const Sprite& sprite, const Image& atlas, const Image& image) const {
+	Bounds bounds = findOpaqueBounds(image);
+	const AtlasPacker::Rect& rect = sprite.rect;
+
+	unsigned width = rect.rotated ? rect.height : rect.width;
+	unsigned height = rect.rotated ? rect.width : rect.height;
+	if(image.width != sprite.sourceWidth || image.height != sprite.sourceHeight) return false;
+	if(bounds.x != sprite.trimX || bounds.y != sprite.trimY || bounds.width != width || bounds.height != height) return false;
+	if(rect.x + rect.width > atlas.width || rect.y + rect.height > atlas.height) return false;
+
+	for(unsigned y = 0; y < bounds.height; ++y) {
+		for(unsigned x = 0; x < bounds.width; ++x)
+			if(atlas.pixels[atlasIndex(atlas, rect, x, y)] != image.pixels[(size_t(bounds.y + y) * image.width) + bounds.x + x]) return false;
+	}
+
+	return true;
+}
+
+AtlasBuilder::Bounds AtlasBuilder::findOpaqueBounds(const Image& image) const {
+	if(!m_options.trim) return { .x = 0, .y = 0, .width = image.width, .height = image.height };
+
+	unsigned minX = image.width;
+	unsigned minY = image.height;
+	unsigned maxX = 0;
+	unsigned maxY = 0;
+	for(unsigned y = 0; y < image.height; ++y) {
+		for(unsigned x = 0; x < image.width; ++x) {
+			if((image.pixels[(size_t(y) * image.width) + x] >> 24) == 0) continue;
+			minX = std::min(minX, x);
+			minY = std::min(minY, y);
+			maxX = std::max(maxX, x + 1);
+			maxY = std::max(maxY, y + 1);
+		}
+	}
+
+	// Completely transparent images still need a texel to sample from
+	if(minX >= maxX) return { .x = 0, .y = 0, .width = 1, .height = 1 };
+	return { .x = minX, .y = minY, .width = maxX - minX, .height = maxY - minY };
+}
+
+AtlasBuilder::Bounds AtlasBuilder::getUsedBounds() const {
+	Bounds bounds = { .x = 0, .y = 0, .width = 0, .height = 0 };
+	for(const Sprite& sprite : m_sprites) {
+		bounds.width = std::max(bounds.width, sprite.rect.x + sprite.rect.width);
+		bounds.height = std::max(bounds.height, sprite.rect.y + sprite.rect.height);
+	}
+	return bounds;
+}
+
+bool AtlasBuilder::grow() {
+	unsigned width = m_packer.getWidth();
+	unsigned height = m_packer.getHeight();
+	if(width >= m_options.maxSize && height >= m_options.maxSize) return false;
+
+	if((width <= height && width < m_options.maxSize) || height >= m_options.maxSize) {
+		width = std::min(width * 2, m_options.maxSize);
+	} else {
+		height = std::min(height * 2, m_options.maxSize);
+	}
+
+	m_packer.grow(width, height);
+	return true;
+}
+
+size_t AtlasBuilder::atlasIndex(const Image& atlas, const AtlasPacker::Rect& rect, unsigned x, unsigned y) {
+	if(rect.rotated) return (size_t(rect.y + x) * atlas.width) + rect.x + rect.width - 1 - y;
+	return (size_t(rect.y + y) * atlas.width) + rect.x + x;
+}
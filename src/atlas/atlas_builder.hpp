@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "atlas_packer.hpp"
+#include "rendering/image.hpp"
+
+// Builds a sprite atlas image on top of AtlasPacker, sprites are trimmed to their opaque pixels before packing
+// Sprites can be added at any time, when the atlas is full it grows without moving what was packed before
+// Only the trimmed pixels of each sprite are kept, the atlas image is put together when it is requested
+class AtlasBuilder {
+public:
+	struct Options {
+		unsigned padding = 1;
+		bool trim = true;
+		bool allowRotation = false;
+		// Starting size, the atlas grows by doubling its shorter side until it reaches the maximum size
+		unsigned width = 64;
+		unsigned height = 64;
+		unsigned maxSize = 4096;
+	};
+
+	struct Sprite {
+		std::string name;
+		AtlasPacker::Rect rect;
+		// Position of the trimmed rect inside the original image
+		unsigned trimX = 0;
+		unsigned trimY = 0;
+		unsigned sourceWidth = 0;
+		unsigned sourceHeight = 0;
+	};
+
+public:
+	explicit AtlasBuilder(const Options& options);
+
+	// Packs the sprite and copies its pixels into the atlas, returns nullptr if the atlas would exceed the maximum size
+	const Sprite* add(std::string name, const Image& image);
+	// Puts a sprite back where a previous atlas had it, the pixels are copied from that atlas
+	const Sprite* restore(const Sprite& sprite, const Image& previousAtlas);
+
+	// The atlas cropped to the packed sprites
+	[[nodiscard]] Image getImage() const;
+	[[nodiscard]] std::span<const Sprite> getSprites() const { return m_sprites; }
+	[[nodiscard]] unsigned getWidth() const { return getUsedBounds().width; }
+	[[nodiscard]] unsigned getHeight() const { return getUsedBounds().height; }
+	[[nodiscard]] float getOccupancy() const;
+	// Same layout the runtime SpriteAtlas reads, the page sizes come first and every sprite entry starts with its name
+	[[nodiscard]] static std::string toJson(std::span<const AtlasBuilder> pages);
+
+	// Trims the image like add would and checks whether the sprite in the given atlas still has the same pixels
+	[[nodiscard]] bool matches(const Sprite& sprite, const Image& atlas, const Image& image) const;
+
+private:
+	struct Bounds {
+		unsigned x;
+		unsigned y;
+		unsigned width;
+		unsigned height;
+	};
+
+private:
+	[[nodiscard]] Bounds findOpaqueBounds(const Image& image) const;
+	[[nodiscard]] Bounds getUsedBounds() const;
+	// Doubles the shorter side of the atlas, fails once the maximum size is reached
+	bool grow();
+
+	// Index of a pixel of the trimmed source image in the atlas, rotated sprites are stored turned clockwise
+	static size_t atlasIndex(const Image& atlas, const AtlasPacker::Rect& rect, unsigned x, unsigned y);
+
+private:
+	Options m_options;
+	AtlasPacker m_packer;
+	std::vector<Sprite> m_sprites;
+	// Pixels of every sprite in the orientation they have in the atlas
+	std::vector<Image> m_spriteImages;
+};
@@ -0,0 +1,138 @@
+#include "atlas_packer.hpp"
+
+#include <algorithm>
+#include <limits>
+
+AtlasPacker::AtlasPacker(unsigned width, unsigned height, unsigned padding, bool allowRotation) :
+    m_width(width), m_height(height), m_padding(padding), m_allowRotation(allowRotation) {
+	m_freeRects.push_back({ .x = 0, .y = 0, .width = width + padding, .height = height + padding });
+}
+
+std::optional<AtlasPacker::Rect> AtlasPacker::insert(unsigned width, unsigned height) {
+	if(width == 0 || height == 0) return std::nullopt;
+
+	std::optional<FreeRect> best;
+	bool bestRotated = false;
+	unsigned bestShortSide = std::numeric_limits<unsigned>::max();
+	unsigned bestLongSide = std::numeric_limits<unsigned>::max();
+
+	auto tryFit = [&](const FreeRect& freeRect, unsigned paddedWidth, unsigned paddedHeight, bool rotated) {
+		if(paddedWidth > freeRect.width || paddedHeight > freeRect.height) return;
+
+		unsigned leftoverX = freeRect.width - paddedWidth;
+		unsigned leftoverY = freeRect.height - paddedHeight;
+		unsigned shortSide = std::min(leftoverX, leftoverY);
+		unsigned longSide = std::max(leftoverX, leftoverY);
+		if(shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide)) {
+			best = FreeRect{ .x = freeRect.x, .y = freeRect.y, .width = paddedWidth, .height = paddedHeight };
+			bestRotated = rotated;
+			bestShortSide = shortSide;
+			bestLongSide = longSide;
+		}
+	};
+
+	for(const FreeRect& freeRect : m_freeRects) {
+		tryFit(freeRect, width + m_padding, height + m_padding, false);
+		if(m_allowRotation && width != height) tryFit(freeRect, height + m_padding, width + m_padding, true);
+	}
+
+	if(!best) return std::nullopt;
+
+	splitFreeRects(*best);
+	pruneFreeRects();
+	m_usedArea += size_t(width) * height;
+
+	return Rect{
+		.x = best->x,
+		.y = best->y,
+		.width = best->width - m_padding,
+		.height = best->height - m_padding,
+		.rotated = bestRotated,
+	};
+}
+
+bool AtlasPacker::place(const Rect& rect) {
+	FreeRect used = { .x = rect.x, .y = rect.y, .width = rect.width + m_padding, .height = rect.height + m_padding };
+
+	// Every free area is part of a maximal free rect, so the rect is only free if one of them contains it
+	if(std::ranges::none_of(m_freeRects, [&](const FreeRect& freeRect) { return freeRect.contains(used); })) return false;
+
+	splitFreeRects(used);
+	pruneFreeRects();
+	m_usedArea += size_t(rect.width) * rect.height;
+	return true;
+}
+
+void AtlasPacker::grow(unsigned width, unsigned height) {
+	width = std::max(width, m_width);
+	height = std::max(height, m_height);
+	if(width == m_width && height == m_height) return;
+
+	unsigned binWidth = m_width + m_padding;
+	unsigned binHeight = m_height + m_padding;
+	unsigned newBinWidth = width + m_padding;
+	unsigned newBinHeight = height + m_padding;
+
+	// Free rects on the border now continue into the new area, which is completely free
+	for(FreeRect& freeRect : m_freeRects) {
+		if(freeRect.x + freeRect.width == binWidth) freeRect.width = newBinWidth - freeRect.x;
+		if(freeRect.y + freeRect.height == binHeight) freeRect.height = newBinHeight - freeRect.y;
+	}
+
+	if(newBinWidth > binWidth) m_freeRects.push_back({ .x = binWidth, .y = 0, .width = newBinWidth - binWidth, .height = newBinHeight });
+	if(newBinHeight > binHeight) m_freeRects.push_back({ .x = 0, .y = binHeight, .width = newBinWidth, .height = newBinHeight - binHeight });
+	pruneFreeRects();
+
+	m_width = width;
+	m_height = height;
+}
+
+void AtlasPacker::splitFreeRects(const FreeRect& used) {
+	m_newFreeRects.clear();
+
+	for(const FreeRect& freeRect : m_freeRects) {
+		bool overlaps = used.x < freeRect.x + freeRect.width && used.x + used.width > freeRect.x && used.y < freeRect.y + freeRect.height &&
+		                used.y + used.height > freeRect.y;
+		if(!overlaps) {
+			m_newFreeRects.push_back(freeRect);
+			continue;
+		}
+
+		// Keep the parts of the free rect on each side of the used rect, they overlap each other but are all maximal
+		if(used.x > freeRect.x) {
+			m_newFreeRects.push_back({ .x = freeRect.x, .y = freeRect.y, .width = used.x - freeRect.x, .height = freeRect.height });
+		}
+		if(used.x + used.width < freeRect.x + freeRect.width) {
+			unsigned right = used.x + used.width;
+			m_newFreeRects.push_back({ .x = right, .y = freeRect.y, .width = freeRect.x + freeRect.width - right, .height = freeRect.height });
+		}
+		if(used.y > freeRect.y) {
+			m_newFreeRects.push_back({ .x = freeRect.x, .y = freeRect.y, .width = freeRect.width, .height = used.y - freeRect.y });
+		}
+		if(used.y + used.height < freeRect.y + freeRect.height) {
+			unsigned bottom = used.y + used.height;
+			m_newFreeRects.push_back({ .x = freeRect.x, .y = bottom, .width = freeRect.width, .height = freeRect.y + freeRect.height - bottom });
+		}
+	}
+
+	m_freeRects.swap(m_newFreeRects);
+}
+
+void AtlasPacker::pruneFreeRects() {
+	// Drops free rects that are contained in another one, of two identical rects only the first one survives
+	for(size_t i = 0; i < m_freeRects.size(); ++i) {
+		for(size_t j = i + 1; j < m_freeRects.size();) {
+			if(m_freeRects[i].contains(m_freeRects[j])) {
+				m_freeRects[j] = m_freeRects.back();
+				m_freeRects.pop_back();
+			} else if(m_freeRects[j].contains(m_freeRects[i])) {
+				m_freeRects[i] = m_freeRects[j];
+				m_freeRects[j] = m_freeRects.back();
+				m_freeRects.pop_back();
+				j = i + 1;
+			} else {
+				++j;
+			}
+		}
+	}
+}
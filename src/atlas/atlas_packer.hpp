@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+// MaxRects bin packer, the free space is kept as the list of all maximal free rectangles
+// Packed rects never move, so new rects can be inserted into an existing packing and the area can grow without repacking
+class AtlasPacker {
+public:
+	struct Rect {
+		unsigned x = 0;
+		unsigned y = 0;
+		// Size of the rect in the atlas, rotated rects are stored turned 90 degrees clockwise so this is the source size swapped
+		unsigned width = 0;
+		unsigned height = 0;
+		bool rotated = false;
+	};
+
+public:
+	AtlasPacker(unsigned width, unsigned height, unsigned padding = 1, bool allowRotation = false);
+
+	// Finds a place for a rect with the best short side fit heuristic, returns nothing when it does not fit anymore
+	[[nodiscard]] std::optional<Rect> insert(unsigned width, unsigned height);
+	// Marks a rect at a fixed position as used, fails if it overlaps anything that was packed before
+	bool place(const Rect& rect);
+	// Extends the packing area to the right and bottom, the size can not shrink
+	void grow(unsigned width, unsigned height);
+
+	[[nodiscard]] unsigned getWidth() const { return m_width; }
+	[[nodiscard]] unsigned getHeight() const { return m_height; }
+	[[nodiscard]] size_t getUsedArea() const { return m_usedArea; }
+	// Fraction of the area that is covered by packed rects, padding does not count
+	[[nodiscard]] float getOccupancy() const { return float(double(m_usedArea) / (double(m_width) * double(m_height))); }
+
+private:
+	// Rects are padded on the right and bottom, the bin is padded the same way so the last row and column can touch the border
+	struct FreeRect {
+		unsigned x;
+		unsigned y;
+		unsigned width;
+		unsigned height;
+
+		[[nodiscard]] bool contains(const FreeRect& other) const {
+			return other.x >= x && other.y >= y && other.x + other.width <= x + width && other.y + other.height <= y + height;
+		}
+	};
+
+private:
+	void splitFreeRects(const FreeRect& used);
+	void pruneFreeRects();
+
+private:
+	unsigned m_width;
+	unsigned m_height;
+	unsigned m_padding;
+	bool m_allowRotation;
+
+	std::vector<FreeRect> m_freeRects;
+	std::vector<FreeRect> m_newFreeRects;
+	size_t m_usedArea = 0;
+};
@@ -0,0 +1,71 @@
+#include "baked_atlas.hpp"
+
+#include <cstring>
+
+// Same rounding as writing col.rgb * col.a to a UNORM target
+static uint32_t premultiply(uint32_t color) {
+	uint32_t a = color >> 24;
+	auto channel = [a](uint32_t value) {
+		uint32_t t = value * a + 128;
+		return (t + (t >> 8)) >> 8;
+	};
+	return channel(color & 0xff) | (channel((color >> 8) & 0xff) << 8) | (channel((color >> 16) & 0xff) << 16) | (a << 24);
+}
+
+std::vector<std::byte> bakeAtlas(std::span<const Image> pages) {
+	BakedAtlasHeader header;
+	header.pageCount = uint32_t(pages.size());
+
+	std::vector<BakedPageHeader> pageHeaders(pages.size());
+	size_t offset = sizeof(BakedAtlasHeader) + (sizeof(BakedPageHeader) * pages.size());
+	for(size_t i = 0; i < pages.size(); ++i) {
+		pageHeaders[i].width = pages[i].width;
+		pageHeaders[i].height = pages[i].height;
+		pageHeaders[i].rowPitch = pages[i].width * sizeof(uint32_t);
+		pageHeaders[i].dataOffset = uint32_t(offset);
+		offset += size_t(pageHeaders[i].rowPitch) * pageHeaders[i].height;
+	}
+
+	std::vector<std::byte> data(offset);
+	std::memcpy(data.data(), &header, sizeof(header));
+	std::memcpy(data.data() + sizeof(header), pageHeaders.data(), sizeof(BakedPageHeader) * pageHeaders.size());
+
+	for(size_t i = 0; i < pages.size(); ++i) {
+		std::byte* pixels = data.data() + pageHeaders[i].dataOffset;
+		for(size_t j = 0; j < pages[i].pixels.size(); ++j) {
+			uint32_t color = premultiply(pages[i].pixels[j]);
+			std::memcpy(pixels + (j * sizeof(uint32_t)), &color, sizeof(uint32_t));
+		}
+	}
+
+	return data;
+}
+
+std::optional<std::vector<BakedPageView>> readBakedAtlas(std::span<const std::byte> data) {
+	BakedAtlasHeader header;
+	if(data.size() < sizeof(header)) return std::nullopt;
+	std::memcpy(&header, data.data(), sizeof(header));
+
+	if(header.magic != BakedAtlasHeader::Magic || header.version != BakedAtlasHeader::Version) return std::nullopt;
+	if(data.size() < sizeof(header) + (sizeof(BakedPageHeader) * header.pageCount)) return std::nullopt;
+	if(reinterpret_cast<uintptr_t>(data.data()) % alignof(uint32_t) != 0) return std::nullopt;
+
+	std::vector<BakedPageView> pages;
+	pages.reserve(header.pageCount);
+	for(uint32_t i = 0; i < header.pageCount; ++i) {
+		BakedPageHeader page;
+		std::memcpy(&page, data.data() + sizeof(header) + (sizeof(BakedPageHeader) * i), sizeof(page));
+
+		if(page.rowPitch < page.width * sizeof(uint32_t) || page.dataOffset % alignof(uint32_t) != 0) return std::nullopt;
+		if(data.size() < page.dataOffset + (size_t(page.rowPitch) * page.height)) return std::nullopt;
+
+		pages.push_back({
+		    .width = page.width,
+		    .height = page.height,
+		    .rowPitch = page.rowPitch,
+		    .pixels = reinterpret_cast<const uint32_t*>(data.data() + page.dataOffset),
+		});
+	}
+
+	return pages;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "rendering/image.hpp"
+
+// Atlas textures in the layout the GPU wants them, so they can be uploaded straight from the embedded or mapped file without decoding
+// The header is followed by one page header per page, the pixels of every page are premultiplied RGBA8 with tightly packed rows
+struct BakedAtlasHeader {
+	constexpr static uint32_t Magic = 0x4c544153; // "SATL"
+	constexpr static uint32_t Version = 2;
+
+	uint32_t magic = Magic;
+	uint32_t version = Version;
+	uint32_t pageCount = 0;
+	uint32_t reserved = 0;
+};
+
+struct BakedPageHeader {
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t rowPitch = 0;
+	uint32_t dataOffset = 0;
+};
+
+struct BakedPageView {
+	uint32_t width;
+	uint32_t height;
+	uint32_t rowPitch;
+	// Points into the file data, the view is only valid as long as that is
+	const uint32_t* pixels;
+
+	[[nodiscard]] size_t getByteSize() const { return size_t(rowPitch) * height; }
+};
+
+// Premultiplies the pages and puts them behind a header
+[[nodiscard]] std::vector<std::byte> bakeAtlas(std::span<const Image> pages);
+// Validates the headers, the data has to be aligned to 4 bytes
+[[nodiscard]] std::optional<std::vector<BakedPageView>> readBakedAtlas(std::span<const std::byte> data);
@@ -0,0 +1,71 @@
+#include "cpu_features.hpp"
+
+#if defined(_M_X64) || defined(__x86_64__)
+	#define CPU_FEATURES_X64
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+	#else
+		#include <cpuid.h>
+	#endif
+#endif
+
+#if defined(__clang__) || defined(__GNUC__)
+	#define TARGET_XSAVE __attribute__((target("xsave")))
+#else
+	#define TARGET_XSAVE
+#endif
+
+namespace {
+	struct Features {
+		bool avx = false;
+		bool avx2 = false;
+	};
+
+#ifdef CPU_FEATURES_X64
+	void cpuid(int leaf, int info[4]) {
+	#ifdef _MSC_VER
+		__cpuidex(info, leaf, 0);
+	#else
+		__cpuid_count(leaf, 0, info[0], info[1], info[2], info[3]);
+	#endif
+	}
+
+	TARGET_XSAVE Features detect() {
+		Features features;
+		int info[4];
+		cpuid(0, info);
+		int maxLeaf = info[0];
+
+		// The OS has to save the ymm registers as well
+		cpuid(1, info);
+		constexpr int osxsave = 1 << 27;
+		constexpr int avx = 1 << 28;
+		if((info[2] & osxsave) == 0 || (info[2] & avx) == 0) return features;
+		if((_xgetbv(0) & 0x6) != 0x6) return features;
+		features.avx = true;
+
+		if(maxLeaf < 7) return features;
+		cpuid(7, info);
+		features.avx2 = (info[1] & (1 << 5)) != 0;
+		return features;
+	}
+#else
+	Features detect() {
+		return {};
+	}
+#endif
+
+	const Features& getFeatures() {
+		static const Features features = detect();
+		return features;
+	}
+} // namespace
+
+bool cpu_features::hasAvx() {
+	return getFeatures().avx;
+}
+
+bool cpu_features::hasAvx2() {
+	return getFeatures().avx2;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+// Instruction sets beyond SSE2 are only used after checking for them at runtime, the results are cached
+namespace cpu_features {
+	// Both also check that the OS saves the ymm registers
+	[[nodiscard]] bool hasAvx();
+	[[nodiscard]] bool hasAvx2();
+} // namespace cpu_features
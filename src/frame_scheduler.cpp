@@ -0,0 +1,101 @@
+#include "frame_scheduler.hpp"
+
+#include <algorithm>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+// Waitable timers count in 100ns intervals
+using TimerTicks = std::chrono::duration<long long, std::ratio<1, 10'000'000>>;
+
+FrameScheduler::FrameScheduler() :
+    activeFrameTime(1.0f / 60.0f),
+    m_timer(CreateWaitableTimerEx(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS)),
+    m_wakeEvent(CreateEvent(nullptr, FALSE, FALSE, nullptr)),
+    m_frameStart(Clock::now()),
+    m_lastActivity(m_frameStart) {
+	// High resolution timers need Windows 10 1803, the spin time estimate makes up for a less precise timer
+	if(!m_timer) m_timer = CreateWaitableTimerEx(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+	if(!m_timer || !m_wakeEvent) fatalError("Could not create the frame scheduler timers");
+
+	// Run at the refresh rate of the primary display by default
+	DEVMODE displayMode = {};
+	displayMode.dmSize = sizeof(displayMode);
+	if(EnumDisplaySettings(nullptr, ENUM_CURRENT_SETTINGS, &displayMode) && displayMode.dmDisplayFrequency > 1)
+		activeFrameTime = 1.0f / float(displayMode.dmDisplayFrequency);
+}
+
+FrameScheduler::~FrameScheduler() {
+	CloseHandle(m_timer);
+	CloseHandle(m_wakeEvent);
+}
+
+void FrameScheduler::waitForNextFrame() {
+	float frameTimeSeconds = activeFrameTime;
+	if(m_mode == Mode::Idle) frameTimeSeconds = idleFrameTime;
+	if(m_mode == Mode::Suspended) frameTimeSeconds = suspendedFrameTime;
+
+	auto frameTime = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(frameTimeSeconds));
+	Clock::time_point deadline = m_frameStart + frameTime;
+	sleepUntil(deadline);
+
+	// Keep a steady cadence, but start over after being woken up or when a frame took too long
+	Clock::time_point now = Clock::now();
+	m_frameStart = (now < deadline || now - deadline > frameTime) ? now : deadline;
+
+	if(m_woken.exchange(false)) m_lastActivity = now;
+
+	if(m_occluded) {
+		m_mode = Mode::Suspended;
+	} else if(now - m_lastActivity < std::chrono::duration<float>(idleDelay)) {
+		m_mode = Mode::Active;
+	} else {
+		m_mode = Mode::Idle;
+	}
+}
+
+void FrameScheduler::markActive() {
+	m_lastActivity = Clock::now();
+}
+
+void FrameScheduler::wake() {
+	m_woken = true;
+	SetEvent(m_wakeEvent);
+}
+
+void FrameScheduler::setOccluded(bool occluded) {
+	if(m_occluded && !occluded) m_lastActivity = Clock::now();
+	m_occluded = occluded;
+}
+
+bool FrameScheduler::sleepUntil(Clock::time_point deadline) {
+	while(true) {
+		Clock::duration remaining = deadline - Clock::now();
+		if(remaining <= Clock::duration::zero()) return true;
+
+		if(remaining <= m_spinTime) {
+			while(Clock::now() < deadline) {
+				if(m_woken) return false;
+				std::this_thread::yield();
+			}
+			return true;
+		}
+
+		// Negative due times are relative to now
+		Clock::duration sleepTime = remaining - m_spinTime;
+		LARGE_INTEGER dueTime;
+		dueTime.QuadPart = -std::max(1ll, std::chrono::duration_cast<TimerTicks>(sleepTime).count());
+		SetWaitableTimer(m_timer, &dueTime, 0, nullptr, nullptr, FALSE);
+
+		HANDLE handles[] = { m_timer, m_wakeEvent };
+		Clock::time_point sleepStart = Clock::now();
+		if(WaitForMultipleObjects(2, handles, FALSE, INFINITE) == WAIT_OBJECT_0 + 1) {
+			CancelWaitableTimer(m_timer);
+			return false;
+		}
+
+		// Settles at about twice the typical oversleep
+		Clock::duration overshoot = std::max(Clock::duration::zero(), (Clock::now() - sleepStart) - sleepTime);
+		m_spinTime = std::clamp((m_spinTime * 7 + overshoot * 2) / 8, Clock::duration(250us), Clock::duration(4ms));
+	}
+}
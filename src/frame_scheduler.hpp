@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+#include "platform.hpp"
+
+// Paces the application loop, the frame rate drops when nothing happens and rendering stops while the surfaces can not be seen
+// Sleeping is done on a high resolution waitable timer and the last bit is spun to hit the deadline precisely
+class FrameScheduler {
+public:
+	enum class Mode { Active, Idle, Suspended };
+
+	using Clock = std::chrono::steady_clock;
+
+public:
+	FrameScheduler();
+	FrameScheduler(const FrameScheduler&) = delete;
+	FrameScheduler& operator=(const FrameScheduler&) = delete;
+	FrameScheduler(FrameScheduler&&) = delete;
+	FrameScheduler& operator=(FrameScheduler&&) = delete;
+	~FrameScheduler();
+
+	// Blocks until the next frame should start, returns early when woken up
+	void waitForNextFrame();
+
+	// Something moved or animated this frame, keeps the scheduler at the active frame rate
+	void markActive();
+	// Can be called from any thread, immediately ends the current wait and goes back to the active frame rate
+	void wake();
+	void setOccluded(bool occluded);
+
+	[[nodiscard]] Mode getMode() const { return m_mode; }
+	[[nodiscard]] bool shouldRender() const { return m_mode != Mode::Suspended; }
+
+public:
+	float activeFrameTime;
+	float idleFrameTime = 1.0f / 10.0f;
+	float suspendedFrameTime = 1.0f / 4.0f;
+	float idleDelay = 2.0f;
+
+private:
+	bool sleepUntil(Clock::time_point deadline);
+
+private:
+	HANDLE m_timer;
+	HANDLE m_wakeEvent;
+	std::atomic_bool m_woken = false;
+
+	Mode m_mode = Mode::Active;
+	bool m_occluded = false;
+	Clock::time_point m_frameStart;
+	Clock::time_point m_lastActivity;
+
+	// Running estimate of how much the timer oversleeps, this part of the wait is spun instead
+	Clock::duration m_spinTime = std::chrono::milliseconds(1);
+};
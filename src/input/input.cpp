@@ -1,61 +1,170 @@
 #include "input.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <utility>
 
 #include "platform.hpp"
+#include "profiler.hpp"
 
 void Input::notifyButtonPress(InputButton button) {
-	std::lock_guard lock(m_inputMutex);
-	m_inputButtonQueue.emplace_back(button, true);
+	push({ .time = std::chrono::steady_clock::now(), .button = button, .type = Event::Type::Button, .value = true });
 }
 
 void Input::notifyButtonRelease(InputButton button) {
-	std::lock_guard lock(m_inputMutex);
-	m_inputButtonQueue.emplace_back(button, false);
+	push({ .time = std::chrono::steady_clock::now(), .button = button, .type = Event::Type::Button, .value = false });
 }
 
 void Input::notifyFocus(bool focus) {
-	m_focus = focus;
-	if(!focus)
-		for(const auto& responder : m_responders) responder->clearState();
+	m_lastFocus.store(focus, std::memory_order_relaxed);
+	push({ .time = std::chrono::steady_clock::now(), .type = Event::Type::Focus, .value = focus });
 }
 
-void Input::update() {
-	std::lock_guard lock(m_inputMutex);
+void Input::update(const Time& time) {
+	PROFILE_ZONE("Input::update");
+	m_frameEvents.clear();
+	while(std::optional<Event> event = m_events.pop())
+		m_frameEvents.push_back({ .time = time.timeAt(event->time), .button = event->button, .type = event->type, .value = event->value });
 
-	for(auto& responder : m_responders) responder->update();
-
-	for(auto& input : m_inputButtonQueue)
-		for(auto* responder : m_responderInputMap[input.id]) responder->notify(input.id, input.state);
-
-	m_inputButtonQueue.clear();
+	// A dropped release would leave its button held forever, so nothing is held after an overflow
+	if(m_overflowed.exchange(false, std::memory_order_acquire))
+		m_frameEvents.push_back({ .time = time.time(), .type = Event::Type::Reset, .value = m_lastFocus.load(std::memory_order_relaxed) });
+	dispatch();
 
 	POINT p;
 	GetCursorPos(&p);
 	m_mousePos = glm::vec2(p.x, p.y);
 }
 
-void Input::add(unsigned id, std::unique_ptr<InputResponder> responder) {
-	assert(!m_responderIdMap.contains(id));
-	for(auto binding : responder->bindings()) m_responderInputMap[binding].push_back(responder.get());
-	m_responderIdMap.emplace(id, responder.get());
-	m_responders.emplace_back(std::move(responder));
+void Input::replay(std::span<const FrameEvent> events, glm::vec2 mousePos) {
+	m_frameEvents.assign(events.begin(), events.end());
+	dispatch();
+	m_mousePos = mousePos;
+}
+
+void Input::add(unsigned id, const InputAction& action) {
+	addResponder(id, ResponderType::Action, m_actions.size());
+	m_actions.push_back(action);
+	bind();
+}
+
+void Input::add(unsigned id, const InputAxis1D& axis) {
+	addResponder(id, ResponderType::Axis1D, m_axes1D.size());
+	m_axes1D.push_back(axis);
+	bind();
+}
+
+void Input::add(unsigned id, const InputAxis2D& axis) {
+	addResponder(id, ResponderType::Axis2D, m_axes2D.size());
+	m_axes2D.push_back(axis);
+	bind();
+}
+
+bool Input::rebind(unsigned id, unsigned slot, InputButton button) {
+	auto it = std::ranges::find(m_responders, id, &Responder::id);
+	if(it == m_responders.end()) return false;
+
+	std::span<InputButton> bindings;
+	switch(it->type) {
+	case ResponderType::Action: bindings = m_actions[it->index].bindings(); break;
+	case ResponderType::Axis1D: bindings = m_axes1D[it->index].bindings(); break;
+	case ResponderType::Axis2D: bindings = m_axes2D[it->index].bindings(); break;
+	}
+	if(slot >= bindings.size()) return false;
+
+	// The old button might be held, its release would not reach the slot anymore
+	bindings[slot] = button;
+	clearState();
+	bind();
+	return true;
 }
 
 const InputAction* Input::getAction(unsigned id) const {
-	auto it = m_responderIdMap.find(id);
-	if(it == m_responderIdMap.end()) return nullptr;
-	return static_cast<InputAction*>(it->second);
+	const Responder* responder = find(id, ResponderType::Action);
+	return responder ? &m_actions[responder->index] : nullptr;
 }
 
 const InputAxis1D* Input::getAxis1D(unsigned id) const {
-	auto it = m_responderIdMap.find(id);
-	if(it == m_responderIdMap.end()) return nullptr;
-	return static_cast<InputAxis1D*>(it->second);
+	const Responder* responder = find(id, ResponderType::Axis1D);
+	return responder ? &m_axes1D[responder->index] : nullptr;
 }
 
 const InputAxis2D* Input::getAxis2D(unsigned id) const {
-	auto it = m_responderIdMap.find(id);
-	if(it == m_responderIdMap.end()) return nullptr;
-	return static_cast<InputAxis2D*>(it->second);
+	const Responder* responder = find(id, ResponderType::Axis2D);
+	return responder ? &m_axes2D[responder->index] : nullptr;
+}
+
+void Input::push(const Event& event) {
+	if(!m_events.push(event)) m_overflowed.store(true, std::memory_order_release);
+}
+
+void Input::dispatch() {
+	for(InputAction& action : m_actions) action.update();
+
+	for(const FrameEvent& event : m_frameEvents) {
+		switch(event.type) {
+		case Event::Type::Button: {
+			auto button = size_t(event.button);
+			if(button >= ButtonCount) break;
+			for(uint16_t i = m_bindingStarts[button]; i < m_bindingStarts[button + 1]; ++i) {
+				const Binding& binding = m_bindings[i];
+				switch(binding.type) {
+				case ResponderType::Action: m_actions[binding.index].notify(event.value, event.time); break;
+				case ResponderType::Axis1D: m_axes1D[binding.index].notify(binding.slot, event.value); break;
+				case ResponderType::Axis2D: m_axes2D[binding.index].notify(binding.slot, event.value); break;
+				}
+			}
+			break;
+		}
+		case Event::Type::Focus:
+			m_focus = event.value;
+			if(!m_focus) clearState();
+			break;
+		case Event::Type::Reset:
+			m_focus = event.value;
+			clearState();
+			break;
+		}
+	}
+}
+
+void Input::clearState() {
+	for(InputAction& action : m_actions) action.clearState();
+	for(InputAxis1D& axis : m_axes1D) axis.clearState();
+	for(InputAxis2D& axis : m_axes2D) axis.clearState();
+}
+
+const Input::Responder* Input::find(unsigned id, ResponderType type) const {
+	auto it = std::ranges::find(m_responders, id, &Responder::id);
+	if(it == m_responders.end() || it->type != type) return nullptr;
+	return &*it;
+}
+
+void Input::addResponder(unsigned id, ResponderType type, size_t index) {
+	assert(std::ranges::find(m_responders, id, &Responder::id) == m_responders.end());
+	m_responders.push_back({ .id = id, .type = type, .index = uint16_t(index) });
+}
+
+void Input::bind() {
+	std::vector<std::pair<size_t, Binding>> bindings;
+	auto collect = [&](ResponderType type, size_t index, std::span<const InputButton> buttons) {
+		for(size_t slot = 0; slot < buttons.size(); ++slot) {
+			auto button = size_t(buttons[slot]);
+			if(buttons[slot] == InputButton::None || button >= ButtonCount) continue;
+			bindings.emplace_back(button, Binding{ .type = type, .slot = uint8_t(slot), .index = uint16_t(index) });
+		}
+	};
+	for(size_t i = 0; i < m_actions.size(); ++i) collect(ResponderType::Action, i, m_actions[i].bindings());
+	for(size_t i = 0; i < m_axes1D.size(); ++i) collect(ResponderType::Axis1D, i, m_axes1D[i].bindings());
+	for(size_t i = 0; i < m_axes2D.size(); ++i) collect(ResponderType::Axis2D, i, m_axes2D[i].bindings());
+
+	// Counting sort by button, the start of a button is the number of bindings of all buttons before it
+	m_bindingStarts.fill(0);
+	for(const auto& [button, binding] : bindings) ++m_bindingStarts[button + 1];
+	for(size_t button = 0; button < ButtonCount; ++button) m_bindingStarts[button + 1] += m_bindingStarts[button];
+
+	std::array<uint16_t, ButtonCount> next;
+	std::copy_n(m_bindingStarts.begin(), ButtonCount, next.begin());
+	m_bindings.resize(bindings.size());
+	for(const auto& [button, binding] : bindings) m_bindings[next[button]++] = binding;
 }
@@ -1,43 +1,113 @@
 #pragma once
 
-#include <memory>
-#include <mutex>
-#include <unordered_map>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <span>
 #include <vector>
 
 #include "input_buttons.hpp"
 #include "input_responder.hpp"
+#include "spsc_ring.hpp"
+#include "time.hpp"
 
+// The notify functions are called from the window thread and only push into a lock-free ring, everything else belongs to the app thread
+// Events keep the time they happened at, so responders see them in order and can tell how far into the frame they came in
+// Buttons index a dense table of the responder slots bound to them, so every instance dispatches without hashing or virtual calls
 class Input {
+public:
+	// Scan codes and the mouse buttons after them
+	constexpr static size_t ButtonCount = size_t(InputButton::MouseButtonMiddle) + 1;
+	// A full ring drops events, everything is released on the next update when that happens
+	constexpr static size_t QueueCapacity = 256;
+
+	struct Event {
+		// Resets are only made by the app thread after events were dropped, they release everything and carry the latest focus
+		enum class Type : uint8_t { Button, Focus, Reset };
+
+		std::chrono::steady_clock::time_point time;
+		InputButton button = InputButton::None;
+		Type type = Type::Button;
+		bool value = false;
+	};
+
+	// An event as it was handled in a frame, on the clock of Time::time()
+	struct FrameEvent {
+		double time = 0.0;
+		InputButton button = InputButton::None;
+		Event::Type type = Event::Type::Button;
+		bool value = false;
+	};
+
 public:
 	void notifyButtonPress(InputButton button);
 	void notifyButtonRelease(InputButton button);
 	void notifyFocus(bool focus);
 
-	void update();
+	// Dispatches everything that came in since the last update, the time has to be updated for this frame already
+	void update(const Time& time);
+	// Dispatches recorded events instead of the ones from the window, for replays
+	void replay(std::span<const FrameEvent> events, glm::vec2 mousePos);
 
-	void add(unsigned id, std::unique_ptr<InputResponder> responder);
+	// Responders are stored by value, pointers returned by the getters stay valid until the next add
+	void add(unsigned id, const InputAction& action);
+	void add(unsigned id, const InputAxis1D& axis);
+	void add(unsigned id, const InputAxis2D& axis);
+	// Replaces the button of one slot of a responder, returns false when there is no such responder or slot
+	bool rebind(unsigned id, unsigned slot, InputButton button);
+
+	// Null when there is no responder of that type with the id
 	const InputAction* getAction(unsigned id) const;
 	const InputAxis1D* getAxis1D(unsigned id) const;
 	const InputAxis2D* getAxis2D(unsigned id) const;
 
 	glm::vec2 getMousePos() const { return m_mousePos; }
 	bool hasFocus() const { return m_focus; }
+	// The events of the last update in the order they were dispatched
+	std::span<const FrameEvent> getFrameEvents() const { return m_frameEvents; }
 
 private:
-	struct QueuedButton {
-		InputButton id;
-		bool state;
+	enum class ResponderType : uint8_t { Action, Axis1D, Axis2D };
+
+	struct Responder {
+		unsigned id;
+		ResponderType type;
+		uint16_t index;
+	};
+
+	struct Binding {
+		ResponderType type;
+		uint8_t slot;
+		uint16_t index;
 	};
 
 private:
-	glm::vec2 m_mousePos;
-	bool m_focus;
+	void push(const Event& event);
+	void dispatch();
+	void clearState();
+	[[nodiscard]] const Responder* find(unsigned id, ResponderType type) const;
+	void addResponder(unsigned id, ResponderType type, size_t index);
+	// Rebuilds the binding table from the bindings of all responders
+	void bind();
+
+private:
+	glm::vec2 m_mousePos = glm::vec2(0.0f);
+	bool m_focus = false;
+
+	std::vector<InputAction> m_actions;
+	std::vector<InputAxis1D> m_axes1D;
+	std::vector<InputAxis2D> m_axes2D;
+	// There are only a handful of responders, they are found by scanning
+	std::vector<Responder> m_responders;
 
-	std::vector<std::unique_ptr<InputResponder>> m_responders;
-	std::unordered_map<unsigned, InputResponder*> m_responderIdMap;
-	std::unordered_map<InputButton, std::vector<InputResponder*>> m_responderInputMap;
+	// The bindings of button b are m_bindings[m_bindingStarts[b]] up to m_bindings[m_bindingStarts[b + 1]]
+	std::array<uint16_t, ButtonCount + 1> m_bindingStarts = {};
+	std::vector<Binding> m_bindings;
 
-	std::mutex m_inputMutex;
-	std::vector<QueuedButton> m_inputButtonQueue;
+	SpscRing<Event, QueueCapacity> m_events;
+	std::vector<FrameEvent> m_frameEvents;
+	std::atomic_bool m_overflowed = false;
+	// Focus events can be dropped too, so the latest one is also kept here
+	std::atomic_bool m_lastFocus = false;
 };
@@ -1,84 +1,75 @@
 #pragma once
 
+#include <array>
 #include <span>
 
 #include "input_buttons.hpp"
 #include "math.hpp"
 
-class InputResponder {
-public:
-	virtual ~InputResponder() = default;
-	virtual void notify(InputButton input, bool value) = 0;
-	virtual void clearState() = 0;
-	virtual void update() = 0;
-	[[nodiscard]] virtual std::span<const InputButton> bindings() const = 0;
-};
-
-class InputAction final : public InputResponder {
+// Responders are plain values kept in one array per type by Input, which routes every button straight to the slot it is bound to
+// Slots are the bindings in the order of the constructor arguments
+class InputAction {
 public:
 	InputAction() = default;
-	explicit InputAction(InputButton binding) : binding(binding) {}
-
-	virtual void notify(InputButton input, bool value) override;
-	virtual void clearState() override;
-	virtual void update() override;
-	[[nodiscard]] virtual std::span<const InputButton> bindings() const override;
-
-	[[nodiscard]] bool isPressed() const { return m_value && !m_prevFrameValue; }
-	[[nodiscard]] bool isReleased() const { return !m_value && m_prevFrameValue; }
+	explicit InputAction(InputButton binding) : m_binding(binding) {}
+
+	// The time is on the clock of Time::time(), events arrive in the order they happened
+	void notify(bool value, double time);
+	void clearState();
+	void update();
+	[[nodiscard]] std::span<InputButton, 1> bindings() { return std::span<InputButton, 1>(&m_binding, 1); }
+	[[nodiscard]] InputButton getBinding() const { return m_binding; }
+
+	// Presses and releases are latched for a frame, a tap that was released again within the frame still counts as pressed
+	[[nodiscard]] bool isPressed() const { return m_pressed; }
+	[[nodiscard]] bool isReleased() const { return m_released; }
 	[[nodiscard]] bool isDown() const { return m_value; }
-
-public:
-	InputButton binding = InputButton::None;
+	// When the last press happened, on the clock of Time::time()
+	[[nodiscard]] double getPressTime() const { return m_pressTime; }
 
 private:
+	InputButton m_binding = InputButton::None;
 	bool m_value = false;
-	bool m_prevFrameValue = false;
+	bool m_pressed = false;
+	bool m_released = false;
+	double m_pressTime = 0.0;
 };
 
-class InputAxis1D final : public InputResponder {
+class InputAxis1D {
 public:
-	explicit InputAxis1D(InputButton bindingPos, InputButton bindingNeg) : bindingPos(bindingPos), bindingNeg(bindingNeg) {}
-
-	virtual void notify(InputButton input, bool value) override;
-	virtual void clearState() override;
-	virtual void update() override {};
-	[[nodiscard]] virtual std::span<const InputButton> bindings() const override;
+	explicit InputAxis1D(InputButton bindingPos, InputButton bindingNeg) : m_bindings{ bindingPos, bindingNeg } {}
 
-	[[nodiscard]] float getValue() const { return (m_valuePos ? 1.0f : 0.0f) - (m_valueNeg ? 1.0f : 0.0f); }
+	void notify(unsigned slot, bool value) { m_values[slot] = value; }
+	void clearState() { m_values = {}; }
+	[[nodiscard]] std::span<InputButton, 2> bindings() { return m_bindings; }
+	[[nodiscard]] InputButton getBindingPos() const { return m_bindings[0]; }
+	[[nodiscard]] InputButton getBindingNeg() const { return m_bindings[1]; }
 
-public:
-	InputButton bindingPos = InputButton::None;
-	InputButton bindingNeg = InputButton::None;
+	[[nodiscard]] float getValue() const { return (m_values[0] ? 1.0f : 0.0f) - (m_values[1] ? 1.0f : 0.0f); }
 
 private:
-	bool m_valuePos = false;
-	bool m_valueNeg = false;
+	std::array<InputButton, 2> m_bindings;
+	std::array<bool, 2> m_values = {};
 };
 
-class InputAxis2D final : public InputResponder {
+class InputAxis2D {
 public:
 	explicit InputAxis2D(InputButton bindingUp, InputButton bindingDown, InputButton bindingLeft, InputButton bindingRight) :
-	    bindingUp(bindingUp), bindingDown(bindingDown), bindingLeft(bindingLeft), bindingRight(bindingRight) {}
+	    m_bindings{ bindingUp, bindingDown, bindingLeft, bindingRight } {}
 
-	virtual void notify(InputButton input, bool value) override;
-	virtual void clearState() override;
-	virtual void update() override {};
-	[[nodiscard]] virtual std::span<const InputButton> bindings() const override;
+	void notify(unsigned slot, bool value) { m_values[slot] = value; }
+	void clearState() { m_values = {}; }
+	[[nodiscard]] std::span<InputButton, 4> bindings() { return m_bindings; }
+	[[nodiscard]] InputButton getBindingUp() const { return m_bindings[0]; }
+	[[nodiscard]] InputButton getBindingDown() const { return m_bindings[1]; }
+	[[nodiscard]] InputButton getBindingLeft() const { return m_bindings[2]; }
+	[[nodiscard]] InputButton getBindingRight() const { return m_bindings[3]; }
 
 	[[nodiscard]] glm::vec2 getValue() const {
-		return glm::vec2((m_valueRight ? 1.0f : 0.0f) - (m_valueLeft ? 1.0f : 0.0f), (m_valueDown ? 1.0f : 0.0f) - (m_valueUp ? 1.0f : 0.0f));
+		return glm::vec2((m_values[3] ? 1.0f : 0.0f) - (m_values[2] ? 1.0f : 0.0f), (m_values[1] ? 1.0f : 0.0f) - (m_values[0] ? 1.0f : 0.0f));
 	}
 
-public:
-	InputButton bindingUp = InputButton::None;
-	InputButton bindingDown = InputButton::None;
-	InputButton bindingLeft = InputButton::None;
-	InputButton bindingRight = InputButton::None;
-
 private:
-	bool m_valueUp = false;
-	bool m_valueDown = false;
-	bool m_valueLeft = false;
-	bool m_valueRight = false;
+	std::array<InputButton, 4> m_bindings;
+	std::array<bool, 4> m_values = {};
 };
@@ -0,0 +1,268 @@
+#include "logger.hpp"
+
+#ifndef SHIPPING
+	#include <array>
+	#include <atomic>
+	#include <condition_variable>
+	#include <cstdio>
+	#include <fstream>
+	#include <memory>
+	#include <mutex>
+	#include <new>
+	#include <span>
+	#include <thread>
+	#include <vector>
+
+namespace {
+	// Has to be a power of two, a record can take up to half of it
+	constexpr size_t BufferCapacity = size_t(64) * 1024;
+	constexpr size_t RecordAlignment = 8;
+	// The background thread writes at least this often, and right away when someone flushes
+	constexpr auto WriteInterval = std::chrono::milliseconds(20);
+
+	constexpr std::array<std::string_view, 3> ConsolePrefixes = { "> ", "\033[1;33mWarn >\033[0m ", "\033[1;31mError >\033[0m " };
+	constexpr std::array<std::string_view, 3> FilePrefixes = { "> ", "Warn > ", "Error > " };
+
+	// The arguments follow the header, a record without a format function only skips the rest of the buffer
+	// Records that would not fit in the bytes left before the end of the buffer start over at its beginning
+	struct RecordHeader {
+		uint32_t size = 0;
+		logger::Level level = logger::Level::Log;
+		uint64_t sequence = 0;
+		logger::detail::FormatFunction format = nullptr;
+		std::string_view formatString = {};
+	};
+
+	static_assert(sizeof(RecordHeader) % RecordAlignment == 0, "Records have to stay aligned");
+
+	// Records of one thread, written by that thread and read by the background thread
+	// Both positions only grow, they are masked to index the data
+	struct ThreadBuffer {
+		alignas(64) std::atomic_uint64_t write = 0;
+		uint64_t cachedRead = 0;
+		// Where the write position moves when the record that is being written is committed
+		uint64_t next = 0;
+		std::atomic_uint64_t dropped = 0;
+
+		alignas(64) std::atomic_uint64_t read = 0;
+		uint64_t reportedDropped = 0;
+
+		alignas(64) std::array<std::byte, BufferCapacity> data;
+	};
+
+	// Records of different threads come out in the order they were started in
+	std::atomic_uint64_t s_sequence = 0;
+
+	// The last time every call site logged, call sites that share a slot can occasionally let a message through early
+	struct RateLimit {
+		std::atomic<const char*> site = nullptr;
+		std::atomic_int64_t next = 0;
+	};
+
+	std::array<RateLimit, 64> s_rateLimits;
+
+	class Writer {
+	public:
+		Writer() : m_thread([this](const std::stop_token& stopToken) { run(stopToken); }) {}
+		Writer(const Writer&) = delete;
+		Writer& operator=(const Writer&) = delete;
+		Writer(Writer&&) = delete;
+		Writer& operator=(Writer&&) = delete;
+		// The background thread writes everything that is left before it stops
+		~Writer() = default;
+
+		// Buffers stay around until the process exits, threads that log come and go rarely
+		ThreadBuffer& addThread() {
+			std::lock_guard lock(m_mutex);
+			return *m_buffers.emplace_back(std::make_unique<ThreadBuffer>());
+		}
+
+		bool openFile(const std::filesystem::path& path) {
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			if(!file) return false;
+			std::lock_guard lock(m_mutex);
+			m_file = std::move(file);
+			return true;
+		}
+
+		void flush() {
+			std::unique_lock lock(m_mutex);
+			uint64_t ticket = ++m_flushRequests;
+			m_wake.notify_all();
+			m_flushed.wait(lock, [&]() { return m_completedFlushes >= ticket; });
+		}
+
+	private:
+		void run(const std::stop_token& stopToken) {
+			std::vector<ThreadBuffer*> buffers;
+			while(true) {
+				uint64_t requests = 0;
+				{
+					std::unique_lock lock(m_mutex);
+					m_wake.wait_for(lock, stopToken, WriteInterval, [&]() { return m_flushRequests != m_completedFlushes; });
+					requests = m_flushRequests;
+					buffers.clear();
+					for(const auto& buffer : m_buffers) buffers.push_back(buffer.get());
+				}
+
+				m_console.clear();
+				m_text.clear();
+				drain(buffers);
+				if(!m_console.empty()) {
+					std::fwrite(m_console.data(), 1, m_console.size(), stdout);
+					std::fflush(stdout);
+				}
+
+				{
+					std::lock_guard lock(m_mutex);
+					if(!m_text.empty() && m_file.is_open()) {
+						m_file.write(m_text.data(), std::streamsize(m_text.size()));
+						m_file.flush();
+					}
+					m_completedFlushes = requests;
+				}
+				m_flushed.notify_all();
+
+				if(stopToken.stop_requested()) return;
+			}
+		}
+
+		// Writes the records of all threads merged by their sequence numbers, until every buffer is empty
+		void drain(std::span<ThreadBuffer* const> buffers) {
+			while(true) {
+				ThreadBuffer* oldest = nullptr;
+				const RecordHeader* oldestRecord = nullptr;
+				for(ThreadBuffer* buffer : buffers) {
+					const RecordHeader* record = peek(*buffer);
+					if(record && (!oldestRecord || record->sequence < oldestRecord->sequence)) {
+						oldest = buffer;
+						oldestRecord = record;
+					}
+				}
+				if(!oldest) break;
+
+				m_line.clear();
+				oldestRecord->format(oldestRecord->formatString, reinterpret_cast<const std::byte*>(oldestRecord + 1), m_line); // NOLINT
+				append(oldestRecord->level, m_line);
+				oldest->read.store(oldest->read.load(std::memory_order_relaxed) + oldestRecord->size, std::memory_order_release);
+			}
+
+			for(ThreadBuffer* buffer : buffers) {
+				uint64_t dropped = buffer->dropped.load(std::memory_order_relaxed);
+				if(dropped == buffer->reportedDropped) continue;
+				append(
+				    logger::Level::Warn,
+				    std::format("{} log messages were dropped, a thread logged faster than they were written", dropped - buffer->reportedDropped)
+				);
+				buffer->reportedDropped = dropped;
+			}
+		}
+
+		// The next record of the buffer, skips the end of the buffer when the record continues at the beginning
+		static const RecordHeader* peek(ThreadBuffer& buffer) {
+			uint64_t read = buffer.read.load(std::memory_order_relaxed);
+			uint64_t write = buffer.write.load(std::memory_order_acquire);
+			while(read != write) {
+				size_t offset = read & (BufferCapacity - 1);
+				size_t left = BufferCapacity - offset;
+				const auto* record = reinterpret_cast<const RecordHeader*>(buffer.data.data() + offset); // NOLINT
+				if(left >= sizeof(RecordHeader) && record->format) return record;
+
+				read += left < sizeof(RecordHeader) ? left : record->size;
+				buffer.read.store(read, std::memory_order_release);
+			}
+			return nullptr;
+		}
+
+		void append(logger::Level level, std::string_view line) {
+			m_console.append(ConsolePrefixes[size_t(level)]).append(line).push_back('\n');
+			m_text.append(FilePrefixes[size_t(level)]).append(line).push_back('\n');
+		}
+
+	private:
+		std::mutex m_mutex;
+		std::condition_variable_any m_wake;
+		std::condition_variable_any m_flushed;
+		std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+		std::ofstream m_file;
+		uint64_t m_flushRequests = 0;
+		uint64_t m_completedFlushes = 0;
+
+		// Only used by the background thread
+		std::string m_line;
+		std::string m_console;
+		std::string m_text;
+
+		// Declared last so it stops before anything it uses is destroyed
+		std::jthread m_thread;
+	};
+
+	Writer& getWriter() {
+		static Writer writer;
+		return writer;
+	}
+
+	thread_local ThreadBuffer* t_buffer = nullptr;
+} // namespace
+
+std::byte* logger::detail::begin(Level level, std::string_view format, FormatFunction formatFunction, size_t argumentSize) {
+	if(!t_buffer) t_buffer = &getWriter().addThread();
+	ThreadBuffer& buffer = *t_buffer;
+
+	size_t size = (sizeof(RecordHeader) + argumentSize + RecordAlignment - 1) & ~(RecordAlignment - 1);
+	uint64_t write = buffer.write.load(std::memory_order_relaxed);
+	size_t offset = write & (BufferCapacity - 1);
+	size_t skip = BufferCapacity - offset < size ? BufferCapacity - offset : 0;
+
+	if(size > BufferCapacity / 2 || write + skip + size - buffer.cachedRead > BufferCapacity) {
+		buffer.cachedRead = buffer.read.load(std::memory_order_acquire);
+		if(size > BufferCapacity / 2 || write + skip + size - buffer.cachedRead > BufferCapacity) {
+			buffer.dropped.store(buffer.dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+	}
+
+	if(skip > 0) {
+		if(skip >= sizeof(RecordHeader)) new(buffer.data.data() + offset) RecordHeader{ .size = uint32_t(skip) };
+		offset = 0;
+	}
+
+	new(buffer.data.data() + offset) RecordHeader{
+		.size = uint32_t(size),
+		.level = level,
+		.sequence = s_sequence.fetch_add(1, std::memory_order_relaxed),
+		.format = formatFunction,
+		.formatString = format,
+	};
+	buffer.next = write + skip + size;
+	return buffer.data.data() + offset + sizeof(RecordHeader);
+}
+
+void logger::detail::commit() {
+	t_buffer->write.store(t_buffer->next, std::memory_order_release);
+}
+
+bool logger::detail::isRateLimited(const char* site, std::chrono::milliseconds interval) {
+	int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	int64_t period = std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count();
+
+	RateLimit& rateLimit = s_rateLimits[(reinterpret_cast<uintptr_t>(site) / RecordAlignment) % s_rateLimits.size()]; // NOLINT
+	if(rateLimit.site.load(std::memory_order_relaxed) != site) {
+		rateLimit.site.store(site, std::memory_order_relaxed);
+		rateLimit.next.store(now + period, std::memory_order_relaxed);
+		return false;
+	}
+
+	// Only one of the threads that get here at the same time wins the slot
+	int64_t next = rateLimit.next.load(std::memory_order_relaxed);
+	return now < next || !rateLimit.next.compare_exchange_strong(next, now + period, std::memory_order_relaxed);
+}
+
+bool logger::openFile(const std::filesystem::path& path) {
+	return getWriter().openFile(path);
+}
+
+void logger::flush() {
+	getWriter().flush();
+}
+#endif
@@ -1,9 +1,29 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
 #include <format>
-#include <print>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
 
+// Calls below this level are compiled out, 0 keeps everything, 1 only warnings and errors and 2 only errors
+#ifndef LOG_LEVEL
+	#define LOG_LEVEL 0
+#endif
+
+// Logging only copies the format string and the arguments into a buffer of the calling thread, a background thread formats and writes them
+// The buffers are lock-free, a thread that logs faster than the background thread keeps up with drops messages instead of waiting
 namespace logger {
+	enum class Level : uint8_t { Log, Warn, Error };
+
+	constexpr Level MinLevel = Level(LOG_LEVEL);
+
 	// NOLINTBEGIN
 #ifdef SHIPPING
 	template<typename... T>
@@ -14,21 +34,126 @@ namespace logger {
 
 	template<typename... T>
 	inline void error([[maybe_unused]] std::format_string<T...> msg, [[maybe_unused]] T&&... args) {}
+
+	template<typename... T>
+	inline void warnEvery(
+	    [[maybe_unused]] std::chrono::milliseconds interval, [[maybe_unused]] std::format_string<T...> msg, [[maybe_unused]] T&&... args
+	) {}
+
+	template<typename... T>
+	inline void errorEvery(
+	    [[maybe_unused]] std::chrono::milliseconds interval, [[maybe_unused]] std::format_string<T...> msg, [[maybe_unused]] T&&... args
+	) {}
+
+	inline bool openFile([[maybe_unused]] const std::filesystem::path& path) { return false; }
+	inline void flush() {}
 #else
+	namespace detail {
+		// Formats the arguments that were copied into a record
+		using FormatFunction = void (*)(std::string_view format, const std::byte* arguments, std::string& out);
+
+		// Strings are copied with their characters, everything else is copied as is
+		template<typename T>
+		using Stored = std::conditional_t<std::is_convertible_v<const T&, std::string_view>, std::string_view, std::remove_cvref_t<T>>;
+
+		template<typename T>
+		size_t getStoredSize(const T& argument) {
+			if constexpr(std::is_same_v<Stored<T>, std::string_view>) {
+				return sizeof(uint32_t) + std::string_view(argument).size();
+			} else {
+				static_assert(std::is_trivially_copyable_v<Stored<T>>, "Log arguments are copied as bytes, format anything else to a string first");
+				return sizeof(T);
+			}
+		}
+
+		template<typename T>
+		std::byte* store(std::byte* out, const T& argument) {
+			if constexpr(std::is_same_v<Stored<T>, std::string_view>) {
+				std::string_view string = argument;
+				auto size = uint32_t(string.size());
+				std::memcpy(out, &size, sizeof(size));
+				std::memcpy(out + sizeof(size), string.data(), size);
+				return out + sizeof(size) + size;
+			} else {
+				std::memcpy(out, &argument, sizeof(T));
+				return out + sizeof(T);
+			}
+		}
+
+		template<typename T>
+		T load(const std::byte*& in) {
+			if constexpr(std::is_same_v<T, std::string_view>) {
+				uint32_t size;
+				std::memcpy(&size, in, sizeof(size));
+				std::string_view string(reinterpret_cast<const char*>(in + sizeof(size)), size);
+				in += sizeof(size) + size;
+				return string;
+			} else {
+				T value;
+				std::memcpy(&value, in, sizeof(T));
+				in += sizeof(T);
+				return value;
+			}
+		}
+
+		template<typename... T>
+		void formatRecord(std::string_view format, const std::byte* arguments, std::string& out) {
+			// Braces make the arguments load in order
+			std::tuple<T...> values{ load<T>(arguments)... };
+			std::apply([&](T&... args) { std::vformat_to(std::back_inserter(out), format, std::make_format_args(args...)); }, values);
+		}
+
+		// Returns where the arguments go, or null when the buffer of the thread is full
+		std::byte* begin(Level level, std::string_view format, FormatFunction formatFunction, size_t argumentSize);
+		void commit();
+		// Whether the call site, told apart by its format string, logged less than the interval ago
+		bool isRateLimited(const char* site, std::chrono::milliseconds interval);
+
+		template<typename... T>
+		void write(Level level, std::string_view format, const T&... args) {
+			std::byte* out = begin(level, format, &formatRecord<Stored<T>...>, (size_t(0) + ... + getStoredSize(args)));
+			if(!out) return;
+			((out = store(out, args)), ...);
+			commit();
+		}
+	} // namespace detail
+
+	template<typename... T>
+	inline void log([[maybe_unused]] std::format_string<T...> msg, [[maybe_unused]] T&&... args) {
+		if constexpr(MinLevel <= Level::Log) detail::write(Level::Log, msg.get(), args...);
+	}
+
+	template<typename... T>
+	inline void warn([[maybe_unused]] std::format_string<T...> msg, [[maybe_unused]] T&&... args) {
+		if constexpr(MinLevel <= Level::Warn) detail::write(Level::Warn, msg.get(), args...);
+	}
+
 	template<typename... T>
-	inline void log(std::format_string<T...> msg, T&&... args) {
-		std::println("> {}", std::format(msg, std::forward<T>(args)...));
+	inline void error([[maybe_unused]] std::format_string<T...> msg, [[maybe_unused]] T&&... args) {
+		if constexpr(MinLevel <= Level::Error) detail::write(Level::Error, msg.get(), args...);
 	}
 
+	// For messages that could repeat every frame, they are dropped while the same call site logged less than the interval ago
 	template<typename... T>
-	inline void warn(std::format_string<T...> msg, T&&... args) {
-		std::println("\033[1;33mWarn >\033[0m {}", std::format(msg, std::forward<T>(args)...));
+	inline void warnEvery(
+	    [[maybe_unused]] std::chrono::milliseconds interval, [[maybe_unused]] std::format_string<T...> msg, [[maybe_unused]] T&&... args
+	) {
+		if constexpr(MinLevel <= Level::Warn)
+			if(!detail::isRateLimited(msg.get().data(), interval)) detail::write(Level::Warn, msg.get(), args...);
 	}
 
 	template<typename... T>
-	inline void error(std::format_string<T...> msg, T&&... args) {
-		std::println("\033[1;31mError >\033[0m {}", std::format(msg, std::forward<T>(args)...));
+	inline void errorEvery(
+	    [[maybe_unused]] std::chrono::milliseconds interval, [[maybe_unused]] std::format_string<T...> msg, [[maybe_unused]] T&&... args
+	) {
+		if constexpr(MinLevel <= Level::Error)
+			if(!detail::isRateLimited(msg.get().data(), interval)) detail::write(Level::Error, msg.get(), args...);
 	}
+
+	// Everything is written to the file as well as the console from now on
+	bool openFile(const std::filesystem::path& path);
+	// Blocks until everything that was logged so far is written, has to be called before the process goes down without returning from main
+	void flush();
 #endif
 	// NOLINTEND
 } // namespace logger
@@ -1,34 +1,59 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cwchar>
+#include <filesystem>
+#include <format>
+#include <optional>
+#include <string_view>
 #include <thread>
+#include <vector>
 
+#include "animation/state_machine_library.hpp"
+#include "asset_loader.hpp"
 #include "input/input_ids.hpp"
 #include "physics/intersection.hpp"
 #include "physics/window_physics.hpp"
 #include "platform.hpp"
+#include "profiler.hpp"
 #include "rendering/graphics_context.hpp"
+#include "rendering/render_pipeline.hpp"
 #include "rendering/sprite_atlas.hpp"
+#include "rendering/sprite_sort_key.hpp"
 #include "rendering/surface_manager.hpp"
+#include "rendering/text_cache.hpp"
+#include "replay.hpp"
 #include "scene/entities/player.hpp"
 #include "scene/scene.hpp"
 #include "time.hpp"
 
 static std::atomic_bool s_closeRequested; // NOLINT
 
-static void applicationLoop() {
-	constexpr Sprite playerSprites[] = {
-		SpriteAtlas::get("player_duck.png"),   SpriteAtlas::get("player_fall.png"),  SpriteAtlas::get("player_idle_2.png"),
-		SpriteAtlas::get("player_idle_1.png"), SpriteAtlas::get("player_jump.png"),  SpriteAtlas::get("player_run_1.png"),
-		SpriteAtlas::get("player_run_2.png"),  SpriteAtlas::get("player_run_3.png"), SpriteAtlas::get("player_run_4.png"),
-		SpriteAtlas::get("player_run_5.png"),  SpriteAtlas::get("player_run_6.png"), SpriteAtlas::get("player_slide.png"),
-	};
+// Written with --record, played back with --replay or as fast as possible without windows with --replay-headless
+constexpr static const wchar_t* ReplayPath = L"replay.bin";
+// Written with --profile when the application closes, opens in chrome://tracing or Perfetto
+constexpr static const wchar_t* TracePath = L"trace.json";
+// Ctrl+Alt+P writes trace_1.json, trace_2.json and so on while the capture keeps running
+constexpr static int ExportTraceHotKey = 1;
 
-	CharacterAnimations playerAnimations = {
-		.idle = Animation(std::span(&playerSprites[2], 2), 24, 8),
-		.run = Animation(std::span(&playerSprites[5], 6), 24, 2),
-		.jump = Animation(std::span(&playerSprites[4], 1), 24, 2),
-		.fall = Animation(std::span(&playerSprites[1], 1), 24, 2),
-		.slide = Animation(std::span(&playerSprites[11], 1), 24, 2),
-		.duck = Animation(std::span(&playerSprites[0], 1), 24, 2),
-	};
+// Live sessions and replays start from the same scene, otherwise a replay would not play out like the recording did
+static Entity* populateScene(Scene& scene, Input& input) {
+	const StateMachineDefinition* playerAnimations = StateMachineLibrary::find("player");
+	if(!playerAnimations) fatalError("The player animation state machine is missing");
+
+	input.add(InputId_PlayerMovement, InputAxis1D(InputButton::KeyRight, InputButton::KeyLeft));
+	input.add(InputId_PlayerJump, InputAction(InputButton::KeyUp));
+	input.add(InputId_PlayerDuck, InputAction(InputButton::KeyDown));
+
+	auto* player = scene.addEntity(std::make_unique<Player>(*playerAnimations, &input));
+	player->position = glm::vec2(48.0f, 48.0f);
+	player->flags = 1;
+	return player;
+}
+
+static void applicationLoop(std::chrono::steady_clock::time_point startupBegin) {
+	profiler::setThreadName("Simulation");
 
 	WindowPhysics windowPhysics;
 	windowPhysics.generateScreenBounds();
@@ -36,61 +61,348 @@ static void applicationLoop() {
 	Scene scene;
 	scene.addWindowPhysics(&windowPhysics);
 
-	SurfaceManager::getInstance().getMainInput().add(
-	    InputId_PlayerMovement, std::make_unique<InputAxis1D>(InputButton::KeyRight, InputButton::KeyLeft)
-	);
-	SurfaceManager::getInstance().getMainInput().add(InputId_PlayerJump, std::make_unique<InputAction>(InputButton::KeyUp));
-	SurfaceManager::getInstance().getMainInput().add(InputId_PlayerDuck, std::make_unique<InputAction>(InputButton::KeyDown));
+	Input& input = SurfaceManager::getInstance().getMainInput();
+	Entity* player = populateScene(scene, input);
 
-	auto* player = scene.addEntity(std::make_unique<Player>(std::move(playerAnimations), &SurfaceManager::getInstance().getMainInput()));
-	player->position = glm::vec2(48.0f, 48.0f);
-	player->flags = 1;
+	// A replay stands in for the clock, the input and the desktop windows until it runs out, then the session continues live
+	std::optional<ReplayReader> replay;
+	std::optional<ReplayRecorder> recorder;
+	std::wstring_view commandLine = GetCommandLineW();
+	if(commandLine.contains(L"--replay")) {
+		replay = ReplayReader::open(ReplayPath);
+		if(replay) {
+			windowPhysics.setScreenEdges(replay->getScreenEdges());
+		} else {
+			logger::error("Could not read the replay");
+		}
+	} else if(commandLine.contains(L"--record")) {
+		recorder = ReplayRecorder::create(ReplayPath, windowPhysics);
+		if(!recorder) logger::error("Could not create the replay");
+	}
 
 	Time time;
+	FrameScheduler& scheduler = SurfaceManager::getInstance().getFrameScheduler();
+	// Measures the frame time without overlapping the simulation with the rendering
+	RenderPipeline pipeline(!commandLine.contains(L"--serial-render"));
 
 	while(!s_closeRequested) {
-		time.update();
-		SurfaceManager::getInstance().getMainInput().update();
-		windowPhysics.update();
+		{
+			PROFILE_ZONE("Wait for frame");
+			scheduler.waitForNextFrame();
+		}
 
-		scene.update(time);
+		PROFILE_ZONE("Frame");
+		RenderPacket& packet = pipeline.beginPacket();
 
-		for(const auto& surface : SurfaceManager::getInstance().getScreenSurfaces()) {
-			Camera camera = { .view = glm::mat4(1.0f), .proj = surface->getProjectionMatrix(), .target = surface.get() };
-			GraphicsContext::getInstance().drawSprites(camera, scene.buildSprites());
+		for(const auto& surface : SurfaceManager::getInstance().getScreenSurfaces())
+			packet.cameras.push_back({ .view = glm::mat4(1.0f), .proj = surface->getProjectionMatrix(), .target = surface.get() });
 
-#ifdef _DEBUG
-			GraphicsContext::getInstance().getDebugRenderer().draw();
-#endif
+		// Nothing can be seen, only check now and then whether that is still the case
+		if(!scheduler.shouldRender()) {
+			packet.draw = false;
+			pipeline.submitPacket();
+			scheduler.setOccluded(pipeline.isOccluded() || SurfaceManager::getInstance().isDesktopCovered());
+			continue;
 		}
 
+		if(replay && replay->next()) {
+			replay->apply(time, input, windowPhysics);
+		} else {
+			if(replay) {
+				logger::log("Replay: {} frames, player at ({:.2f}, {:.2f})", replay->getFrameCount(), player->position.x, player->position.y);
+				replay.reset();
+				windowPhysics.generateScreenBounds();
+			}
+
+			time.update();
+			input.update(time);
+			bool layoutChanged = windowPhysics.update();
+			if(recorder) recorder->record(time, input, windowPhysics, layoutChanged);
+		}
+
+		scene.update(time);
+		if(scene.isActive()) scheduler.markActive();
+
+		scene.buildSprites(packet.sprites, packet.spriteKeys);
 #ifdef _DEBUG
-		GraphicsContext::getInstance().getDebugRenderer().clear();
+		GraphicsContext::getInstance().getDebugRenderer().swapFrame(packet.debugFrame);
 #endif
 
-		bool first = true;
-		for(const auto& surface : SurfaceManager::getInstance().getScreenSurfaces()) {
-			surface->getSwapchain()->Present(first ? 1 : 0, 0);
-			first = false;
+		pipeline.submitPacket();
+		scheduler.setOccluded(pipeline.isOccluded() || SurfaceManager::getInstance().isDesktopCovered());
+	}
+
+	pipeline.stop();
+
+	if(recorder) logger::log("Recorded {} frames, player at ({:.2f}, {:.2f})", recorder->getFrameCount(), player->position.x, player->position.y);
+
+	const auto& stats = pipeline.getStats();
+	logger::log(
+	    "Render pipeline ({}): {} frames, {:.2f} ms/frame",
+	    stats.pipelined ? "pipelined" : "serial",
+	    stats.frames,
+	    stats.getFrameMilliseconds()
+	);
+	if(stats.firstFrame != std::chrono::steady_clock::time_point()) {
+		logger::log("Time to first frame: {:.2f} ms", std::chrono::duration<double, std::milli>(stats.firstFrame - startupBegin).count());
+	}
+}
+
+static void exportProfile(const std::filesystem::path& path) {
+	if(profiler::exportTrace(path)) {
+		logger::log("Wrote the profile to {}", path.string());
+	} else {
+		logger::error("Could not write the profile");
+	}
+}
+
+#ifndef SHIPPING
+// Draws the same frames of thousands of moving sprites through the render thread and then without it
+// Building the sprites stands in for the simulation, with the render thread it overlaps the drawing of the frame before
+static void runPipelineBenchmark(unsigned spriteCount, unsigned frameCount) {
+	constexpr Sprite PropSprite = SpriteAtlas::get("player_idle_1.png");
+	const glm::vec2 propSize = glm::vec2(PropSprite.getWidth(), PropSprite.getHeight());
+	const ScreenSurface& screen = *SurfaceManager::getInstance().getScreenSurfaces().front();
+
+	std::array<double, 2> milliseconds = {};
+	for(bool pipelined : { true, false }) {
+		RenderPipeline pipeline(pipelined);
+		for(unsigned frame = 0; frame < frameCount; ++frame) {
+			RenderPacket& packet = pipeline.beginPacket();
+			packet.vsync = false;
+			for(const auto& surface : SurfaceManager::getInstance().getScreenSurfaces())
+				packet.cameras.push_back({ .view = glm::mat4(1.0f), .proj = surface->getProjectionMatrix(), .target = surface.get() });
+
+			for(unsigned i = 0; i < spriteCount; ++i) {
+				float angle = (float(frame) * 0.05f) + float(i);
+				glm::vec2 anchor = glm::vec2(float((i * 7919) % screen.getWidth()), float((i * 104729) % screen.getHeight()));
+				glm::vec2 position = glm::vec2(screen.getPosition()) + anchor + (glm::vec2(std::cos(angle), std::sin(angle)) * 32.0f);
+
+				SpriteDrawable& drawable = packet.sprites.emplace_back();
+				drawable.setSprite(PropSprite);
+				drawable.setTransform(Affine2D::translate(position) * Affine2D::scale(propSize));
+				packet.spriteKeys.push_back(SpriteSortKey{ .depth = i }.pack(PropSprite.getPage()));
+			}
+			pipeline.submitPacket();
+		}
+		pipeline.stop();
+		milliseconds[pipelined ? 0 : 1] = pipeline.getStats().getFrameMilliseconds();
+	}
+
+	logger::log(
+	    "Render pipeline benchmark: {} sprites, {} frames, pipelined {:.2f} ms/frame, serial {:.2f} ms/frame",
+	    spriteCount,
+	    frameCount,
+	    milliseconds[0],
+	    milliseconds[1]
+	);
+}
+
+// Draws thousands of props that never move, first sent with every frame like the entity sprites and then from the static layer
+// Once the static chunks are uploaded a frame only draws them, so it should cost about as much as a frame without any props
+static void runStaticLayerBenchmark(unsigned propCount, unsigned frameCount) {
+	constexpr Sprite PropSprite = SpriteAtlas::get("player_idle_1.png");
+	const glm::vec2 propSize = glm::vec2(PropSprite.getWidth(), PropSprite.getHeight());
+	const ScreenSurface& screen = *SurfaceManager::getInstance().getScreenSurfaces().front();
+
+	std::vector<SpriteDrawable> props(propCount);
+	for(unsigned i = 0; i < propCount; ++i) {
+		glm::vec2 anchor = glm::vec2(float((i * 7919) % screen.getWidth()), float((i * 104729) % screen.getHeight()));
+		props[i].setSprite(PropSprite);
+		props[i].setTransform(Affine2D::translate(glm::vec2(screen.getPosition()) + anchor) * Affine2D::scale(propSize));
+	}
+
+	// Serial, so the frame time includes the drawing of the props
+	auto runFrames = [&](bool dynamicProps) {
+		RenderPipeline pipeline(false);
+		for(unsigned frame = 0; frame < frameCount; ++frame) {
+			RenderPacket& packet = pipeline.beginPacket();
+			packet.vsync = false;
+			for(const auto& surface : SurfaceManager::getInstance().getScreenSurfaces())
+				packet.cameras.push_back({ .view = glm::mat4(1.0f), .proj = surface->getProjectionMatrix(), .target = surface.get() });
+
+			if(dynamicProps) {
+				packet.sprites.insert(packet.sprites.end(), props.begin(), props.end());
+				for(unsigned i = 0; i < propCount; ++i) packet.spriteKeys.push_back(SpriteSortKey{ .depth = i }.pack(PropSprite.getPage()));
+			}
+			pipeline.submitPacket();
 		}
+		return pipeline.getStats().getFrameMilliseconds();
+	};
+
+	double empty = runFrames(false);
+	double dynamic = runFrames(true);
+
+	StaticSpriteLayer& layer = GraphicsContext::getInstance().getStaticSprites();
+	std::vector<StaticSpriteLayer::Handle> handles;
+	for(unsigned i = 0; i < propCount; ++i) handles.push_back(layer.add(props[i], { .depth = i }));
+	size_t uploadsBefore = layer.getStats().uploads;
+	double staticLayer = runFrames(false);
+
+	// Every chunk is uploaded in the first frame and never again
+	size_t chunks = layer.getStats().chunks;
+	size_t uploads = layer.getStats().uploads - uploadsBefore;
+
+	for(StaticSpriteLayer::Handle handle : handles) layer.remove(handle);
+	runFrames(false);
+
+	logger::log(
+	    "Static layer benchmark: {} props, {} frames, none {:.2f} ms/frame, sent every frame {:.2f} ms/frame, static {:.2f} ms/frame",
+	    propCount,
+	    frameCount,
+	    empty,
+	    dynamic,
+	    staticLayer
+	);
+	logger::log("Static layer benchmark: {} chunks, {} uploads, {} chunks left after removing the props", chunks, uploads, layer.getStats().chunks);
+}
+
+// Runs in place of the application loop, asks the main thread to quit once it is done
+static void runBenchmarks(DWORD mainThread) {
+	profiler::setThreadName("Benchmark");
+	TextCache::runBenchmark(5000, 100);
+	runPipelineBenchmark(20000, 300);
+	runStaticLayerBenchmark(20000, 300);
+	PostThreadMessage(mainThread, WM_QUIT, 0, 0);
+}
+
+// Simulates a recorded session as fast as possible without any windows, the same work as the live frames minus the rendering
+static void runHeadlessReplay() {
+	std::optional<ReplayReader> replay = ReplayReader::open(ReplayPath);
+	if(!replay) {
+		logger::error("Could not read the replay");
+		return;
+	}
+
+	WindowPhysics windowPhysics;
+	windowPhysics.setScreenEdges(replay->getScreenEdges());
+
+	Scene scene;
+	scene.addWindowPhysics(&windowPhysics);
+
+	Input input;
+	Entity* player = populateScene(scene, input);
+
+	Time time;
+	std::vector<SpriteDrawable> sprites;
+	std::vector<uint64_t> keys;
+	#ifdef _DEBUG
+	DebugRenderer::Frame debugFrame;
+	#endif
+
+	using Clock = std::chrono::steady_clock;
+	Clock::duration slowest = Clock::duration::zero();
+	auto begin = Clock::now();
+	while(replay->next()) {
+		PROFILE_ZONE("Frame");
+		auto frameBegin = Clock::now();
+		replay->apply(time, input, windowPhysics);
+		scene.update(time);
+
+		sprites.clear();
+		keys.clear();
+		scene.buildSprites(sprites, keys);
+	#ifdef _DEBUG
+		GraphicsContext::getInstance().getDebugRenderer().swapFrame(debugFrame);
+		debugFrame.clear();
+	#endif
+		slowest = std::max(slowest, Clock::now() - frameBegin);
 	}
+
+	double total = std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+	logger::log(
+	    "Replay: {} frames, {:.3f} ms/frame, slowest {:.3f} ms, player at ({:.2f}, {:.2f})",
+	    replay->getFrameCount(),
+	    total / double(std::max(replay->getFrameCount(), size_t(1))),
+	    std::chrono::duration<double, std::milli>(slowest).count(),
+	    player->position.x,
+	    player->position.y
+	);
 }
+#endif
 
 static int runApp(HINSTANCE hInstance) {
-	GraphicsContext::initialize();
-	SurfaceManager::initialize(hInstance);
-	SpriteAtlas::load();
+	if(std::wstring_view(GetCommandLineW()).contains(L"--log-file") && !logger::openFile("log.txt")) logger::error("Could not create the log file");
+
+#ifndef SHIPPING
+	// Only the benchmarks that need the device or the embedded atlas run in the application, the platform independent ones are in tools/tests
+	bool benchmark = std::wstring_view(GetCommandLineW()).contains(L"--benchmark");
+	bool headlessReplay = std::wstring_view(GetCommandLineW()).contains(L"--replay-headless");
+#else
+	bool benchmark = false;
+	bool headlessReplay = false;
+#endif
+
+	auto startupBegin = std::chrono::steady_clock::now();
+
+	// Captures from startup to exit, the rings only hold about the last minute, so a spike is best written with the hotkey as it happens
+	// The trace is written when the application closes as well
+	bool profile = std::wstring_view(GetCommandLineW()).contains(L"--profile");
+	if(profile) {
+		profiler::setThreadName("Main");
+		profiler::beginCapture();
+	}
 
-	std::thread app(applicationLoop);
+	// The device has to exist before anything can be uploaded, after that the assets load while the surfaces are created
+	{
+		PROFILE_ZONE("Startup");
+		AssetLoader loader(startupBegin);
+		GraphicsContext::initialize(loader);
+		loader.load("Sprite atlas", SpriteAtlas::load);
+		loader.load("State machines", StateMachineLibrary::load);
+		if(!headlessReplay) SurfaceManager::initialize(hInstance);
+
+		loader.waitAll();
+		logger::log("Startup: {:.2f} ms", loader.getElapsedMilliseconds());
+		loader.logTimings();
+	}
+
+	// Sprites on pages that are still loading show up as a question mark until their page is there
+	SpriteAtlas::setFallbackSprite(fonts::Small.getGlyph('?').sprite);
+	// A small budget, given in MiB, makes the pages get evicted and loaded again while playing
+	if(size_t budget = std::wstring_view(GetCommandLineW()).find(L"--atlas-budget="); budget != std::wstring_view::npos)
+		SpriteAtlas::setMemoryBudget(size_t(std::wcstoull(GetCommandLineW() + budget + 15, nullptr, 10)) * 1024 * 1024);
+
+#ifndef SHIPPING
+	if(headlessReplay) {
+		runHeadlessReplay();
+		if(profile) {
+			profiler::endCapture();
+			exportProfile(TracePath);
+		}
+		SpriteAtlas::destroy();
+		GraphicsContext::close();
+		return 0;
+	}
+
+	std::thread app = benchmark ? std::thread(runBenchmarks, GetCurrentThreadId()) : std::thread(applicationLoop, startupBegin);
+#else
+	std::thread app(applicationLoop, startupBegin);
+#endif
+
+	if(profile && !RegisterHotKey(nullptr, ExportTraceHotKey, MOD_CONTROL | MOD_ALT | MOD_NOREPEAT, 'P'))
+		logger::error("Could not register the hotkey that writes the profile");
 
 	MSG msg = {};
+	unsigned traceExports = 0;
 	while(GetMessage(&msg, nullptr, 0, 0)) {
+		// Hotkeys without a window are posted to the thread, so they never reach a window procedure
+		if(msg.message == WM_HOTKEY && msg.wParam == WPARAM(ExportTraceHotKey)) {
+			exportProfile(std::format("trace_{}.json", ++traceExports));
+			continue;
+		}
 		TranslateMessage(&msg);
 		DispatchMessage(&msg);
 	}
 
 	s_closeRequested = true;
+	SurfaceManager::getInstance().getFrameScheduler().wake();
 	app.join();
+	if(profile) {
+		UnregisterHotKey(nullptr, ExportTraceHotKey);
+		profiler::endCapture();
+		exportProfile(TracePath);
+	}
 
 	SpriteAtlas::destroy();
 	GraphicsContext::close();
@@ -5,9 +5,13 @@
 struct BoundingBox {
 	glm::vec2 min;
 	glm::vec2 max;
+
+	bool operator==(const BoundingBox&) const = default;
 };
 
 struct IntBoundingBox {
 	glm::ivec2 min;
 	glm::ivec2 max;
+
+	bool operator==(const IntBoundingBox&) const = default;
 };
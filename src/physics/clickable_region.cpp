@@ -0,0 +1,24 @@
+#include "clickable_region.hpp"
+
+#include <algorithm>
+
+void ClickableRegion::add(std::span<const IntBoundingBox> rects, glm::ivec2 offset) {
+	for(const IntBoundingBox& rect : rects) m_rects.push_back({ .min = rect.min + offset, .max = rect.max + offset });
+}
+
+bool ClickableRegion::update() {
+	++m_stats.frames;
+	if(m_rects != m_previousRects) {
+		m_region.build(m_rects);
+		m_previousRects.swap(m_rects);
+		++m_stats.merges;
+	}
+	m_rects.clear();
+
+	return !std::ranges::equal(m_region.getRects(), m_submitted);
+}
+
+void ClickableRegion::markSubmitted() {
+	m_submitted.assign(m_region.getRects().begin(), m_region.getRects().end());
+	++m_stats.submissions;
+}
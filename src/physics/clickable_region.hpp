@@ -0,0 +1,38 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "bounding_box.hpp"
+#include "math.hpp"
+#include "rect_region.hpp"
+
+// Collects the clickable rects of all entities during a frame and keeps track of the region the click window was given last
+// Merging is skipped when the same rects were added as in the last frame, and a region is only handed out when the merged result changed
+class ClickableRegion {
+public:
+	struct Stats {
+		size_t frames = 0;
+		size_t merges = 0;
+		size_t submissions = 0;
+	};
+
+public:
+	void add(const IntBoundingBox& rect) { m_rects.push_back(rect); }
+	void add(std::span<const IntBoundingBox> rects, glm::ivec2 offset = glm::ivec2(0));
+
+	// Ends the frame, returns whether the merged region differs from the one that was submitted last
+	[[nodiscard]] bool update();
+	// Has to be called once the region was handed to the window
+	void markSubmitted();
+
+	[[nodiscard]] std::span<const IntBoundingBox> getRects() const { return m_region.getRects(); }
+	[[nodiscard]] const Stats& getStats() const { return m_stats; }
+
+private:
+	std::vector<IntBoundingBox> m_rects;
+	std::vector<IntBoundingBox> m_previousRects;
+	RectRegion m_region;
+	std::vector<IntBoundingBox> m_submitted;
+	Stats m_stats;
+};
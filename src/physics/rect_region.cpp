@@ -0,0 +1,51 @@
+#include "rect_region.hpp"
+
+#include <algorithm>
+
+void RectRegion::build(std::span<const IntBoundingBox> rects) {
+	m_rects.clear();
+	m_sorted.clear();
+	m_edges.clear();
+	for(const IntBoundingBox& rect : rects) {
+		if(rect.min.x >= rect.max.x || rect.min.y >= rect.max.y) continue;
+		m_sorted.push_back(rect);
+		m_edges.push_back(rect.min.y);
+		m_edges.push_back(rect.max.y);
+	}
+
+	std::ranges::sort(m_sorted, {}, [](const IntBoundingBox& rect) { return rect.min.y; });
+	std::ranges::sort(m_edges);
+	m_edges.erase(std::ranges::unique(m_edges).begin(), m_edges.end());
+
+	// Sweeps down through the bands between the edges, keeping track of the rects that cover the current band
+	m_active.clear();
+	m_previousSpans.clear();
+	size_t next = 0;
+	size_t bandStart = 0;
+	for(size_t i = 0; i + 1 < m_edges.size(); ++i) {
+		int top = m_edges[i];
+		int bottom = m_edges[i + 1];
+		std::erase_if(m_active, [&](const IntBoundingBox& rect) { return rect.max.y <= top; });
+		while(next < m_sorted.size() && m_sorted[next].min.y <= top) m_active.push_back(m_sorted[next++]);
+
+		// Overlapping and touching rects become one span
+		std::ranges::sort(m_active, {}, [](const IntBoundingBox& rect) { return rect.min.x; });
+		m_spans.clear();
+		for(const IntBoundingBox& rect : m_active) {
+			if(!m_spans.empty() && rect.min.x <= m_spans.back().end) {
+				m_spans.back().end = std::max(m_spans.back().end, rect.max.x);
+			} else {
+				m_spans.push_back({ .begin = rect.min.x, .end = rect.max.x });
+			}
+		}
+
+		// Bands are next to each other, so a band with the same spans as the one above only makes the rects of that band taller
+		if(!m_spans.empty() && m_spans == m_previousSpans) {
+			for(IntBoundingBox& rect : std::span(m_rects).subspan(bandStart)) rect.max.y = bottom;
+		} else {
+			bandStart = m_rects.size();
+			for(const Span& span : m_spans) m_rects.push_back({ .min = glm::ivec2(span.begin, top), .max = glm::ivec2(span.end, bottom) });
+		}
+		m_previousSpans.swap(m_spans);
+	}
+}
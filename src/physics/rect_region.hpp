@@ -0,0 +1,37 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "bounding_box.hpp"
+#include "math.hpp"
+
+// Union of rects as a set of rects that do not overlap, without any platform code so it can be used for the click window region
+// The union is split into horizontal bands with sorted spans, neighbouring bands with the same spans are merged into one
+// Two regions covering the same pixels always end up with the same rects, so comparing the rects compares the regions
+class RectRegion {
+public:
+	// Replaces the region with the union of the rects, empty rects are ignored
+	void build(std::span<const IntBoundingBox> rects);
+
+	[[nodiscard]] std::span<const IntBoundingBox> getRects() const { return m_rects; }
+	[[nodiscard]] bool operator==(const RectRegion& other) const { return m_rects == other.m_rects; }
+
+private:
+	struct Span {
+		int begin;
+		int end;
+
+		bool operator==(const Span&) const = default;
+	};
+
+private:
+	std::vector<IntBoundingBox> m_rects;
+
+	// Only kept so building a region does not allocate once they have grown
+	std::vector<int> m_edges;
+	std::vector<IntBoundingBox> m_sorted;
+	std::vector<IntBoundingBox> m_active;
+	std::vector<Span> m_spans;
+	std::vector<Span> m_previousSpans;
+};
@@ -3,11 +3,16 @@
 #include <algorithm>
 
 #include "platform.hpp"
+#include "profiler.hpp"
 #include "rendering/graphics_context.hpp"
 #include "rendering/surface_manager.hpp"
 
-void WindowPhysics::update() {
+bool WindowPhysics::update() {
+	PROFILE_ZONE("WindowPhysics::update");
+
 	// todo: dont do this every frame
+	std::swap(m_hitboxes, m_previousHitboxes);
+	std::swap(m_taskBar, m_previousTaskBar);
 	m_hitboxes.clear();
 	m_taskBar.clear();
 
@@ -31,9 +36,21 @@ void WindowPhysics::update() {
 			m_hitboxes.emplace_back(BoundingBox{ .min = glm::vec2(rect.left, rect.top), .max = glm::vec2(rect.right, rect.bottom) }, IsZoomed(hwnd));
 	}
 
+	drawDebug();
+	return m_hitboxes != m_previousHitboxes || m_taskBar != m_previousTaskBar;
+}
+
+void WindowPhysics::setLayout(std::span<const Window> windows, std::span<const BoundingBox> taskBar) {
+	m_hitboxes.assign(windows.begin(), windows.end());
+	m_taskBar.assign(taskBar.begin(), taskBar.end());
+	drawDebug();
+}
+
+void WindowPhysics::drawDebug() const {
 #ifdef _DEBUG
 	for(const auto& box : m_hitboxes) GraphicsContext::getInstance().getDebugRenderer().box(box.bbox, glm::vec4(0.0f, 1.0f, 0.0f, 0.3f));
 	for(const auto& box : m_taskBar) GraphicsContext::getInstance().getDebugRenderer().box(box, glm::vec4(0.0f, 0.5f, 1.0f, 0.3f));
+	if(!SurfaceManager::isInitialized()) return;
 
 	BoundingBox screen = SurfaceManager::getInstance().getVirtualScreenBounds();
 	glm::vec2 s = screen.max - screen.min;
@@ -83,14 +100,15 @@ void WindowPhysics::generateScreenBounds() {
 }
 
 bool WindowPhysics::overlaps(const BoundingBox& box) const {
-	return std::ranges::any_of(m_hitboxes, [&box](const PhysicsWindow& hitbox) { return ::overlaps(hitbox.bbox, box); });
+	return std::ranges::any_of(m_hitboxes, [&box](const Window& hitbox) { return ::overlaps(hitbox.bbox, box); });
 }
 
 bool WindowPhysics::overlaps(glm::vec2 pos) const {
-	return std::ranges::any_of(m_hitboxes, [pos](const PhysicsWindow& hitbox) { return ::overlaps(hitbox.bbox, pos); });
+	return std::ranges::any_of(m_hitboxes, [pos](const Window& hitbox) { return ::overlaps(hitbox.bbox, pos); });
 }
 
 Intersection WindowPhysics::rayCast(glm::vec2 origin, glm::vec2 direction, float maxDistance) const {
+	PROFILE_ZONE("WindowPhysics::rayCast");
 	Intersection miss{ .distance = maxDistance, .normal = glm::vec2(0.0f) };
 	Intersection hit{ .distance = maxDistance, .normal = glm::vec2(0.0f) };
 	float d = 0.0f;
@@ -127,6 +145,7 @@ Intersection WindowPhysics::rayCast(glm::vec2 origin, glm::vec2 direction, float
 }
 
 Intersection WindowPhysics::boxCast(BoundingBox origin, glm::vec2 direction, float maxDistance) const {
+	PROFILE_ZONE("WindowPhysics::boxCast");
 	Intersection miss{ .distance = maxDistance, .normal = glm::vec2(0.0f) };
 	Intersection hit{ .distance = maxDistance, .normal = glm::vec2(0.0f) };
 	float d = 0.0f;
@@ -1,15 +1,34 @@
 #pragma once
 
+#include <span>
 #include <vector>
 
 #include "bounding_box.hpp"
 #include "intersection.hpp"
 #include "math.hpp"
 
+// The desktop windows the pets collide with, either read from the desktop every frame or set from a replay
 class WindowPhysics {
 public:
-	void update();
+	struct Window {
+		BoundingBox bbox;
+		// Maximized windows can be walked out of but not into
+		bool ignore;
+
+		bool operator==(const Window&) const = default;
+	};
+
+public:
+	// Reads the windows of the desktop, returns whether the layout changed since the last frame
+	bool update();
 	void generateScreenBounds();
+	// Replaces the layout without looking at the desktop
+	void setLayout(std::span<const Window> windows, std::span<const BoundingBox> taskBar);
+	void setScreenEdges(std::span<const BoundingBox> screenEdges) { m_screenEdges.assign(screenEdges.begin(), screenEdges.end()); }
+
+	[[nodiscard]] std::span<const Window> getWindows() const { return m_hitboxes; }
+	[[nodiscard]] std::span<const BoundingBox> getTaskBar() const { return m_taskBar; }
+	[[nodiscard]] std::span<const BoundingBox> getScreenEdges() const { return m_screenEdges; }
 
 	[[nodiscard]] bool overlaps(const BoundingBox& box) const;
 	[[nodiscard]] bool overlaps(glm::vec2 pos) const;
@@ -17,13 +36,13 @@ public:
 	[[nodiscard]] Intersection boxCast(BoundingBox origin, glm::vec2 direction, float maxDistance = 1e32f) const;
 
 private:
-	struct PhysicsWindow {
-		BoundingBox bbox;
-		bool ignore;
-	};
+	void drawDebug() const;
 
 private:
-	std::vector<PhysicsWindow> m_hitboxes;
+	std::vector<Window> m_hitboxes;
 	std::vector<BoundingBox> m_screenEdges;
 	std::vector<BoundingBox> m_taskBar;
+	// The layout of the last frame while the next one is read
+	std::vector<Window> m_previousHitboxes;
+	std::vector<BoundingBox> m_previousTaskBar;
 };
@@ -16,8 +16,9 @@
 template<typename T>
 using ComPtr = Microsoft::WRL::ComPtr<T>;
 
-inline void fatalError(const char* message) {
+[[noreturn]] inline void fatalError(const char* message) {
 	logger::error("{}", message);
+	logger::flush();
 	std::wstring wmessage = std::wstring(message, message + strlen(message));
 	MessageBox(nullptr, wmessage.c_str(), L"Fatal Error", MB_OK | MB_ICONERROR);
 	__debugbreak();
@@ -0,0 +1,188 @@
+#include "profiler.hpp"
+
+#if PROFILER_ENABLED
+	#include <algorithm>
+	#include <array>
+	#include <chrono>
+	#include <fstream>
+	#include <memory>
+	#include <mutex>
+	#include <string>
+	#include <vector>
+
+	#include <nlohmann/json.hpp>
+
+namespace {
+	// Has to be a power of two, the main thread fills it in about a minute
+	constexpr size_t ZoneCapacity = size_t(64) * 1024;
+
+	// The fields are atomic so the exporter can read zones while their thread overwrites them, relaxed accesses cost nothing over plain ones
+	struct ZoneRecord {
+		std::atomic<const char*> name = nullptr;
+		std::atomic_int64_t begin = 0;
+		std::atomic_int64_t end = 0;
+		std::atomic_uint32_t depth = 0;
+	};
+
+	// Zones of one thread, written by that thread and read by the exporter
+	// The count only grows, it is masked to index the zones
+	struct ThreadBuffer {
+		alignas(64) std::atomic_uint64_t count = 0;
+		// Only used under the registry mutex
+		std::string name;
+		uint32_t id = 0;
+
+		alignas(64) std::array<ZoneRecord, ZoneCapacity> zones;
+	};
+
+	struct ExportedZone {
+		const char* name;
+		int64_t begin;
+		int64_t end;
+		uint32_t depth;
+	};
+
+	// Zones that started before the capture are left out of the export
+	std::atomic_int64_t s_captureBegin = 0;
+
+	int64_t now() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	class Registry {
+	public:
+		// Buffers stay around until the process exits, so the zones of threads that are gone can still be exported
+		ThreadBuffer& addThread() {
+			std::lock_guard lock(m_mutex);
+			ThreadBuffer& buffer = *m_buffers.emplace_back(std::make_unique<ThreadBuffer>());
+			buffer.id = uint32_t(m_buffers.size());
+			return buffer;
+		}
+
+		void setName(ThreadBuffer& buffer, const char* name) {
+			std::lock_guard lock(m_mutex);
+			buffer.name = name;
+		}
+
+		bool exportTrace(const std::filesystem::path& path) {
+			int64_t captureBegin = s_captureBegin.load(std::memory_order_relaxed);
+			nlohmann::json events = nlohmann::json::array();
+			std::vector<ExportedZone> zones;
+
+			std::lock_guard lock(m_mutex);
+			for(const auto& buffer : m_buffers) {
+				if(!buffer->name.empty()) {
+					nlohmann::json& entry = events.emplace_back();
+					entry["name"] = "thread_name";
+					entry["ph"] = "M";
+					entry["pid"] = 1;
+					entry["tid"] = buffer->id;
+					entry["args"]["name"] = buffer->name;
+				}
+
+				copyZones(*buffer, captureBegin, zones);
+				// Parents come before the zones they contain, the viewer nests zones that start at the same time by their order
+				std::ranges::sort(zones, [](const ExportedZone& a, const ExportedZone& b) {
+					return a.begin != b.begin ? a.begin < b.begin : a.depth < b.depth;
+				});
+
+				for(const ExportedZone& zone : zones) {
+					nlohmann::json& entry = events.emplace_back();
+					entry["name"] = zone.name;
+					entry["ph"] = "X";
+					// The format counts in microseconds, fractions keep the nanoseconds
+					entry["ts"] = double(zone.begin - captureBegin) / 1000.0;
+					entry["dur"] = double(zone.end - zone.begin) / 1000.0;
+					entry["pid"] = 1;
+					entry["tid"] = buffer->id;
+					entry["args"]["depth"] = zone.depth;
+				}
+			}
+
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			if(!file) return false;
+			nlohmann::json json;
+			json["traceEvents"] = std::move(events);
+			json["displayTimeUnit"] = "ns";
+			file << json.dump();
+			return bool(file);
+		}
+
+	private:
+		// Takes the zones that are still in the buffer, zones the thread may have overwritten while they were copied are thrown away
+		static void copyZones(const ThreadBuffer& buffer, int64_t captureBegin, std::vector<ExportedZone>& zones) {
+			zones.clear();
+			uint64_t count = buffer.count.load(std::memory_order_acquire);
+			uint64_t first = count > ZoneCapacity ? count - ZoneCapacity : 0;
+			for(uint64_t i = first; i < count; ++i) {
+				const ZoneRecord& record = buffer.zones[i & (ZoneCapacity - 1)];
+				zones.push_back({
+				    .name = record.name.load(std::memory_order_relaxed),
+				    .begin = record.begin.load(std::memory_order_relaxed),
+				    .end = record.end.load(std::memory_order_relaxed),
+				    .depth = record.depth.load(std::memory_order_relaxed),
+				});
+			}
+
+			// A zone is overwritten once the count passed it by the capacity, the one at the count may be half written
+			std::atomic_thread_fence(std::memory_order_acquire);
+			uint64_t after = buffer.count.load(std::memory_order_relaxed);
+			size_t overwritten = after + 1 > first + ZoneCapacity ? size_t(std::min(after + 1 - ZoneCapacity - first, count - first)) : 0;
+			zones.erase(zones.begin(), zones.begin() + std::ptrdiff_t(overwritten));
+			std::erase_if(zones, [captureBegin](const ExportedZone& zone) { return zone.begin < captureBegin; });
+		}
+
+	private:
+		std::mutex m_mutex;
+		std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+	};
+
+	Registry& getRegistry() {
+		static Registry registry;
+		return registry;
+	}
+
+	thread_local ThreadBuffer* t_buffer = nullptr;
+	thread_local uint32_t t_depth = 0;
+} // namespace
+
+int64_t profiler::detail::begin() {
+	++t_depth;
+	return now();
+}
+
+void profiler::detail::end(const char* name, int64_t begin) {
+	int64_t end = now();
+	uint32_t depth = --t_depth;
+	if(!t_buffer) t_buffer = &getRegistry().addThread();
+	ThreadBuffer& buffer = *t_buffer;
+
+	// Orders the count the exporter may still see before the stores that overwrite the oldest zone
+	uint64_t count = buffer.count.load(std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	ZoneRecord& record = buffer.zones[count & (ZoneCapacity - 1)];
+	record.name.store(name, std::memory_order_relaxed);
+	record.begin.store(begin, std::memory_order_relaxed);
+	record.end.store(end, std::memory_order_relaxed);
+	record.depth.store(depth, std::memory_order_relaxed);
+	buffer.count.store(count + 1, std::memory_order_release);
+}
+
+void profiler::beginCapture() {
+	s_captureBegin.store(now(), std::memory_order_relaxed);
+	detail::s_capturing.store(true, std::memory_order_relaxed);
+}
+
+void profiler::endCapture() {
+	detail::s_capturing.store(false, std::memory_order_relaxed);
+}
+
+void profiler::setThreadName(const char* name) {
+	if(!t_buffer) t_buffer = &getRegistry().addThread();
+	getRegistry().setName(*t_buffer, name);
+}
+
+bool profiler::exportTrace(const std::filesystem::path& path) {
+	return getRegistry().exportTrace(path);
+}
+#endif
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+
+// Zones are compiled out of shipping builds, elsewhere they only record while a capture is running
+#ifndef PROFILER_ENABLED
+	#ifdef SHIPPING
+		#define PROFILER_ENABLED 0
+	#else
+		#define PROFILER_ENABLED 1
+	#endif
+#endif
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if PROFILER_ENABLED
+	// Times the rest of the enclosing scope, the name has to outlive the capture, so it should be a string literal
+	#define PROFILE_ZONE(name) const profiler::Zone PROFILE_CONCAT(profileZone, __LINE__)(name)
+	#define PROFILE_FUNCTION() PROFILE_ZONE(__func__)
+#else
+	#define PROFILE_ZONE(name) ((void)0)
+	#define PROFILE_FUNCTION() ((void)0)
+#endif
+
+// Every thread records its zones into a ring of its own, so a capture always holds the last few thousand zones of every thread
+// Nothing is formatted until the capture is exported, to the trace event format that chrome://tracing and Perfetto open
+namespace profiler {
+	// NOLINTBEGIN
+#if PROFILER_ENABLED
+	namespace detail {
+		inline std::atomic_bool s_capturing = false;
+
+		// Returns the start of the zone and moves the thread one level deeper
+		int64_t begin();
+		void end(const char* name, int64_t begin);
+	} // namespace detail
+
+	class Zone {
+	public:
+		explicit Zone(const char* name) : m_name(detail::s_capturing.load(std::memory_order_relaxed) ? name : nullptr) {
+			if(m_name) m_begin = detail::begin();
+		}
+		Zone(const Zone&) = delete;
+		Zone& operator=(const Zone&) = delete;
+		Zone(Zone&&) = delete;
+		Zone& operator=(Zone&&) = delete;
+		~Zone() {
+			if(m_name) detail::end(m_name, m_begin);
+		}
+
+	private:
+		// Null when no capture was running as the zone started
+		const char* m_name;
+		int64_t m_begin = 0;
+	};
+
+	// Starts recording zones, the zones recorded by an earlier capture are thrown away
+	void beginCapture();
+	void endCapture();
+	[[nodiscard]] inline bool isCapturing() { return detail::s_capturing.load(std::memory_order_relaxed); }
+
+	// Shows up as the name of the thread in the trace, the calling thread is registered if it was not already
+	void setThreadName(const char* name);
+	// Writes the zones that are still in the rings, can be called while the capture is running
+	bool exportTrace(const std::filesystem::path& path);
+#else
+	inline void beginCapture() {}
+	inline void endCapture() {}
+	[[nodiscard]] inline bool isCapturing() { return false; }
+
+	inline void setThreadName([[maybe_unused]] const char* name) {}
+	inline bool exportTrace([[maybe_unused]] const std::filesystem::path& path) { return false; }
+#endif
+	// NOLINTEND
+} // namespace profiler
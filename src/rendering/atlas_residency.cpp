@@ -0,0 +1,124 @@
+#include "atlas_residency.hpp"
+
+#include <algorithm>
+
+AtlasResidency::AtlasResidency(std::vector<size_t> pageBytes, size_t budget) : m_budget(budget) {
+	m_pages.reserve(pageBytes.size());
+	for(size_t bytes : pageBytes) m_pages.push_back({ .bytes = bytes });
+}
+
+bool AtlasResidency::use(unsigned page) {
+	Page& entry = m_pages[page];
+	entry.lastUsed = m_frame;
+	if(entry.state == PageState::Resident) return true;
+
+	++m_stats.misses;
+	if(entry.state == PageState::Unloaded) {
+		entry.state = PageState::Requested;
+		m_requests.push_back(page);
+	}
+	return false;
+}
+
+void AtlasResidency::pin(unsigned page) {
+	Page& entry = m_pages[page];
+	entry.pinned = true;
+	entry.lastUsed = m_frame;
+	if(entry.state == PageState::Unloaded) {
+		entry.state = PageState::Requested;
+		m_requests.push_back(page);
+	}
+}
+
+std::span<const SpriteDrawable> AtlasResidency::resolve(
+    std::span<const SpriteDrawable> drawables,
+    std::span<const Sprite> sprites,
+    std::optional<uint16_t> fallback,
+    std::vector<SpriteDrawable>& scratch
+) {
+	bool resident = true;
+	for(const SpriteDrawable& drawable : drawables)
+		if(drawable.sprite < sprites.size()) resident = use(sprites[drawable.sprite].getPage()) && resident;
+	if(resident) return drawables;
+
+	bool fallbackResident = fallback && getState(sprites[*fallback].getPage()) == PageState::Resident;
+	scratch.clear();
+	for(const SpriteDrawable& drawable : drawables) {
+		if(drawable.sprite >= sprites.size()) continue;
+
+		if(getState(sprites[drawable.sprite].getPage()) == PageState::Resident) {
+			scratch.push_back(drawable);
+		} else if(fallbackResident) {
+			scratch.push_back(drawable);
+			scratch.back().sprite = *fallback;
+		}
+	}
+	return scratch;
+}
+
+void AtlasResidency::endFrame(std::vector<unsigned>& loads, std::vector<unsigned>& evictions) {
+	loads.clear();
+	evictions.clear();
+	m_waiting.clear();
+
+	// Pinned pages go first, they are loaded even when that means going over budget
+	std::ranges::stable_partition(m_requests, [this](unsigned page) { return m_pages[page].pinned; });
+
+	for(unsigned page : m_requests) {
+		Page& entry = m_pages[page];
+
+		// Nothing needs the page anymore, so it does not hold up the queue until there is room for it
+		if(!entry.pinned && entry.lastUsed != m_frame) {
+			entry.state = PageState::Unloaded;
+			continue;
+		}
+
+		// A page larger than the whole budget gets loaded once everything else could be evicted
+		size_t target = m_budget - std::min(entry.bytes, m_budget);
+		if(!entry.pinned && m_committedBytes - getEvictableBytes() > target) {
+			m_waiting.push_back(page);
+			continue;
+		}
+
+		evictLeastRecentlyUsed(target, evictions);
+		entry.state = PageState::Loading;
+		m_committedBytes += entry.bytes;
+		loads.push_back(page);
+		++m_stats.loads;
+	}
+	m_requests.swap(m_waiting);
+
+	// The budget can shrink at any time, so this also runs when nothing was requested
+	evictLeastRecentlyUsed(m_budget, evictions);
+	++m_frame;
+}
+
+void AtlasResidency::finishLoad(unsigned page) {
+	Page& entry = m_pages[page];
+	if(entry.state == PageState::Loading) entry.state = PageState::Resident;
+}
+
+bool AtlasResidency::isEvictable(const Page& entry) const {
+	return entry.state == PageState::Resident && !entry.pinned && entry.lastUsed != m_frame;
+}
+
+size_t AtlasResidency::getEvictableBytes() const {
+	size_t bytes = 0;
+	for(const Page& entry : m_pages)
+		if(isEvictable(entry)) bytes += entry.bytes;
+	return bytes;
+}
+
+void AtlasResidency::evictLeastRecentlyUsed(size_t target, std::vector<unsigned>& evictions) {
+	while(m_committedBytes > target) {
+		Page* oldest = nullptr;
+		for(Page& entry : m_pages)
+			if(isEvictable(entry) && (!oldest || entry.lastUsed < oldest->lastUsed)) oldest = &entry;
+		if(!oldest) return;
+
+		oldest->state = PageState::Unloaded;
+		m_committedBytes -= oldest->bytes;
+		evictions.push_back(unsigned(oldest - m_pages.data()));
+		++m_stats.evictions;
+	}
+}
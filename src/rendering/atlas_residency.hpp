@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "sprite.hpp"
+#include "sprite_drawable.hpp"
+
+// Decides which atlas pages are on the GPU, pages are requested when a sprite on them is drawn and loaded in the background
+// When the pages would exceed the memory budget, the least recently used ones are evicted, pages used in the current frame stay
+// This is only the bookkeeping, the owner does the actual loading and releasing, so it works without a device
+class AtlasResidency {
+public:
+	enum class PageState : uint8_t {
+		Unloaded,
+		Requested,
+		Loading,
+		Resident,
+	};
+
+	struct Stats {
+		size_t loads = 0;
+		size_t evictions = 0;
+		// Draws of a sprite whose page was not resident yet
+		size_t misses = 0;
+	};
+
+public:
+	AtlasResidency(std::vector<size_t> pageBytes, size_t budget);
+
+	// Marks the page as used this frame and returns whether it can be drawn, pages that are not loaded are requested
+	bool use(unsigned page);
+	// Pinned pages are requested right away and never evicted
+	void pin(unsigned page);
+	// Marks the pages of the sprites as used, sprites on pages that are not resident are swapped for the fallback sprite
+	// Without a resident fallback they are left out, returns the drawables unchanged when everything is resident
+	[[nodiscard]] std::span<const SpriteDrawable> resolve(
+	    std::span<const SpriteDrawable> drawables,
+	    std::span<const Sprite> sprites,
+	    std::optional<uint16_t> fallback,
+	    std::vector<SpriteDrawable>& scratch
+	);
+	// Ends the frame, returns the pages to start loading and the pages to release so the budget is kept
+	// A page that does not fit into the budget stays requested while it keeps being used, once it is not it goes back to unloaded
+	void endFrame(std::vector<unsigned>& loads, std::vector<unsigned>& evictions);
+	void finishLoad(unsigned page);
+
+	void setBudget(size_t budget) { m_budget = budget; }
+	[[nodiscard]] size_t getBudget() const { return m_budget; }
+	// Memory of the pages that are resident or being loaded
+	[[nodiscard]] size_t getCommittedBytes() const { return m_committedBytes; }
+	[[nodiscard]] PageState getState(unsigned page) const { return m_pages[page].state; }
+	[[nodiscard]] size_t getPageCount() const { return m_pages.size(); }
+	[[nodiscard]] const Stats& getStats() const { return m_stats; }
+
+private:
+	struct Page {
+		size_t bytes;
+		uint64_t lastUsed = 0;
+		PageState state = PageState::Unloaded;
+		bool pinned = false;
+	};
+
+private:
+	[[nodiscard]] bool isEvictable(const Page& entry) const;
+	[[nodiscard]] size_t getEvictableBytes() const;
+	// Evicts pages that were not used this frame until the committed memory is down to the target or nothing is left to evict
+	void evictLeastRecentlyUsed(size_t target, std::vector<unsigned>& evictions);
+
+private:
+	std::vector<Page> m_pages;
+	std::vector<unsigned> m_requests;
+	std::vector<unsigned> m_waiting;
+	size_t m_budget;
+	size_t m_committedBytes = 0;
+	// Starts at one so that no page counts as used in the current frame before it was used
+	uint64_t m_frame = 1;
+	Stats m_stats;
+};
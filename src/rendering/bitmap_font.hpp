@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include "sprite_atlas.hpp"
+
+// Glyph metrics of a bitmap font, baked at compile time from the glyph sprites in the atlas
+// The glyphs of a font are sprites named <font>_<character code>.png, characters without a sprite are drawn as '?'
+class BitmapFont {
+public:
+	constexpr static unsigned FirstChar = 32;
+	constexpr static unsigned LastChar = 126;
+
+	struct Glyph {
+		SpriteId sprite = 0;
+		uint8_t width = 0;
+		uint8_t height = 0;
+		uint8_t advance = 0;
+		bool visible = false;
+	};
+
+public:
+	// Spacing is added to the width of every glyph to get its advance, it is negative for fonts with outlines that may overlap
+	consteval BitmapFont(std::string_view name, int spacing, unsigned spaceAdvance, unsigned lineHeight) : m_lineHeight(lineHeight) {
+		for(unsigned c = FirstChar; c <= LastChar; ++c) {
+			Glyph& glyph = m_glyphs[c - FirstChar];
+			if(c == ' ') {
+				glyph.advance = uint8_t(spaceAdvance);
+				continue;
+			}
+
+			// The atlas fails to compile when the font is missing the fallback glyph
+			std::optional<SpriteId> sprite = SpriteAtlas::find(getGlyphName(name, c).view());
+			if(!sprite) sprite = SpriteAtlas::find(getGlyphName(name, '?').view()).value();
+
+			const Sprite& glyphSprite = SpriteAtlas::getSprite(*sprite);
+			glyph.sprite = *sprite;
+			glyph.width = uint8_t(glyphSprite.getWidth());
+			glyph.height = uint8_t(glyphSprite.getHeight());
+			glyph.advance = uint8_t(int(glyphSprite.getWidth()) + spacing);
+			glyph.visible = true;
+		}
+	}
+
+	[[nodiscard]] constexpr const Glyph& getGlyph(char c) const {
+		unsigned code = uint8_t(c);
+		return m_glyphs[(code >= FirstChar && code <= LastChar ? code : '?') - FirstChar];
+	}
+	[[nodiscard]] constexpr unsigned getLineHeight() const { return m_lineHeight; }
+
+private:
+	struct GlyphName {
+		std::array<char, 64> chars = {};
+		size_t size = 0;
+
+		[[nodiscard]] constexpr std::string_view view() const { return std::string_view(chars.data(), size); }
+	};
+
+	static consteval GlyphName getGlyphName(std::string_view font, unsigned code) {
+		GlyphName name;
+		auto append = [&](std::string_view str) {
+			for(char c : str) name.chars[name.size++] = c;
+		};
+
+		append(font);
+		append("_");
+		if(code >= 100) name.chars[name.size++] = char('0' + code / 100);
+		if(code >= 10) name.chars[name.size++] = char('0' + code / 10 % 10);
+		name.chars[name.size++] = char('0' + code % 10);
+		append(".png");
+		return name;
+	}
+
+private:
+	std::array<Glyph, LastChar - FirstChar + 1> m_glyphs = {};
+	unsigned m_lineHeight;
+};
+
+namespace fonts {
+	// White with a dark outline, readable on any desktop background
+	constexpr BitmapFont Small = BitmapFont("font_small", -1, 4, 10);
+} // namespace fonts
@@ -2,87 +2,169 @@
 
 #ifdef _DEBUG
 
+	#include <algorithm>
+	#include <cmath>
+	#include <span>
+
 	#include "graphics_context.hpp"
 
 DebugRenderer::DebugRenderer() {
-	constexpr char lineVertexSource[] = {
-	#embed "embed/line_vs.cso"
+	constexpr char debugVertexSource[] = {
+	#embed "embed/debug_vs.cso"
 	};
-	constexpr char linePixelSource[] = {
-	#embed "embed/line_ps.cso"
+	constexpr char debugPixelSource[] = {
+	#embed "embed/debug_ps.cso"
 	};
 
 	constexpr D3D11_INPUT_ELEMENT_DESC layout[] = {
-		{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT,    0, 0,  D3D11_INPUT_PER_VERTEX_DATA, 0 },
-		{ "COLOR",    0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "POSITION",    0, DXGI_FORMAT_R32G32_FLOAT,       0, 0,  D3D11_INPUT_PER_VERTEX_DATA,   0 },
+
+		{ "BASIS",       0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0,  D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+		{ "TRANSLATION", 0, DXGI_FORMAT_R32G32_FLOAT,       1, 16, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+		{ "COLOR",       0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 24, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
 	};
+	static_assert(sizeof(Instance) == 40);
 
 	auto* device = GraphicsContext::getInstance().getDevice();
 
 	handleFatalError(
-	    device->CreateInputLayout(layout, sizeof(layout) / sizeof(*layout), lineVertexSource, sizeof(lineVertexSource), &m_lineInputLayout),
+	    device->CreateInputLayout(layout, sizeof(layout) / sizeof(*layout), debugVertexSource, sizeof(debugVertexSource), &m_inputLayout),
 	    "Can not load debug vertex layout"
 	);
 	handleFatalError(
-	    device->CreateVertexShader(lineVertexSource, sizeof(lineVertexSource), nullptr, &m_lineVertexShader), "Can not load debug vertex shader"
+	    device->CreateVertexShader(debugVertexSource, sizeof(debugVertexSource), nullptr, &m_vertexShader), "Can not load debug vertex shader"
 	);
 	handleFatalError(
-	    device->CreatePixelShader(linePixelSource, sizeof(linePixelSource), nullptr, &m_linePixelShader), "Can not load debug pixel shader"
+	    device->CreatePixelShader(debugPixelSource, sizeof(debugPixelSource), nullptr, &m_pixelShader), "Can not load debug pixel shader"
 	);
 
+	// All unit shapes share one vertex buffer, the filled rect is a triangle list and everything else a line list
+	std::vector<glm::vec2> vertices;
+	auto addShape = [&](Shape shape, std::span<const glm::vec2> shapeVertices) {
+		m_shapeRanges[shape] = { .firstVertex = UINT(vertices.size()), .vertexCount = UINT(shapeVertices.size()) };
+		vertices.append_range(shapeVertices);
+	};
+
+	constexpr glm::vec2 unitRect[] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
+	constexpr glm::vec2 unitLine[] = { { 0.0f, 0.0f }, { 1.0f, 0.0f } };
+	constexpr glm::vec2 unitBox[] = {
+		{ 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f }, { 0.0f, 1.0f }, { 0.0f, 0.0f },
+	};
+
+	constexpr unsigned CircleSegments = 32;
+	std::array<glm::vec2, CircleSegments * 2> unitCircle;
+	for(unsigned i = 0; i < CircleSegments; ++i) {
+		float alpha = float(i) * glm::two_pi<float>() / float(CircleSegments);
+		float beta = float(i + 1) * glm::two_pi<float>() / float(CircleSegments);
+		unitCircle[i * 2] = glm::vec2(std::sin(alpha), std::cos(alpha));
+		unitCircle[i * 2 + 1] = glm::vec2(std::sin(beta), std::cos(beta));
+	}
+
+	addShape(Shape_FilledRect, unitRect);
+	addShape(Shape_Line, unitLine);
+	addShape(Shape_Box, unitBox);
+	addShape(Shape_Circle, unitCircle);
+
 	D3D11_BUFFER_DESC bufferDesc = {};
-	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	bufferDesc.ByteWidth = sizeof(DebugRenderer::Vertex) * MaxVertices;
+	bufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	bufferDesc.ByteWidth = UINT(sizeof(glm::vec2) * vertices.size());
 	bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	handleFatalError(device->CreateBuffer(&bufferDesc, nullptr, &m_lineBuffer), "Could not allocate debug line buffer");
+
+	D3D11_SUBRESOURCE_DATA bufferData = {};
+	bufferData.pSysMem = vertices.data();
+	handleFatalError(device->CreateBuffer(&bufferDesc, &bufferData, &m_shapeBuffer), "Could not allocate debug shape buffer");
+}
+
+void DebugRenderer::line(glm::vec2 a, glm::vec2 b, glm::vec4 color, float duration) {
+	add(Shape_Line, { .basis = glm::vec4(b - a, 0.0f, 0.0f), .translation = a, .color = color }, duration);
 }
 
-void DebugRenderer::line(glm::vec2 a, glm::vec2 b, glm::vec4 color) {
-	m_vertices.emplace_back(glm::vec3(a.x, a.y, 0.0f), color);
-	m_vertices.emplace_back(glm::vec3(b.x, b.y, 0.0f), color);
+void DebugRenderer::box(const BoundingBox& box, glm::vec4 color, float duration) {
+	glm::vec2 size = box.max - box.min;
+	add(Shape_Box, { .basis = glm::vec4(size.x, 0.0f, 0.0f, size.y), .translation = box.min, .color = color }, duration);
 }
 
-void DebugRenderer::box(const BoundingBox& box, glm::vec4 color) {
-	line(glm::vec2(box.min.x, box.min.y), glm::vec2(box.min.x, box.max.y), color);
-	line(glm::vec2(box.min.x, box.min.y), glm::vec2(box.max.x, box.min.y), color);
-	line(glm::vec2(box.max.x, box.min.y), glm::vec2(box.max.x, box.max.y), color);
-	line(glm::vec2(box.min.x, box.max.y), glm::vec2(box.max.x, box.max.y), color);
+void DebugRenderer::rect(const BoundingBox& box, glm::vec4 color, float duration) {
+	glm::vec2 size = box.max - box.min;
+	add(Shape_FilledRect, { .basis = glm::vec4(size.x, 0.0f, 0.0f, size.y), .translation = box.min, .color = color }, duration);
 }
 
-void DebugRenderer::circle(glm::vec2 center, float radius, glm::vec4 color) {
-	for(int i = 0; i < 12; ++i) {
-		float alpha = float(i) * glm::two_pi<float>() / 12.0f;
-		float beta = float(i + 1) * glm::two_pi<float>() / 12.0f;
-		line(glm::vec2(sin(alpha), cos(alpha)) * radius + center, glm::vec2(sin(beta), cos(beta)) * radius + center, color);
+void DebugRenderer::circle(glm::vec2 center, float radius, glm::vec4 color, float duration) {
+	add(Shape_Circle, { .basis = glm::vec4(radius, 0.0f, 0.0f, radius), .translation = center, .color = color }, duration);
+}
+
+void DebugRenderer::add(Shape shape, const Instance& instance, float duration) {
+	if(duration <= 0.0f) {
+		m_frame.instances[shape].push_back(instance);
+		return;
 	}
+
+	Clock::time_point expiry = Clock::time_point::max();
+	if(duration != Forever) expiry = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(duration));
+	m_persistent.emplace_back(shape, instance, expiry);
 }
 
-void DebugRenderer::draw() {
-	if(m_vertices.size() > MaxVertices)
-		logger::warn("Attempting to draw {} vertices, the debug renderer can only handle up to {}", m_vertices.size(), MaxVertices);
+void DebugRenderer::swapFrame(Frame& frame) {
+	Clock::time_point now = Clock::now();
+	std::erase_if(m_persistent, [now](const PersistentPrimitive& primitive) { return primitive.expiry <= now; });
+	for(const auto& primitive : m_persistent) m_frame.instances[primitive.shape].push_back(primitive.instance);
 
-	size_t vertexCount = std::min(m_vertices.size(), MaxVertices);
-	UINT stride = sizeof(DebugRenderer::Vertex);
-	UINT offset = 0;
+	m_frame.instances.swap(frame.instances);
+}
+
+void DebugRenderer::draw(const Frame& frame) {
+	size_t instanceCount = 0;
+	for(const auto& shapeInstances : frame.instances) instanceCount += shapeInstances.size();
+	if(instanceCount == 0) return;
 
+	auto* device = GraphicsContext::getInstance().getDevice();
 	auto* context = GraphicsContext::getInstance().getDeviceContext();
 
-	D3D11_MAPPED_SUBRESOURCE lineBufferResource;
-	handleFatalError(context->Map(m_lineBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &lineBufferResource), "Could not map line buffer to CPU memory");
-	memcpy(lineBufferResource.pData, m_vertices.data(), sizeof(DebugRenderer::Vertex) * vertexCount);
-	context->Unmap(m_lineBuffer.Get(), 0);
-
-	context->VSSetShader(m_lineVertexShader.Get(), nullptr, 0);
-	context->PSSetShader(m_linePixelShader.Get(), nullptr, 0);
-	context->IASetInputLayout(m_lineInputLayout.Get());
-	context->IASetVertexBuffers(0, 1, m_lineBuffer.GetAddressOf(), &stride, &offset);
-	context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINELIST);
-	context->Draw(vertexCount, 0);
+	// Grow geometrically so a slowly growing amount of primitives does not recreate the buffer every frame
+	if(instanceCount > m_instanceCapacity) {
+		m_instanceCapacity = std::max({ UINT(instanceCount), m_instanceCapacity * 2, 256u });
+
+		D3D11_BUFFER_DESC bufferDesc = {};
+		bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+		bufferDesc.ByteWidth = sizeof(Instance) * m_instanceCapacity;
+		bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+		bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		m_instanceBuffer.Reset();
+		handleFatalError(device->CreateBuffer(&bufferDesc, nullptr, &m_instanceBuffer), "Could not allocate debug instance buffer");
+	}
+
+	D3D11_MAPPED_SUBRESOURCE instanceBufferResource;
+	handleFatalError(
+	    context->Map(m_instanceBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &instanceBufferResource),
+	    "Could not map debug instance buffer to CPU memory"
+	);
+	auto* instances = static_cast<Instance*>(instanceBufferResource.pData);
+	for(const auto& shapeInstances : frame.instances) instances = std::ranges::copy(shapeInstances, instances).out;
+	context->Unmap(m_instanceBuffer.Get(), 0);
+
+	UINT strides[] = { sizeof(glm::vec2), sizeof(Instance) };
+	UINT offsets[] = { 0, 0 };
+	ID3D11Buffer* vertexBuffers[] = { m_shapeBuffer.Get(), m_instanceBuffer.Get() };
+
+	context->VSSetShader(m_vertexShader.Get(), nullptr, 0);
+	context->PSSetShader(m_pixelShader.Get(), nullptr, 0);
+	context->IASetInputLayout(m_inputLayout.Get());
+	context->IASetVertexBuffers(0, 2, vertexBuffers, strides, offsets);
+
+	UINT startInstance = 0;
+	for(unsigned shape = 0; shape < ShapeCount; ++shape) {
+		UINT count = UINT(frame.instances[shape].size());
+		if(count == 0) continue;
+
+		bool filled = shape == Shape_FilledRect;
+		context->IASetPrimitiveTopology(filled ? D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST : D3D11_PRIMITIVE_TOPOLOGY_LINELIST);
+		context->DrawInstanced(m_shapeRanges[shape].vertexCount, count, m_shapeRanges[shape].firstVertex, startInstance);
+		startInstance += count;
+	}
 }
 
 void DebugRenderer::clear() {
-	m_vertices.clear();
+	m_frame.clear();
 }
 
 #endif
@@ -2,40 +2,87 @@
 
 #ifdef _DEBUG
 
+	#include <array>
+	#include <chrono>
+	#include <limits>
 	#include <vector>
 
 	#include "math.hpp"
 	#include "physics/bounding_box.hpp"
 	#include "platform.hpp"
 
+// Draws debug primitives as instances of a few unit shapes, every primitive is a single transform and color
+// There is no limit on the amount of primitives, the instance buffer grows to fit the largest frame
 class DebugRenderer {
 public:
-	constexpr static size_t MaxLines = 1024;
-	constexpr static size_t MaxVertices = MaxLines * 2;
+	// Keeps a primitive around until clearPersistent is called
+	constexpr static float Forever = std::numeric_limits<float>::infinity();
+
+	// Filled shapes come first so outlines are drawn on top of them
+	enum Shape { Shape_FilledRect, Shape_Line, Shape_Box, Shape_Circle, ShapeCount };
+
+	// Maps the unit shape like a SpriteDrawable maps the unit quad
+	struct Instance {
+		glm::vec4 basis;
+		glm::vec2 translation;
+		glm::vec4 color;
+	};
+
+	// All primitives of a frame grouped by shape, the vectors are reused between frames
+	struct Frame {
+		std::array<std::vector<Instance>, ShapeCount> instances;
+
+		void clear() {
+			for(auto& shapeInstances : instances) shapeInstances.clear();
+		}
+	};
 
 public:
 	DebugRenderer();
 
-	void line(glm::vec2 a, glm::vec2 b, glm::vec4 color = glm::vec4(1.0f));
-	void box(const BoundingBox& box, glm::vec4 color = glm::vec4(1.0f));
-	void circle(glm::vec2 center, float radius, glm::vec4 color = glm::vec4(1.0f));
+	// A duration of zero only draws the primitive in the current frame
+	void line(glm::vec2 a, glm::vec2 b, glm::vec4 color = glm::vec4(1.0f), float duration = 0.0f);
+	void box(const BoundingBox& box, glm::vec4 color = glm::vec4(1.0f), float duration = 0.0f);
+	void rect(const BoundingBox& box, glm::vec4 color = glm::vec4(1.0f), float duration = 0.0f);
+	void circle(glm::vec2 center, float radius, glm::vec4 color = glm::vec4(1.0f), float duration = 0.0f);
+
+	// Primitives are recorded by the simulation and drawn by the render thread, this hands them over without copying
+	// The given frame should be empty, its memory is reused for recording the next frame
+	void swapFrame(Frame& frame);
 
-	void draw();
+	void draw(const Frame& frame);
 	void clear();
+	void clearPersistent() { m_persistent.clear(); }
 
 private:
-	struct Vertex {
-		glm::vec3 pos;
-		glm::vec4 color;
+	using Clock = std::chrono::steady_clock;
+
+	struct PersistentPrimitive {
+		Shape shape;
+		Instance instance;
+		Clock::time_point expiry;
+	};
+
+	struct ShapeRange {
+		UINT firstVertex;
+		UINT vertexCount;
 	};
 
 private:
-	std::vector<Vertex> m_vertices;
+	void add(Shape shape, const Instance& instance, float duration);
+
+private:
+	Frame m_frame;
+	std::vector<PersistentPrimitive> m_persistent;
+
+	std::array<ShapeRange, ShapeCount> m_shapeRanges;
+	UINT m_instanceCapacity = 0;
 
-	ComPtr<ID3D11Buffer> m_lineBuffer;
-	ComPtr<ID3D11InputLayout> m_lineInputLayout;
-	ComPtr<ID3D11VertexShader> m_lineVertexShader;
-	ComPtr<ID3D11PixelShader> m_linePixelShader;
+	ComPtr<ID3D11Buffer> m_shapeBuffer;
+	ComPtr<ID3D11Buffer> m_instanceBuffer;
+	ComPtr<ID3D11InputLayout> m_inputLayout;
+	ComPtr<ID3D11VertexShader> m_vertexShader;
+	ComPtr<ID3D11PixelShader> m_pixelShader;
 };
 
 #endif
@@ -4,20 +4,14 @@
 #include <cstdlib>
 #include <thread>
 
+#include "profiler.hpp"
 #include "sprite_atlas.hpp"
 
-static constexpr unsigned MaxInstances = 256;
+static constexpr unsigned MaxInstances = 1024;
 
 GraphicsContext* GraphicsContext::s_instance = nullptr;
 
-namespace {
-	struct InstanceData {
-		glm::mat4 matrix;
-		glm::vec4 texCoordSt;
-	};
-} // namespace
-
-void GraphicsContext::initialize() {
+void GraphicsContext::initialize(AssetLoader& loader) {
 	assert(!s_instance);
 	s_instance = new GraphicsContext();
 
@@ -25,11 +19,31 @@ void GraphicsContext::initialize() {
 	s_instance->m_debugRenderer = std::make_unique<DebugRenderer>();
 #endif
 
-	s_instance->loadResources();
+	s_instance->loadResources(loader);
 }
 
 void GraphicsContext::close() {
 	assert(s_instance);
+
+	const auto& batchStats = s_instance->m_batchStats;
+	logger::log(
+	    "Sprite batching: {} frames, {:.1f} draws/frame, {:.1f} state changes/frame",
+	    batchStats.frames,
+	    batchStats.getDrawsPerFrame(),
+	    batchStats.getStateChangesPerFrame()
+	);
+
+	if(s_instance->m_softwareRasterizer) {
+		const auto& stats = s_instance->m_softwareRasterizer->getStats();
+		logger::log(
+		    "Software rasterizer: {} frames, {:.0f} sprites/s, {:.1f} MP/s{}",
+		    stats.frames,
+		    stats.getSpritesPerSecond(),
+		    stats.getMegapixelsPerSecond(),
+		    s_instance->m_softwareRasterizer->getKernel() == SoftwareRasterizer::Kernel::Avx2 ? " (AVX2)" : ""
+		);
+	}
+
 	delete s_instance;
 	s_instance = nullptr;
 }
@@ -43,22 +57,33 @@ GraphicsContext::GraphicsContext() {
 	// Setup DX11
 	[[maybe_unused]] D3D_FEATURE_LEVEL featureLevel;
 
-	handleFatalError(
-	    D3D11CreateDevice(
-	        nullptr,
-	        D3D_DRIVER_TYPE_HARDWARE,
-	        nullptr,
-	        D3D11_CREATE_DEVICE_BGRA_SUPPORT,
-	        nullptr,
-	        0,
-	        D3D11_SDK_VERSION,
-	        &m_device,
-	        &featureLevel,
-	        &m_context
-	    ),
-	    "Could not setup DX11 device"
+	HRESULT result = D3D11CreateDevice(
+	    nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, D3D11_CREATE_DEVICE_BGRA_SUPPORT, nullptr, 0, D3D11_SDK_VERSION, &m_device, &featureLevel, &m_context
 	);
 
+	// Without a working GPU driver we still need a device for the swapchains, but sprites are rasterized on the CPU
+	if(FAILED(result)) {
+		logger::warn("Could not create a hardware DX11 device ({:#08x}), falling back to software rendering", (unsigned long)result);
+		handleFatalError(
+		    D3D11CreateDevice(
+		        nullptr,
+		        D3D_DRIVER_TYPE_WARP,
+		        nullptr,
+		        D3D11_CREATE_DEVICE_BGRA_SUPPORT,
+		        nullptr,
+		        0,
+		        D3D11_SDK_VERSION,
+		        &m_device,
+		        &featureLevel,
+		        &m_context
+		    ),
+		    "Could not setup DX11 device"
+		);
+
+		m_threadPool = std::make_unique<ThreadPool>();
+		m_softwareRasterizer = std::make_unique<SoftwareRasterizer>(m_threadPool.get());
+	}
+
 	// Setup DirectComposition
 	handleFatalError(DCompositionCreateDevice(nullptr, IID_PPV_ARGS(m_compDevice.GetAddressOf())), "Could not create a DirectComposition context");
 
@@ -81,7 +106,7 @@ GraphicsContext::GraphicsContext() {
 
 	D3D11_BUFFER_DESC instanceBufferDesc = {};
 	instanceBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	instanceBufferDesc.ByteWidth = sizeof(InstanceData) * MaxInstances;
+	instanceBufferDesc.ByteWidth = sizeof(SpriteDrawable) * MaxInstances;
 	instanceBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
 	instanceBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
 	handleFatalError(m_device->CreateBuffer(&instanceBufferDesc, nullptr, m_instanceBuffer.GetAddressOf()), "Could not create instancing buffer");
@@ -147,8 +172,10 @@ void GraphicsContext::prepareCameraMatrices(const Camera& camera) {
 	m_context->Unmap(m_cameraBuffer.Get(), 0);
 }
 
-void GraphicsContext::drawSprites(const Camera& camera, std::span<const SpriteDrawable> drawables) {
+void GraphicsContext::drawSprites(const Camera& camera, std::span<const SpriteDrawable> drawables, std::span<const uint64_t> keys) {
+	PROFILE_ZONE("GraphicsContext::drawSprites");
 	assert(camera.target);
+	assert(drawables.size() == keys.size());
 
 	// Prepare render target
 	D3D11_VIEWPORT viewport = {};
@@ -160,31 +187,129 @@ void GraphicsContext::drawSprites(const Camera& camera, std::span<const SpriteDr
 	float clearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
 
 	auto* rtv = camera.target->getRenderTargetView();
-	auto* srv = SpriteAtlas::getShaderResourceView();
+	auto* spriteTable = SpriteAtlas::getSpriteTableView();
 
 	m_context->OMSetRenderTargets(1, &rtv, nullptr);
 	m_context->RSSetViewports(1, &viewport);
-	m_context->ClearRenderTargetView(rtv, clearColor);
 	prepareCameraMatrices(camera);
 
+	if(m_softwareRasterizer) {
+		drawSpritesSoftware(camera, drawables, keys);
+		return;
+	}
+
+	m_context->ClearRenderTargetView(rtv, clearColor);
+
 	// Prepare rendering state
-	UINT strides[] = { sizeof(Vertex), sizeof(InstanceData) };
+	UINT strides[] = { sizeof(Vertex), sizeof(SpriteDrawable) };
 	UINT offsets[] = { 0, 0 };
 	ID3D11Buffer* vertexBuffers[] = { m_quadMesh->m_vertexBuffer.Get(), m_instanceBuffer.Get() };
 
 	m_context->RSSetState(m_noCull.Get());
-	m_context->VSSetShader(m_defaultVertexShader.Get(), nullptr, 0);
-	m_context->PSSetShader(m_defaultPixelShader.Get(), nullptr, 0);
-	m_context->PSSetShaderResources(0, 1, &srv);
+	m_context->VSSetShaderResources(0, 1, &spriteTable);
 	m_context->PSSetSamplers(0, 1, m_pointSampler.GetAddressOf());
 	m_context->VSSetConstantBuffers(0, 1, m_cameraBuffer.GetAddressOf());
 
-	m_context->IASetInputLayout(m_defaultInputLayout.Get());
 	m_context->IASetVertexBuffers(0, 2, vertexBuffers, strides, offsets);
 	m_context->IASetIndexBuffer(m_quadMesh->m_indexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
 	m_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
-	// Draw everything
+	++m_batchStats.frames;
+	m_boundState.reset();
+	m_boundPage = nullptr;
+
+	// The sprites are sorted by layer first, static sprites go below the dynamic sprites of the same layer
+	auto [visibleMin, visibleMax] = getVisibleArea(camera);
+	size_t layerStart = 0;
+	for(size_t layer = 0; layer < size_t(SpriteLayer::Count); ++layer) {
+		size_t layerEnd = layerStart;
+		while(layerEnd < keys.size() && size_t(SpriteSortKey::getLayer(keys[layerEnd])) == layer) ++layerEnd;
+
+		drawStaticChunks(SpriteLayer(layer), visibleMin, visibleMax);
+		drawSortedSprites(drawables.subspan(layerStart, layerEnd - layerStart), keys.subspan(layerStart, layerEnd - layerStart));
+		layerStart = layerEnd;
+	}
+}
+
+void GraphicsContext::updateStaticSprites() {
+	// The CPU rasterizer reads the sprites straight from the chunks, so there is nothing to upload
+	m_staticSprites.update(m_softwareRasterizer ? nullptr : m_device.Get());
+}
+
+void GraphicsContext::drawSortedSprites(std::span<const SpriteDrawable> drawables, std::span<const uint64_t> keys) {
+	// States only change between runs of sprites with a different pass or material
+	// Within a run the sprites are sorted by page, fallback sprites can still break that up while their pages load
+	for(size_t stateStart = 0; stateStart < drawables.size();) {
+		uint32_t state = SpriteSortKey::getState(keys[stateStart]);
+		size_t stateEnd = stateStart + 1;
+		while(stateEnd < drawables.size() && SpriteSortKey::getState(keys[stateEnd]) == state) ++stateEnd;
+
+		bindState(keys[stateStart]);
+		std::span<const SpriteDrawable> resolved = SpriteAtlas::resolve(drawables.subspan(stateStart, stateEnd - stateStart), m_resolvedDrawables);
+		for(size_t runStart = 0; runStart < resolved.size();) {
+			unsigned page = SpriteAtlas::getSprite(resolved[runStart].sprite).getPage();
+			size_t runEnd = runStart + 1;
+			while(runEnd < resolved.size() && SpriteAtlas::getSprite(resolved[runEnd].sprite).getPage() == page) ++runEnd;
+
+			bindPage(page);
+			drawInstances(resolved.subspan(runStart, runEnd - runStart));
+			runStart = runEnd;
+		}
+
+		stateStart = stateEnd;
+	}
+}
+
+void GraphicsContext::drawStaticChunks(SpriteLayer layer, glm::vec2 visibleMin, glm::vec2 visibleMax) {
+	UINT stride = sizeof(SpriteDrawable);
+	UINT offset = 0;
+	bool drawn = false;
+
+	for(const StaticSpriteLayer::Chunk& chunk : m_staticSprites.getChunks()) {
+		if(chunk.layer != layer || !chunk.overlaps(visibleMin, visibleMax)) continue;
+
+		m_context->IASetVertexBuffers(1, 1, chunk.instanceBuffer.GetAddressOf(), &stride, &offset);
+		++m_batchStats.stateChanges;
+		drawn = true;
+
+		for(const StaticSpriteLayer::Run& run : chunk.runs) {
+			// There is no fallback for static sprites, they show up once their page is loaded
+			unsigned page = SpriteSortKey::getPage(run.key);
+			if(!SpriteAtlas::usePage(page)) continue;
+
+			bindState(run.key);
+			bindPage(page);
+			m_context->DrawIndexedInstanced(m_quadMesh->getIndexCount(), run.count, 0, 0, run.first);
+			++m_batchStats.draws;
+		}
+	}
+
+	if(drawn) m_context->IASetVertexBuffers(1, 1, m_instanceBuffer.GetAddressOf(), &stride, &offset);
+}
+
+void GraphicsContext::bindState(uint64_t key) {
+	uint32_t state = SpriteSortKey::getState(key);
+	if(m_boundState == state) return;
+
+	const MaterialShaders& shaders = m_materials[size_t(SpriteSortKey::getMaterial(key))];
+	m_context->OMSetBlendState(m_passBlendStates[size_t(SpriteSortKey::getPass(key))].Get(), nullptr, 0xffffffff);
+	m_context->IASetInputLayout(shaders.inputLayout.Get());
+	m_context->VSSetShader(shaders.vertexShader.Get(), nullptr, 0);
+	m_context->PSSetShader(shaders.pixelShader.Get(), nullptr, 0);
+	m_boundState = state;
+	++m_batchStats.stateChanges;
+}
+
+void GraphicsContext::bindPage(unsigned page) {
+	auto* srv = SpriteAtlas::getPageView(page);
+	if(srv == m_boundPage) return;
+
+	m_context->PSSetShaderResources(0, 1, &srv);
+	m_boundPage = srv;
+	++m_batchStats.stateChanges;
+}
+
+void GraphicsContext::drawInstances(std::span<const SpriteDrawable> drawables) {
 	for(unsigned i = 0; i < unsigned(drawables.size()); i += MaxInstances) {
 		unsigned batchSize = std::min(MaxInstances, unsigned(drawables.size()) - i);
 		D3D11_MAPPED_SUBRESOURCE instanceBufferResource;
@@ -192,46 +317,84 @@ void GraphicsContext::drawSprites(const Camera& camera, std::span<const SpriteDr
 		    m_context->Map(m_instanceBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &instanceBufferResource),
 		    "Could not map instance buffer to CPU memory"
 		);
-		auto* instanceData = static_cast<InstanceData*>(instanceBufferResource.pData);
-		for(unsigned j = 0; j < batchSize; ++j)
-			instanceData[j] = InstanceData{ .matrix = drawables[i + j].matrix, .texCoordSt = drawables[i + j].sprite.getScaleOffset() };
+		memcpy(instanceBufferResource.pData, drawables.data() + i, sizeof(SpriteDrawable) * batchSize);
 		m_context->Unmap(m_instanceBuffer.Get(), 0);
 		m_context->DrawIndexedInstanced(m_quadMesh->getIndexCount(), batchSize, 0, 0, 0);
+		++m_batchStats.draws;
 	}
 }
 
-void GraphicsContext::loadResources() {
-	constexpr char defaultVertexSource[] = {
+void GraphicsContext::drawSpritesSoftware(const Camera& camera, std::span<const SpriteDrawable> drawables, std::span<const uint64_t> keys) {
+	auto [visibleMin, visibleMax] = getVisibleArea(camera);
+
+	// The rasterizer draws in order, so the visible static sprites are merged in below the dynamic sprites of their layer
+	if(!m_staticSprites.getChunks().empty()) {
+		m_softwareDrawables.clear();
+		size_t layerStart = 0;
+		for(size_t layer = 0; layer < size_t(SpriteLayer::Count); ++layer) {
+			size_t layerEnd = layerStart;
+			while(layerEnd < keys.size() && size_t(SpriteSortKey::getLayer(keys[layerEnd])) == layer) ++layerEnd;
+
+			for(const StaticSpriteLayer::Chunk& chunk : m_staticSprites.getChunks()) {
+				if(chunk.layer == SpriteLayer(layer) && chunk.overlaps(visibleMin, visibleMax)) m_softwareDrawables.append_range(chunk.drawables);
+			}
+			m_softwareDrawables.append_range(drawables.subspan(layerStart, layerEnd - layerStart));
+			layerStart = layerEnd;
+		}
+		drawables = m_softwareDrawables;
+	}
+
+	m_softwareRasterizer->drawSprites(SpriteAtlas::getImages(), SpriteAtlas::getSprites(), visibleMin, camera.target->getDimensions(), drawables);
+
+	const Image& framebuffer = m_softwareRasterizer->getFramebuffer();
+	ComPtr<ID3D11Resource> backBuffer;
+	camera.target->getRenderTargetView()->GetResource(backBuffer.GetAddressOf());
+	m_context->UpdateSubresource(backBuffer.Get(), 0, nullptr, framebuffer.pixels.data(), framebuffer.width * sizeof(uint32_t), 0);
+}
+
+std::pair<glm::vec2, glm::vec2> GraphicsContext::getVisibleArea(const Camera& camera) {
+	// The screen projection maps world coordinates 1:1 to pixels, so only the position and size of the surface are needed
+	glm::vec2 origin = glm::vec2(camera.target->getPosition()) - glm::vec2(camera.view[3]);
+	return { origin, origin + glm::vec2(camera.target->getDimensions()) };
+}
+
+void GraphicsContext::loadResources(AssetLoader& loader) {
+	constexpr static char defaultVertexSource[] = {
 #embed "embed/default_vs.cso"
 	};
-	constexpr char defaultPixelSource[] = {
+	constexpr static char defaultPixelSource[] = {
 #embed "embed/default_ps.cso"
 	};
 
-	constexpr D3D11_INPUT_ELEMENT_DESC layout[] = {
-		{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT,    0, 0,  D3D11_INPUT_PER_VERTEX_DATA,   0 },
-		{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT,       0, 12, D3D11_INPUT_PER_VERTEX_DATA,   0 },
+	constexpr static D3D11_INPUT_ELEMENT_DESC layout[] = {
+		{ "POSITION",    0, DXGI_FORMAT_R32G32B32_FLOAT,    0, 0,  D3D11_INPUT_PER_VERTEX_DATA,   0 },
+		{ "TEXCOORD",    0, DXGI_FORMAT_R32G32_FLOAT,       0, 12, D3D11_INPUT_PER_VERTEX_DATA,   0 },
 
-		{ "MODEL",    0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0,  D3D11_INPUT_PER_INSTANCE_DATA, 1 },
-		{ "MODEL",    1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 16, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
-		{ "MODEL",    2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 32, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
-		{ "MODEL",    3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 48, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
-		{ "ST",       0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 64, D3D11_INPUT_PER_INSTANCE_DATA, 1 }
+		{ "BASIS",       0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0,  D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+		{ "TRANSLATION", 0, DXGI_FORMAT_R32G32_FLOAT,       1, 16, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+		{ "SPRITE",      0, DXGI_FORMAT_R16_UINT,           1, 24, D3D11_INPUT_PER_INSTANCE_DATA, 1 }
 	};
 
-	handleFatalError(
-	    m_device->CreateInputLayout(
-	        layout, sizeof(layout) / sizeof(*layout), defaultVertexSource, sizeof(defaultVertexSource), &m_defaultInputLayout
-	    ),
-	    "Could not load vertex layout"
-	);
-	handleFatalError(
-	    m_device->CreateVertexShader(defaultVertexSource, sizeof(defaultVertexSource), nullptr, &m_defaultVertexShader),
-	    "Could not load vertex shader"
-	);
-	handleFatalError(
-	    m_device->CreatePixelShader(defaultPixelSource, sizeof(defaultPixelSource), nullptr, &m_defaultPixelShader), "Could not load pixel shader"
-	);
+	// Drivers compile the bytecode when the shaders are created, which is slow enough to be worth doing in parallel
+	// The device is free threaded and the two loads only write their own members
+	MaterialShaders* shaders = &m_materials[size_t(SpriteMaterial::Default)];
+	loader.load("Default vertex shader", [this, shaders]() {
+		handleFatalError(
+		    m_device->CreateInputLayout(
+		        layout, sizeof(layout) / sizeof(*layout), defaultVertexSource, sizeof(defaultVertexSource), &shaders->inputLayout
+		    ),
+		    "Could not load vertex layout"
+		);
+		handleFatalError(
+		    m_device->CreateVertexShader(defaultVertexSource, sizeof(defaultVertexSource), nullptr, &shaders->vertexShader),
+		    "Could not load vertex shader"
+		);
+	});
+	loader.load("Default pixel shader", [this, shaders]() {
+		handleFatalError(
+		    m_device->CreatePixelShader(defaultPixelSource, sizeof(defaultPixelSource), nullptr, &shaders->pixelShader), "Could not load pixel shader"
+		);
+	});
 
 	constexpr Vertex quadVertices[] = {
 		{ .position = glm::vec3(-0.5f, +0.5f, 0.0f), .uv = glm::vec2(0.0f, 1.0f) },
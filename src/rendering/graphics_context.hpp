@@ -1,20 +1,41 @@
 #pragma once
 
+#include <array>
 #include <memory>
+#include <optional>
 #include <span>
+#include <utility>
+#include <vector>
 
+#include "asset_loader.hpp"
 #include "camera.hpp"
 #include "debug_renderer.hpp"
 #include "mesh.hpp"
+#include "software_rasterizer.hpp"
 #include "sprite_drawable.hpp"
+#include "sprite_sort_key.hpp"
+#include "static_sprite_layer.hpp"
 #include "surface.hpp"
+#include "thread_pool.hpp"
 
 class GraphicsContext {
 public:
-	static void initialize();
+	// Creates the device right away, the shaders are created on the loader and have to be done before the first draw
+	static void initialize(AssetLoader& loader);
 	static void close();
 	[[nodiscard]] static GraphicsContext& getInstance();
 
+	struct BatchStats {
+		// Every surface drawn counts as a frame
+		size_t frames = 0;
+		size_t draws = 0;
+		// Blend state, shader and atlas page bindings
+		size_t stateChanges = 0;
+
+		[[nodiscard]] double getDrawsPerFrame() const { return frames ? double(draws) / double(frames) : 0.0; }
+		[[nodiscard]] double getStateChangesPerFrame() const { return frames ? double(stateChanges) / double(frames) : 0.0; }
+	};
+
 private:
 	GraphicsContext();
 
@@ -25,14 +46,30 @@ public:
 	[[nodiscard]] IDXGIFactory4* getFactory() const { return m_factory.Get(); }
 
 	void prepareCameraMatrices(const Camera& camera);
-	void drawSprites(const Camera& camera, std::span<const SpriteDrawable> drawables);
+	// The sprites have to be sorted by their packed sort keys, every run of sprites with the same state and atlas page is one instanced draw
+	void drawSprites(const Camera& camera, std::span<const SpriteDrawable> drawables, std::span<const uint64_t> keys);
+
+	[[nodiscard]] bool isSoftwareRendering() const { return m_softwareRasterizer != nullptr; }
+	[[nodiscard]] const BatchStats& getBatchStats() const { return m_batchStats; }
+	[[nodiscard]] StaticSpriteLayer& getStaticSprites() { return m_staticSprites; }
+	// Applies the changes to the static sprites, called once per frame on the render thread before drawing
+	void updateStaticSprites();
 
 #ifdef _DEBUG
 	[[nodiscard]] DebugRenderer& getDebugRenderer() const { return *m_debugRenderer; }
 #endif
 
 private:
-	void loadResources();
+	void loadResources(AssetLoader& loader);
+	void drawSortedSprites(std::span<const SpriteDrawable> drawables, std::span<const uint64_t> keys);
+	void drawStaticChunks(SpriteLayer layer, glm::vec2 visibleMin, glm::vec2 visibleMax);
+	void bindState(uint64_t key);
+	void bindPage(unsigned page);
+	void drawInstances(std::span<const SpriteDrawable> drawables);
+	void drawSpritesSoftware(const Camera& camera, std::span<const SpriteDrawable> drawables, std::span<const uint64_t> keys);
+
+	// Area of the world the camera shows, as min and max
+	[[nodiscard]] static std::pair<glm::vec2, glm::vec2> getVisibleArea(const Camera& camera);
 
 private:
 	static GraphicsContext* s_instance;
@@ -46,14 +83,31 @@ private:
 	ComPtr<ID3D11Buffer> m_cameraBuffer;
 	ComPtr<ID3D11Buffer> m_instanceBuffer;
 
-	ComPtr<ID3D11InputLayout> m_defaultInputLayout;
-	ComPtr<ID3D11VertexShader> m_defaultVertexShader;
-	ComPtr<ID3D11PixelShader> m_defaultPixelShader;
+	struct MaterialShaders {
+		ComPtr<ID3D11InputLayout> inputLayout;
+		ComPtr<ID3D11VertexShader> vertexShader;
+		ComPtr<ID3D11PixelShader> pixelShader;
+	};
+
+	// Indexed by SpriteMaterial and SpritePass, a null blend state is the default one without blending
+	std::array<MaterialShaders, size_t(SpriteMaterial::Count)> m_materials;
+	std::array<ComPtr<ID3D11BlendState>, size_t(SpritePass::Count)> m_passBlendStates;
 
 	ComPtr<ID3D11SamplerState> m_pointSampler;
 	ComPtr<ID3D11RasterizerState> m_noCull;
 
 	std::unique_ptr<Mesh> m_quadMesh;
+	std::vector<SpriteDrawable> m_resolvedDrawables;
+	std::vector<SpriteDrawable> m_softwareDrawables;
+	StaticSpriteLayer m_staticSprites;
+
+	// Bindings made during the current drawSprites, so runs with the same state do not bind it again
+	std::optional<uint32_t> m_boundState;
+	ID3D11ShaderResourceView* m_boundPage = nullptr;
+	BatchStats m_batchStats;
+
+	std::unique_ptr<ThreadPool> m_threadPool;
+	std::unique_ptr<SoftwareRasterizer> m_softwareRasterizer;
 
 #ifdef _DEBUG
 	std::unique_ptr<DebugRenderer> m_debugRenderer;
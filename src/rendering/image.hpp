@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// CPU side RGBA8 image, pixels are tightly packed with the red channel in the lowest byte
+struct Image {
+	unsigned width = 0;
+	unsigned height = 0;
+	std::vector<uint32_t> pixels;
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "camera.hpp"
+#include "debug_renderer.hpp"
+#include "sprite_drawable.hpp"
+
+// Everything the render thread needs to draw a frame, it is filled by the simulation and not touched by it again until it was rendered
+// Packets are reused, clearing keeps the memory of the vectors so building a frame does not allocate once their sizes have settled
+struct RenderPacket {
+	std::vector<Camera> cameras;
+	std::vector<SpriteDrawable> sprites;
+	// Packed SpriteSortKey of every sprite, the pipeline sorts the sprites by them when the packet is submitted
+	std::vector<uint64_t> spriteKeys;
+#ifdef _DEBUG
+	DebugRenderer::Frame debugFrame;
+#endif
+	// Without drawing the cameras are only used to test whether their surfaces are still occluded
+	bool draw = true;
+	// Benchmarks present without waiting for the vertical blank, so the frame time is not capped by the refresh rate
+	bool vsync = true;
+
+	void clear() {
+		cameras.clear();
+		sprites.clear();
+		spriteKeys.clear();
+#ifdef _DEBUG
+		debugFrame.clear();
+#endif
+		draw = true;
+		vsync = true;
+	}
+};
@@ -0,0 +1,117 @@
+#include "render_pipeline.hpp"
+
+#include "graphics_context.hpp"
+#include "profiler.hpp"
+#include "sprite_atlas.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+RenderPipeline::RenderPipeline(bool pipelined) {
+	m_stats.pipelined = pipelined;
+	if(pipelined) m_renderThread = std::thread([this]() { renderLoop(); });
+}
+
+RenderPipeline::~RenderPipeline() {
+	stop();
+}
+
+RenderPacket& RenderPipeline::beginPacket() {
+	PROFILE_ZONE("RenderPipeline::beginPacket");
+	Clock::time_point stallStart = Clock::now();
+
+	// Only this thread submits, so the counter can only move once the render thread completes a packet
+	uint64_t submitted = m_submitted.load(std::memory_order_relaxed) & ~StopBit;
+	uint64_t completed = m_completed.load(std::memory_order_acquire);
+	while(submitted - completed >= PacketCount) {
+		m_completed.wait(completed, std::memory_order_acquire);
+		completed = m_completed.load(std::memory_order_acquire);
+	}
+
+	m_packetStart = Clock::now();
+	m_stats.stallSeconds += std::chrono::duration<double>(m_packetStart - stallStart).count();
+
+	RenderPacket& packet = m_packets[submitted % PacketCount];
+	packet.clear();
+	return packet;
+}
+
+void RenderPipeline::submitPacket() {
+	PROFILE_ZONE("RenderPipeline::submitPacket");
+	RenderPacket& packet = m_packets[(m_submitted.load(std::memory_order_relaxed) & ~StopBit) % PacketCount];
+	m_sorter.sort(packet.spriteKeys, packet.sprites);
+
+	Clock::time_point submitStart = Clock::now();
+	m_stats.simulationSeconds += std::chrono::duration<double>(submitStart - m_packetStart).count();
+	++m_stats.frames;
+
+	if(!m_stats.pipelined) {
+		renderPacket(packet);
+		m_stats.submitSeconds += std::chrono::duration<double>(Clock::now() - submitStart).count();
+		m_submitted.fetch_add(1, std::memory_order_relaxed);
+		m_completed.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	m_submitted.fetch_add(1, std::memory_order_release);
+	m_submitted.notify_one();
+}
+
+void RenderPipeline::stop() {
+	if(!m_renderThread.joinable()) return;
+
+	m_submitted.fetch_or(StopBit, std::memory_order_release);
+	m_submitted.notify_one();
+	m_renderThread.join();
+}
+
+void RenderPipeline::renderLoop() {
+	profiler::setThreadName("Render");
+
+	uint64_t completed = 0;
+	while(true) {
+		uint64_t submitted = m_submitted.load(std::memory_order_acquire);
+		if((submitted & ~StopBit) == completed) {
+			if(submitted & StopBit) return;
+			m_submitted.wait(submitted, std::memory_order_acquire);
+			continue;
+		}
+
+		Clock::time_point submitStart = Clock::now();
+		renderPacket(m_packets[completed % PacketCount]);
+		m_stats.submitSeconds += std::chrono::duration<double>(Clock::now() - submitStart).count();
+
+		m_completed.store(++completed, std::memory_order_release);
+		m_completed.notify_one();
+	}
+}
+
+void RenderPipeline::renderPacket(const RenderPacket& packet) {
+	PROFILE_ZONE("RenderPipeline::renderPacket");
+	if(packet.draw) {
+		PROFILE_ZONE("Draw");
+		GraphicsContext::getInstance().updateStaticSprites();
+		for(const auto& camera : packet.cameras) {
+			GraphicsContext::getInstance().drawSprites(camera, packet.sprites, packet.spriteKeys);
+
+#ifdef _DEBUG
+			GraphicsContext::getInstance().getDebugRenderer().draw(packet.debugFrame);
+#endif
+		}
+
+		SpriteAtlas::updateResidency();
+	}
+
+	// Only the first present waits for the vertical blank, otherwise every additional screen would halve the frame rate
+	bool first = true;
+	bool occluded = true;
+	for(const auto& camera : packet.cameras) {
+		PROFILE_ZONE("Present");
+		UINT syncInterval = packet.draw && packet.vsync && first ? 1 : 0;
+		UINT flags = packet.draw ? 0 : DXGI_PRESENT_TEST;
+		occluded = camera.target->getSwapchain()->Present(syncInterval, flags) == DXGI_STATUS_OCCLUDED && occluded;
+		first = false;
+	}
+	m_occluded = occluded;
+
+	if(packet.draw && m_stats.firstFrame == Clock::time_point()) m_stats.firstFrame = Clock::now();
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "render_packet.hpp"
+#include "sprite_sorter.hpp"
+
+// Runs D3D submission and presentation on a separate render thread, so the simulation of the next frame overlaps the rendering of the last one
+// The two threads hand double buffered render packets to each other through a pair of frame counters without locking
+// Without the pipeline every packet is rendered right as it is submitted, which is there to measure what the pipeline gains
+class RenderPipeline {
+public:
+	constexpr static unsigned PacketCount = 2;
+
+	struct Stats {
+		size_t frames = 0;
+		// Time the simulation spent building packets and waiting for a free one
+		double simulationSeconds = 0.0;
+		double stallSeconds = 0.0;
+		// Time spent drawing and presenting, on the render thread or on the simulation thread without the pipeline
+		double submitSeconds = 0.0;
+		// When the first packet that was drawn got presented, stays empty if nothing was ever drawn
+		std::chrono::steady_clock::time_point firstFrame;
+		bool pipelined = true;
+
+		// Average time per frame on the simulation thread
+		[[nodiscard]] double getFrameMilliseconds() const {
+			double seconds = simulationSeconds + stallSeconds + (pipelined ? 0.0 : submitSeconds);
+			return frames ? seconds * 1e3 / double(frames) : 0.0;
+		}
+	};
+
+public:
+	explicit RenderPipeline(bool pipelined = true);
+	RenderPipeline(const RenderPipeline&) = delete;
+	RenderPipeline& operator=(const RenderPipeline&) = delete;
+	RenderPipeline(RenderPipeline&&) = delete;
+	RenderPipeline& operator=(RenderPipeline&&) = delete;
+	~RenderPipeline();
+
+	// Blocks until the render thread is done with the oldest packet and returns it cleared, only call this from the simulation thread
+	[[nodiscard]] RenderPacket& beginPacket();
+	// Sorts the sprites of the packet from the last beginPacket and hands it to the render thread, or renders it without the pipeline
+	void submitPacket();
+	// Renders everything that was submitted and stops the render thread, the stats are only valid after this
+	void stop();
+
+	// Whether every surface was occluded when the last packet was presented
+	[[nodiscard]] bool isOccluded() const { return m_occluded; }
+	[[nodiscard]] const Stats& getStats() const { return m_stats; }
+
+private:
+	void renderLoop();
+	void renderPacket(const RenderPacket& packet);
+
+private:
+	// Set in the submitted counter once no more packets will follow
+	constexpr static uint64_t StopBit = 1ull << 63;
+
+	std::array<RenderPacket, PacketCount> m_packets;
+	std::atomic_uint64_t m_submitted = 0;
+	std::atomic_uint64_t m_completed = 0;
+	std::atomic_bool m_occluded = false;
+
+	std::chrono::steady_clock::time_point m_packetStart;
+	SpriteSorter m_sorter;
+	Stats m_stats;
+
+	std::thread m_renderThread;
+};
@@ -0,0 +1,303 @@
+#include "software_rasterizer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "cpu_features.hpp"
+
+#if defined(_M_X64) || defined(__x86_64__)
+	#define RASTERIZER_X64
+	#include <immintrin.h>
+#endif
+
+#if defined(__clang__) || defined(__GNUC__)
+	#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+	#define TARGET_AVX2
+#endif
+
+namespace {
+	// One row of pixels covered by a sprite, lanes are computed from the absolute pixel index so every code path rounds identically
+	struct SpanParams {
+		glm::vec2 local;
+		glm::vec2 localDx;
+		glm::vec4 texelScaleOffset;
+		const uint32_t* atlas;
+		int atlasWidth;
+		int atlasHeight;
+		uint32_t* dst;
+		int start;
+		int count;
+	};
+
+	void rasterizeSpanScalar(const SpanParams& span, int from) {
+		float maxX = float(span.atlasWidth - 1);
+		float maxY = float(span.atlasHeight - 1);
+		for(int i = from; i < span.count; ++i) {
+			float index = float(span.start + i);
+			float lx = span.local.x + index * span.localDx.x;
+			float ly = span.local.y + index * span.localDx.y;
+			if(lx < -0.5f || lx >= 0.5f || ly < -0.5f || ly >= 0.5f) continue;
+
+			float tx = std::min(std::max(lx * span.texelScaleOffset.x + span.texelScaleOffset.z, 0.0f), maxX);
+			float ty = std::min(std::max(ly * span.texelScaleOffset.y + span.texelScaleOffset.w, 0.0f), maxY);
+			uint32_t color = span.atlas[(int(ty) * span.atlasWidth) + int(tx)];
+			if(color < 0x80000000u) continue; // alpha test, a < 0.5
+			span.dst[i] = color;
+		}
+	}
+
+#ifdef RASTERIZER_X64
+	void rasterizeSpanSse2(const SpanParams& span) {
+		const __m128 lanes = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128 negHalf = _mm_set1_ps(-0.5f);
+		const __m128 maxX = _mm_set1_ps(float(span.atlasWidth - 1));
+		const __m128 maxY = _mm_set1_ps(float(span.atlasHeight - 1));
+		const __m128 atlasWidth = _mm_set1_ps(float(span.atlasWidth));
+
+		int i = 0;
+		for(; i + 4 <= span.count; i += 4) {
+			__m128 index = _mm_add_ps(_mm_set1_ps(float(span.start + i)), lanes);
+			__m128 lx = _mm_add_ps(_mm_set1_ps(span.local.x), _mm_mul_ps(index, _mm_set1_ps(span.localDx.x)));
+			__m128 ly = _mm_add_ps(_mm_set1_ps(span.local.y), _mm_mul_ps(index, _mm_set1_ps(span.localDx.y)));
+			__m128 inside = _mm_and_ps(
+			    _mm_and_ps(_mm_cmpge_ps(lx, negHalf), _mm_cmplt_ps(lx, half)), _mm_and_ps(_mm_cmpge_ps(ly, negHalf), _mm_cmplt_ps(ly, half))
+			);
+			if(_mm_movemask_ps(inside) == 0) continue;
+
+			__m128 tx = _mm_add_ps(_mm_mul_ps(lx, _mm_set1_ps(span.texelScaleOffset.x)), _mm_set1_ps(span.texelScaleOffset.z));
+			__m128 ty = _mm_add_ps(_mm_mul_ps(ly, _mm_set1_ps(span.texelScaleOffset.y)), _mm_set1_ps(span.texelScaleOffset.w));
+			tx = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(tx, _mm_setzero_ps()), maxX)));
+			ty = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(ty, _mm_setzero_ps()), maxY)));
+
+			alignas(16) int texels[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(texels), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(ty, atlasWidth), tx)));
+			__m128i colors = _mm_setr_epi32(
+			    int(span.atlas[texels[0]]), int(span.atlas[texels[1]]), int(span.atlas[texels[2]]), int(span.atlas[texels[3]])
+			);
+
+			__m128i mask = _mm_and_si128(_mm_castps_si128(inside), _mm_srai_epi32(colors, 31));
+			auto* dst = reinterpret_cast<__m128i*>(span.dst + i);
+			__m128i previous = _mm_loadu_si128(dst);
+			_mm_storeu_si128(dst, _mm_or_si128(_mm_and_si128(mask, colors), _mm_andnot_si128(mask, previous)));
+		}
+
+		rasterizeSpanScalar(span, i);
+	}
+
+	TARGET_AVX2 void rasterizeSpanAvx2(const SpanParams& span) {
+		const __m256 lanes = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+		const __m256 half = _mm256_set1_ps(0.5f);
+		const __m256 negHalf = _mm256_set1_ps(-0.5f);
+		const __m256 maxX = _mm256_set1_ps(float(span.atlasWidth - 1));
+		const __m256 maxY = _mm256_set1_ps(float(span.atlasHeight - 1));
+		const __m256i atlasWidth = _mm256_set1_epi32(span.atlasWidth);
+
+		int i = 0;
+		for(; i + 8 <= span.count; i += 8) {
+			__m256 index = _mm256_add_ps(_mm256_set1_ps(float(span.start + i)), lanes);
+			__m256 lx = _mm256_add_ps(_mm256_set1_ps(span.local.x), _mm256_mul_ps(index, _mm256_set1_ps(span.localDx.x)));
+			__m256 ly = _mm256_add_ps(_mm256_set1_ps(span.local.y), _mm256_mul_ps(index, _mm256_set1_ps(span.localDx.y)));
+			__m256 inside = _mm256_and_ps(
+			    _mm256_and_ps(_mm256_cmp_ps(lx, negHalf, _CMP_GE_OQ), _mm256_cmp_ps(lx, half, _CMP_LT_OQ)),
+			    _mm256_and_ps(_mm256_cmp_ps(ly, negHalf, _CMP_GE_OQ), _mm256_cmp_ps(ly, half, _CMP_LT_OQ))
+			);
+			if(_mm256_movemask_ps(inside) == 0) continue;
+
+			__m256 tx = _mm256_add_ps(_mm256_mul_ps(lx, _mm256_set1_ps(span.texelScaleOffset.x)), _mm256_set1_ps(span.texelScaleOffset.z));
+			__m256 ty = _mm256_add_ps(_mm256_mul_ps(ly, _mm256_set1_ps(span.texelScaleOffset.y)), _mm256_set1_ps(span.texelScaleOffset.w));
+			__m256i texelX = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(tx, _mm256_setzero_ps()), maxX));
+			__m256i texelY = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(ty, _mm256_setzero_ps()), maxY));
+			__m256i texels = _mm256_add_epi32(_mm256_mullo_epi32(texelY, atlasWidth), texelX);
+			__m256i colors = _mm256_i32gather_epi32(reinterpret_cast<const int*>(span.atlas), texels, 4);
+
+			__m256i mask = _mm256_and_si256(_mm256_castps_si256(inside), _mm256_srai_epi32(colors, 31));
+			auto* dst = reinterpret_cast<__m256i*>(span.dst + i);
+			_mm256_storeu_si256(dst, _mm256_blendv_epi8(_mm256_loadu_si256(dst), colors, mask));
+		}
+
+		rasterizeSpanScalar(span, i);
+	}
+#endif
+
+	void rasterizeSpan(const SpanParams& span, SoftwareRasterizer::Kernel kernel) {
+#ifdef RASTERIZER_X64
+		if(kernel == SoftwareRasterizer::Kernel::Avx2) {
+			rasterizeSpanAvx2(span);
+			return;
+		}
+		if(kernel == SoftwareRasterizer::Kernel::Sse2) {
+			rasterizeSpanSse2(span);
+			return;
+		}
+#endif
+		rasterizeSpanScalar(span, 0);
+	}
+
+	// Conservative range of pixel indices for which value + i * step lies in [-0.5, 0.5), the kernels do the exact test
+	bool spanRange(float value, float step, int& min, int& max) {
+		if(std::abs(step) < 1e-12f) return value >= -0.5f && value < 0.5f;
+		float t0 = (-0.5f - value) / step;
+		float t1 = (0.5f - value) / step;
+		min = int(std::max(std::floor(std::min(t0, t1)) - 1.0f, float(min)));
+		max = int(std::min(std::ceil(std::max(t0, t1)) + 1.0f, float(max)));
+		return min <= max;
+	}
+} // namespace
+
+SoftwareRasterizer::SoftwareRasterizer(ThreadPool* threadPool) :
+    m_threadPool(threadPool),
+    m_kernel(isSupported(Kernel::Avx2) ? Kernel::Avx2 : isSupported(Kernel::Sse2) ? Kernel::Sse2 : Kernel::Scalar) {}
+
+bool SoftwareRasterizer::isSupported(Kernel kernel) {
+#ifdef RASTERIZER_X64
+	return kernel != Kernel::Avx2 || cpu_features::hasAvx2();
+#else
+	return kernel == Kernel::Scalar;
+#endif
+}
+
+bool SoftwareRasterizer::setKernel(Kernel kernel) {
+	if(!isSupported(kernel)) return false;
+	m_kernel = kernel;
+	return true;
+}
+
+void SoftwareRasterizer::drawSprites(
+    std::span<const Image> atlasPages, std::span<const Sprite> spriteTable, glm::vec2 origin, glm::uvec2 dimensions,
+    std::span<const SpriteDrawable> drawables
+) {
+	auto start = std::chrono::steady_clock::now();
+
+	if(m_framebuffer.width != dimensions.x || m_framebuffer.height != dimensions.y) setupTiles(dimensions);
+	setupSprites(atlasPages, spriteTable, origin, drawables);
+
+	if(m_threadPool) {
+		m_threadPool->parallelFor(unsigned(m_tiles.size()), [this](unsigned i) { rasterizeTile(m_tiles[i]); });
+	} else {
+		for(const auto& tile : m_tiles) rasterizeTile(tile);
+	}
+
+	m_stats.frames++;
+	m_stats.sprites += drawables.size();
+	m_stats.pixels += m_framebuffer.pixels.size();
+	m_stats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void SoftwareRasterizer::setupTiles(glm::uvec2 dimensions) {
+	m_framebuffer.width = dimensions.x;
+	m_framebuffer.height = dimensions.y;
+	m_framebuffer.pixels.resize(size_t(dimensions.x) * dimensions.y);
+
+	m_tiles.clear();
+	for(unsigned y = 0; y < dimensions.y; y += TileSize) {
+		for(unsigned x = 0; x < dimensions.x; x += TileSize) {
+			glm::ivec2 min = glm::ivec2(x, y);
+			glm::ivec2 max = glm::ivec2(std::min(x + TileSize, dimensions.x), std::min(y + TileSize, dimensions.y));
+			m_tiles.push_back(Tile{ .min = min, .max = max, .setups = {} });
+		}
+	}
+}
+
+void SoftwareRasterizer::setupSprites(
+    std::span<const Image> atlasPages, std::span<const Sprite> spriteTable, glm::vec2 origin, std::span<const SpriteDrawable> drawables
+) {
+	m_setups.clear();
+	for(auto& tile : m_tiles) tile.setups.clear();
+
+	glm::ivec2 framebufferSize = glm::ivec2(m_framebuffer.width, m_framebuffer.height);
+	unsigned tilesPerRow = (m_framebuffer.width + TileSize - 1) / TileSize;
+
+	for(const auto& drawable : drawables) {
+		if(drawable.sprite >= spriteTable.size()) continue;
+
+		const Sprite& sprite = spriteTable[drawable.sprite];
+		if(sprite.getPage() >= atlasPages.size()) continue;
+		const Image& atlas = atlasPages[sprite.getPage()];
+		glm::vec4 quad = sprite.getQuadScaleOffset();
+
+		// Trimmed sprites only cover part of the quad, so the basis is shrunk onto that part
+		glm::vec2 basisX = glm::vec2(drawable.basis.x, drawable.basis.y);
+		glm::vec2 basisY = glm::vec2(drawable.basis.z, drawable.basis.w);
+		glm::vec2 center = drawable.translation - origin + basisX * (quad.z + quad.x * 0.5f - 0.5f) + basisY * (quad.w + quad.y * 0.5f - 0.5f);
+		basisX *= quad.x;
+		basisY *= quad.y;
+		float det = basisX.x * basisY.y - basisY.x * basisX.y;
+		if(std::abs(det) < 1e-12f) continue;
+
+		// Pixel bounds of the quad
+		glm::vec2 extent = (glm::abs(basisX) + glm::abs(basisY)) * 0.5f;
+		glm::ivec2 min = glm::max(glm::ivec2(glm::floor(center - extent)), glm::ivec2(0));
+		glm::ivec2 max = glm::min(glm::ivec2(glm::ceil(center + extent)), framebufferSize);
+		if(min.x >= max.x || min.y >= max.y) continue;
+
+		// Inverse of the basis maps pixel centers back onto the unit quad
+		glm::vec2 invX = glm::vec2(basisY.y, -basisX.y) / det;
+		glm::vec2 invY = glm::vec2(-basisY.x, basisX.x) / det;
+		glm::vec2 pixel = glm::vec2(0.5f) - center;
+
+		// Rotated sprites are stored turned clockwise in the atlas
+		if(sprite.isRotated()) {
+			invX = glm::vec2(-invX.y, invX.x);
+			invY = glm::vec2(-invY.y, invY.x);
+		}
+
+		glm::vec4 st = sprite.getScaleOffset();
+		glm::vec2 atlasSize = glm::vec2(atlas.width, atlas.height);
+
+		SpriteSetup setup = {
+			.local = invX * pixel.x + invY * pixel.y,
+			.localDx = invX,
+			.localDy = invY,
+			.texelScaleOffset = glm::vec4(
+			    st.x * atlasSize.x, st.y * atlasSize.y, (0.5f * st.x + st.z) * atlasSize.x, (0.5f * st.y + st.w) * atlasSize.y
+			),
+			.atlas = &atlas,
+			.min = min,
+			.max = max,
+		};
+
+		auto index = unsigned(m_setups.size());
+		m_setups.push_back(setup);
+
+		for(int ty = min.y / int(TileSize); ty <= (max.y - 1) / int(TileSize); ++ty)
+			for(int tx = min.x / int(TileSize); tx <= (max.x - 1) / int(TileSize); ++tx) m_tiles[(ty * tilesPerRow) + tx].setups.push_back(index);
+	}
+}
+
+void SoftwareRasterizer::rasterizeTile(const Tile& tile) {
+	for(int y = tile.min.y; y < tile.max.y; ++y) {
+		uint32_t* row = m_framebuffer.pixels.data() + (size_t(y) * m_framebuffer.width);
+		std::fill(row + tile.min.x, row + tile.max.x, 0u);
+	}
+
+	for(unsigned index : tile.setups) {
+		const SpriteSetup& setup = m_setups[index];
+		int minY = std::max(tile.min.y, setup.min.y);
+		int maxY = std::min(tile.max.y, setup.max.y);
+
+		for(int y = minY; y < maxY; ++y) {
+			glm::vec2 rowLocal = setup.local + setup.localDy * float(y);
+
+			int minX = std::max(tile.min.x, setup.min.x);
+			int maxX = std::min(tile.max.x, setup.max.x) - 1;
+			if(!spanRange(rowLocal.x, setup.localDx.x, minX, maxX)) continue;
+			if(!spanRange(rowLocal.y, setup.localDx.y, minX, maxX)) continue;
+
+			SpanParams span = {
+				.local = rowLocal,
+				.localDx = setup.localDx,
+				.texelScaleOffset = setup.texelScaleOffset,
+				.atlas = setup.atlas->pixels.data(),
+				.atlasWidth = int(setup.atlas->width),
+				.atlasHeight = int(setup.atlas->height),
+				.dst = m_framebuffer.pixels.data() + (size_t(y) * m_framebuffer.width) + minX,
+				.start = minX,
+				.count = maxX - minX + 1,
+			};
+			rasterizeSpan(span, m_kernel);
+		}
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "image.hpp"
+#include "math.hpp"
+#include "sprite.hpp"
+#include "sprite_drawable.hpp"
+#include "thread_pool.hpp"
+
+// CPU implementation of the sprite pipeline in default_vs.hlsl/default_ps.hlsl
+// Sprites are point sampled, alpha tested and written premultiplied, exactly like the GPU path, so it can stand in for it
+// The framebuffer is split into tiles which are rasterized in parallel on the thread pool
+class SoftwareRasterizer {
+public:
+	constexpr static unsigned TileSize = 64;
+
+	// Inner loops of the spans, all of them produce the same pixels
+	enum class Kernel : uint8_t { Scalar, Sse2, Avx2 };
+
+	struct Stats {
+		size_t frames = 0;
+		size_t sprites = 0;
+		size_t pixels = 0;
+		double seconds = 0.0;
+
+		[[nodiscard]] double getSpritesPerSecond() const { return seconds > 0.0 ? double(sprites) / seconds : 0.0; }
+		[[nodiscard]] double getMegapixelsPerSecond() const { return seconds > 0.0 ? double(pixels) / seconds * 1e-6 : 0.0; }
+	};
+
+public:
+	// Uses the widest kernel the CPU supports
+	explicit SoftwareRasterizer(ThreadPool* threadPool = nullptr);
+
+	// Clears the framebuffer to transparent black and draws the sprites in order, origin is the world position of the top left pixel
+	void drawSprites(
+	    std::span<const Image> atlasPages, std::span<const Sprite> spriteTable, glm::vec2 origin, glm::uvec2 dimensions,
+	    std::span<const SpriteDrawable> drawables
+	);
+
+	[[nodiscard]] const Image& getFramebuffer() const { return m_framebuffer; }
+	[[nodiscard]] const Stats& getStats() const { return m_stats; }
+	void resetStats() { m_stats = {}; }
+
+	[[nodiscard]] static bool isSupported(Kernel kernel);
+	// Returns false and keeps the current kernel when the CPU does not support the one asked for
+	bool setKernel(Kernel kernel);
+	[[nodiscard]] Kernel getKernel() const { return m_kernel; }
+
+private:
+	// Everything needed to rasterize a sprite, the local quad coordinates are linear in the pixel coordinates
+	struct SpriteSetup {
+		glm::vec2 local;
+		glm::vec2 localDx;
+		glm::vec2 localDy;
+		glm::vec4 texelScaleOffset;
+		const Image* atlas;
+		glm::ivec2 min;
+		glm::ivec2 max;
+	};
+
+	struct Tile {
+		glm::ivec2 min;
+		glm::ivec2 max;
+		std::vector<unsigned> setups;
+	};
+
+private:
+	void setupTiles(glm::uvec2 dimensions);
+	void setupSprites(
+	    std::span<const Image> atlasPages, std::span<const Sprite> spriteTable, glm::vec2 origin, std::span<const SpriteDrawable> drawables
+	);
+	void rasterizeTile(const Tile& tile);
+
+private:
+	ThreadPool* m_threadPool;
+	Kernel m_kernel;
+
+	Image m_framebuffer;
+	std::vector<Tile> m_tiles;
+	std::vector<SpriteSetup> m_setups;
+	Stats m_stats;
+};
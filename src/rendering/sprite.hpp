@@ -1,25 +1,51 @@
 #pragma once
 
+#include <cstdint>
+
 #include "math.hpp"
 
 class Sprite {
 public:
 	constexpr Sprite() = default;
 
-	constexpr Sprite(unsigned x, unsigned y, unsigned width, unsigned height, unsigned atlasWidth, unsigned atlasHeight) :
-	    m_width(width),
-	    m_height(height),
+	// The rect is given as it is stored in the atlas page, rotated sprites are turned 90 degrees clockwise so width and height are swapped
+	// Trimmed sprites only cover part of their source image, which still maps onto the whole quad
+	constexpr Sprite(
+	    unsigned index, unsigned page, unsigned x, unsigned y, unsigned width, unsigned height, unsigned atlasWidth, unsigned atlasHeight,
+	    bool rotated = false, unsigned trimX = 0, unsigned trimY = 0, unsigned sourceWidth = 0, unsigned sourceHeight = 0
+	) :
+	    m_index(uint16_t(index)),
+	    m_page(uint16_t(page)),
+	    m_rotated(rotated),
+	    m_width(sourceWidth ? sourceWidth : (rotated ? height : width)),
+	    m_height(sourceHeight ? sourceHeight : (rotated ? width : height)),
 	    m_scaleX(float(width) / float(atlasWidth)),
-	    m_scaleY(float(height / float(atlasHeight))),
+	    m_scaleY(float(height) / float(atlasHeight)),
 	    m_offsetX(float(x) / float(atlasWidth)),
-	    m_offsetY(float(y) / float(atlasHeight)) {}
+	    m_offsetY(float(y) / float(atlasHeight)),
+	    m_quadScaleX(float(rotated ? height : width) / float(m_width)),
+	    m_quadScaleY(float(rotated ? width : height) / float(m_height)),
+	    m_quadOffsetX(float(trimX) / float(m_width)),
+	    m_quadOffsetY(float(trimY) / float(m_height)) {}
 
+	// Index of the sprite in the atlas sprite table, this is what the GPU uses to look up the texture coordinates
+	[[nodiscard]] constexpr uint16_t getIndex() const { return m_index; }
+	// Atlas page the sprite is on, pages are separate textures
+	[[nodiscard]] constexpr uint16_t getPage() const { return m_page; }
+	[[nodiscard]] constexpr bool isRotated() const { return m_rotated; }
+	// Size of the source image, before trimming
 	[[nodiscard]] glm::uvec2 getDimensions() const { return glm::vec2(m_width, m_height); }
 	[[nodiscard]] constexpr unsigned getWidth() const { return m_width; }
 	[[nodiscard]] constexpr unsigned getHeight() const { return m_height; }
+	// Rect of the sprite in its atlas page, in texture coordinates
 	[[nodiscard]] glm::vec4 getScaleOffset() const { return glm::vec4(m_scaleX, m_scaleY, m_offsetX, m_offsetY); }
+	// Part of the unit quad that is covered by the trimmed sprite, with the quad going from 0 to 1
+	[[nodiscard]] glm::vec4 getQuadScaleOffset() const { return glm::vec4(m_quadScaleX, m_quadScaleY, m_quadOffsetX, m_quadOffsetY); }
 
 private:
+	uint16_t m_index = 0;
+	uint16_t m_page = 0;
+	bool m_rotated = false;
 	unsigned m_width = 0;
 	unsigned m_height = 0;
 
@@ -27,4 +53,9 @@ private:
 	float m_scaleY = 0.0f;
 	float m_offsetX = 0.0f;
 	float m_offsetY = 0.0f;
+
+	float m_quadScaleX = 1.0f;
+	float m_quadScaleY = 1.0f;
+	float m_quadOffsetX = 0.0f;
+	float m_quadOffsetY = 0.0f;
 };
@@ -1,60 +1,186 @@
 #include "sprite_atlas.hpp"
 
-#include <memory>
-#include <utility>
-
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb/stb_image.h>
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <span>
+#include <vector>
 
+#include "atlas/baked_atlas.hpp"
 #include "graphics_context.hpp"
 
-ComPtr<ID3D11ShaderResourceView> SpriteAtlas::s_shaderResourceView;
+std::vector<BakedPageView> SpriteAtlas::s_bakedPages;
+std::vector<SpriteAtlas::Page> SpriteAtlas::s_pages;
+std::unique_ptr<AtlasResidency> SpriteAtlas::s_residency;
+std::unique_ptr<ThreadPool> SpriteAtlas::s_loadThreads;
+std::optional<SpriteId> SpriteAtlas::s_fallbackSprite;
+std::vector<unsigned> SpriteAtlas::s_loads;
+std::vector<unsigned> SpriteAtlas::s_evictions;
+std::vector<MaskRun> SpriteAtlas::s_maskRuns;
+std::vector<uint32_t> SpriteAtlas::s_maskOffsets;
+ComPtr<ID3D11ShaderResourceView> SpriteAtlas::s_spriteTableView;
+std::vector<Image> SpriteAtlas::s_images;
+
+// Matches SpriteTableEntry in default_vs.hlsl
+struct SpriteTableEntry {
+	glm::vec4 quad;
+	glm::vec4 texture;
+	uint32_t rotated;
+};
 
 void SpriteAtlas::load() {
-	constexpr char pngFile[] = {
-#embed "embed/atlas.png"
+	alignas(uint32_t) constexpr static unsigned char bakedFile[] = {
+#embed "embed/atlas.bin"
 	};
 
-	// Load texture data
-	int w = 0;
-	int h = 0;
-	int components = 0;
-	unsigned char* imageData =
-	    stbi_load_from_memory(reinterpret_cast<const unsigned char*>(pngFile), sizeof(pngFile), &w, &h, &components, 4); // NOLINT
+	// The baked atlas is already premultiplied and laid out like the textures, so the embedded pixels are uploaded as they are
+	std::optional<std::vector<BakedPageView>> pages = readBakedAtlas(std::as_bytes(std::span(bakedFile)));
+	if(!pages || pages->size() != getPageCount()) fatalError("The embedded sprite atlas is invalid");
+	s_bakedPages = std::move(*pages);
+
+	// The masks are read from the embedded pixels, so they exist no matter where the sprites are rasterized
+	s_maskOffsets.reserve(getSprites().size() + 1);
+	for(const Sprite& sprite : getSprites()) {
+		s_maskOffsets.push_back(uint32_t(s_maskRuns.size()));
+		buildSpriteMask(s_bakedPages[sprite.getPage()], sprite, s_maskRuns);
+	}
+	s_maskOffsets.push_back(uint32_t(s_maskRuns.size()));
+
+	if(GraphicsContext::getInstance().isSoftwareRendering()) {
+		// The CPU rasterizer reads straight from memory, so every page is kept around and residency does not apply
+		for(const BakedPageView& page : s_bakedPages) {
+			Image& image = s_images.emplace_back();
+			image.width = page.width;
+			image.height = page.height;
+			image.pixels.resize(size_t(page.width) * page.height);
+			for(unsigned y = 0; y < page.height; ++y) {
+				const uint32_t* row = page.pixels + (size_t(y) * page.rowPitch / sizeof(uint32_t));
+				std::copy_n(row, page.width, &image.pixels[size_t(y) * page.width]);
+			}
+		}
+	} else {
+		std::vector<size_t> pageBytes;
+		for(const BakedPageView& page : s_bakedPages) pageBytes.push_back(page.getByteSize());
+		s_residency = std::make_unique<AtlasResidency>(std::move(pageBytes), DefaultMemoryBudget);
+		s_pages.resize(s_bakedPages.size());
+		s_loadThreads = std::make_unique<ThreadPool>(1);
+
+		// The first page is needed right away, so it is loaded before the first frame
+		s_residency->pin(0);
+		s_residency->endFrame(s_loads, s_evictions);
+		s_pages[0].view = createPageView(s_bakedPages[0]);
+		s_residency->finishLoad(0);
+	}
+
+	// Create the sprite table, the vertex shader looks up the quad and texture coordinates of each instance in here
+	std::vector<SpriteTableEntry> entries;
+	entries.reserve(getSprites().size());
+	for(const Sprite& sprite : getSprites())
+		entries.push_back({ .quad = sprite.getQuadScaleOffset(), .texture = sprite.getScaleOffset(), .rotated = sprite.isRotated() ? 1u : 0u });
+
+	D3D11_BUFFER_DESC spriteTableDesc = {};
+	spriteTableDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	spriteTableDesc.ByteWidth = UINT(sizeof(SpriteTableEntry) * entries.size());
+	spriteTableDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	spriteTableDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+	spriteTableDesc.StructureByteStride = sizeof(SpriteTableEntry);
+
+	D3D11_SUBRESOURCE_DATA spriteTableData = {};
+	spriteTableData.pSysMem = entries.data();
+
+	ID3D11Buffer* spriteTable;
+	handleFatalError(
+	    GraphicsContext::getInstance().getDevice()->CreateBuffer(&spriteTableDesc, &spriteTableData, &spriteTable), "Could not create sprite table"
+	);
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC spriteTableViewDesc = {};
+	spriteTableViewDesc.Format = DXGI_FORMAT_UNKNOWN;
+	spriteTableViewDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+	spriteTableViewDesc.Buffer.NumElements = UINT(entries.size());
+
+	handleFatalError(
+	    GraphicsContext::getInstance().getDevice()->CreateShaderResourceView(spriteTable, &spriteTableViewDesc, s_spriteTableView.GetAddressOf()),
+	    "Could not create a shader resource view for the sprite table"
+	);
+	spriteTable->Release();
+}
+
+void SpriteAtlas::destroy() {
+	// Pending loads reference the device, so they have to finish first
+	s_loadThreads.reset();
+	s_pages.clear();
+	s_residency.reset();
+	s_bakedPages.clear();
+	s_fallbackSprite.reset();
+	s_maskRuns.clear();
+	s_maskOffsets.clear();
+	s_images.clear();
+	s_spriteTableView.Reset();
+}
 
-	// Create DX11 texture
+void SpriteAtlas::setMemoryBudget(size_t bytes) {
+	if(s_residency) s_residency->setBudget(bytes);
+}
+
+void SpriteAtlas::setFallbackSprite(SpriteId sprite) {
+	s_fallbackSprite = sprite;
+	if(s_residency) s_residency->pin(getSprite(sprite).getPage());
+}
+
+std::span<const SpriteDrawable> SpriteAtlas::resolve(std::span<const SpriteDrawable> drawables, std::vector<SpriteDrawable>& scratch) {
+	return s_residency ? s_residency->resolve(drawables, getSprites(), s_fallbackSprite, scratch) : drawables;
+}
+
+void SpriteAtlas::updateResidency() {
+	if(!s_residency) return;
+
+	for(size_t i = 0; i < s_pages.size(); ++i) {
+		Page& page = s_pages[i];
+		if(!page.pending.valid() || page.pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready) continue;
+
+		page.view = page.pending.get();
+		s_residency->finishLoad(unsigned(i));
+	}
+
+	s_residency->endFrame(s_loads, s_evictions);
+	for(unsigned page : s_evictions) s_pages[page].view.Reset();
+
+	// Creating the texture is the expensive part, D3D11 devices are free threaded so it happens on the load thread
+	for(unsigned page : s_loads) {
+		const BakedPageView& bakedPage = s_bakedPages[page];
+		s_pages[page].pending = s_loadThreads->submit([&bakedPage]() { return createPageView(bakedPage); });
+	}
+}
+
+ComPtr<ID3D11ShaderResourceView> SpriteAtlas::createPageView(const BakedPageView& page) {
 	D3D11_TEXTURE2D_DESC textureDesc = {};
-	textureDesc.Width = UINT(w);
-	textureDesc.Height = UINT(h);
+	textureDesc.Width = page.width;
+	textureDesc.Height = page.height;
 	textureDesc.MipLevels = 1;
 	textureDesc.ArraySize = 1;
 	textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
 	textureDesc.SampleDesc.Count = 1;
-	textureDesc.Usage = D3D11_USAGE_DEFAULT;
+	textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
 	textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
 
 	D3D11_SUBRESOURCE_DATA textureData = {};
-	textureData.pSysMem = imageData;
-	textureData.SysMemPitch = UINT(w) * 4;
+	textureData.pSysMem = page.pixels;
+	textureData.SysMemPitch = page.rowPitch;
 
-	ID3D11Texture2D* texture;
-	handleFatalError(GraphicsContext::getInstance().getDevice()->CreateTexture2D(&textureDesc, &textureData, &texture), "Could not create a texture");
+	ComPtr<ID3D11Texture2D> texture;
+	handleFatalError(
+	    GraphicsContext::getInstance().getDevice()->CreateTexture2D(&textureDesc, &textureData, texture.GetAddressOf()), "Could not create a texture"
+	);
 
 	D3D11_SHADER_RESOURCE_VIEW_DESC shaderResourceViewDesc = {};
 	shaderResourceViewDesc.Format = textureDesc.Format;
 	shaderResourceViewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
 	shaderResourceViewDesc.Texture2D.MipLevels = 1;
 
+	ComPtr<ID3D11ShaderResourceView> view;
 	handleFatalError(
-	    GraphicsContext::getInstance().getDevice()->CreateShaderResourceView(texture, &shaderResourceViewDesc, s_shaderResourceView.GetAddressOf()),
+	    GraphicsContext::getInstance().getDevice()->CreateShaderResourceView(texture.Get(), &shaderResourceViewDesc, view.GetAddressOf()),
 	    "Could not create a shader resource view"
 	);
-	texture->Release();
-
-	// Free texture data
-	stbi_image_free(imageData);
-}
-
-void SpriteAtlas::destroy() {
-	s_shaderResourceView.Reset();
+	return view;
 }
@@ -1,58 +1,89 @@
 #pragma once
 
-#include <cassert>
+#include <future>
 #include <memory>
-#include <string>
-#include <unordered_map>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
 
+#include "atlas/baked_atlas.hpp"
+#include "atlas_residency.hpp"
+#include "image.hpp"
 #include "platform.hpp"
 #include "sprite.hpp"
+#include "sprite_drawable.hpp"
+#include "sprite_mask.hpp"
+#include "sprite_table.hpp"
+#include "thread_pool.hpp"
 
 class SpriteAtlas {
+public:
+	constexpr static size_t DefaultMemoryBudget = 256ull * 1024 * 1024;
+
 public:
 	static void load();
 	static void destroy();
 
-	[[nodiscard]] static ID3D11ShaderResourceView* getShaderResourceView() { return s_shaderResourceView.Get(); }
-	[[nodiscard]] static consteval Sprite get(const char* name);
+	// Page 0 is always resident, sprites on other pages are loaded in the background the first time they are drawn
+	// Both settings have to be made before rendering starts, the fallback page is kept resident like page 0
+	static void setMemoryBudget(size_t bytes);
+	static void setFallbackSprite(SpriteId sprite);
 
-private:
-	static consteval std::string_view nextValue(std::string_view data) {
-		size_t start = data.find_first_of(':') + 1;
-		start = data.find_first_not_of(" \n\r\t", start);
-		size_t end = data.find_first_not_of("1234567890", start);
-		return data.substr(start, end - start);
-	}
+	// Marks the pages of the sprites as used, sprites on pages that are not resident yet are swapped for the fallback sprite
+	// Returns the drawables unchanged when everything is resident, otherwise the result is written to the scratch vector
+	[[nodiscard]] static std::span<const SpriteDrawable> resolve(std::span<const SpriteDrawable> drawables, std::vector<SpriteDrawable>& scratch);
+	// Marks the page as used and returns whether it is resident, for sprites that are drawn without going through resolve
+	[[nodiscard]] static bool usePage(unsigned page) { return !s_residency || s_residency->use(page); }
+	// Finishes page loads, starts new ones and releases evicted pages, called once per frame on the render thread
+	static void updateResidency();
 
-	static consteval unsigned readUnsigned(std::string_view str) {
-		unsigned value = 0;
-		for(char c : str) value = value * 10 + (c - '0');
-		return value;
+	[[nodiscard]] static ID3D11ShaderResourceView* getPageView(unsigned page) { return s_pages[page].view.Get(); }
+	[[nodiscard]] static ID3D11ShaderResourceView* getSpriteTableView() { return s_spriteTableView.Get(); }
+	// The decoded pages are only kept around when sprites are rasterized on the CPU
+	[[nodiscard]] static std::span<const Image> getImages() { return s_images; }
+	[[nodiscard]] static const AtlasResidency* getResidency() { return s_residency.get(); }
+	// Opaque pixels of the sprite, built from the atlas when it is loaded
+	[[nodiscard]] static std::span<const MaskRun> getMask(SpriteId id) {
+		return std::span(s_maskRuns).subspan(s_maskOffsets[id], s_maskOffsets[id + 1] - s_maskOffsets[id]);
 	}
 
+	// Fails to compile when the atlas has no sprite with that name
+	[[nodiscard]] static consteval Sprite get(std::string_view name) { return s_table.getSprite(s_table.find(name).value()); }
+	[[nodiscard]] static constexpr std::optional<SpriteId> find(std::string_view name) { return s_table.find(name); }
+	[[nodiscard]] static constexpr const Sprite& getSprite(SpriteId id) { return s_table.getSprite(id); }
+	[[nodiscard]] static constexpr std::string_view getName(SpriteId id) { return s_table.getName(id); }
+	[[nodiscard]] static constexpr std::span<const Sprite> getSprites() { return s_table.getSprites(); }
+	[[nodiscard]] static constexpr size_t getPageCount() { return s_table.getPageCount(); }
+
 private:
-	static ComPtr<ID3D11ShaderResourceView> s_shaderResourceView;
-};
+	struct Page {
+		ComPtr<ID3D11ShaderResourceView> view;
+		std::future<ComPtr<ID3D11ShaderResourceView>> pending;
+	};
 
-// yeah i know this code is a bit undercooked, but it gets the job done so whatever
-consteval Sprite SpriteAtlas::get(const char* name) {
+private:
+	static ComPtr<ID3D11ShaderResourceView> createPageView(const BakedPageView& page);
+
+private:
 	constexpr static char jsonFile[] = {
 #embed "embed/atlas.json"
 	};
-	constexpr static const char* xId = "\"x\"";
-	constexpr static const char* yId = "\"y\"";
-	constexpr static const char* widthId = "\"width\"";
-	constexpr static const char* heightId = "\"height\"";
-	constexpr static const std::string_view file(jsonFile, sizeof(jsonFile));
-
-	unsigned atlasWidth = readUnsigned(nextValue(file.substr(file.find(widthId))));
-	unsigned atlasHeight = readUnsigned(nextValue(file.substr(file.find(heightId))));
-
-	std::string_view mySegment = file.substr(file.find(name));
-	unsigned spriteX = readUnsigned(nextValue(mySegment.substr(mySegment.find(xId))));
-	unsigned spriteY = readUnsigned(nextValue(mySegment.substr(mySegment.find(yId))));
-	unsigned spriteWidth = readUnsigned(nextValue(mySegment.substr(mySegment.find(widthId))));
-	unsigned spriteHeight = readUnsigned(nextValue(mySegment.substr(mySegment.find(heightId))));
-
-	return Sprite(spriteX, spriteY, spriteWidth, spriteHeight, atlasWidth, atlasHeight);
-}
+	constexpr static std::string_view file = std::string_view(jsonFile, sizeof(jsonFile));
+	constexpr static auto s_table = SpriteTable<SpriteTable<0>::count(file)>::parse(file);
+
+private:
+	static std::vector<BakedPageView> s_bakedPages;
+	static std::vector<Page> s_pages;
+	static std::unique_ptr<AtlasResidency> s_residency;
+	static std::unique_ptr<ThreadPool> s_loadThreads;
+	static std::optional<SpriteId> s_fallbackSprite;
+	static std::vector<unsigned> s_loads;
+	static std::vector<unsigned> s_evictions;
+	static std::vector<MaskRun> s_maskRuns;
+	// The runs of a sprite go from its offset to the offset of the next sprite
+	static std::vector<uint32_t> s_maskOffsets;
+
+	static ComPtr<ID3D11ShaderResourceView> s_spriteTableView;
+	static std::vector<Image> s_images;
+};
@@ -1,9 +1,28 @@
 #pragma once
 
+#include <cstdint>
+
+#include "../affine2d.hpp"
 #include "../math.hpp"
 #include "sprite.hpp"
 
+// Compact 2D sprite instance, this is uploaded to the instance buffer as is
+// The unit quad is placed on screen as: basis.xy * x + basis.zw * y + translation
 struct SpriteDrawable {
-	Sprite sprite;
-	glm::mat4 matrix;
+	glm::vec4 basis = glm::vec4(1.0f, 0.0f, 0.0f, 1.0f);
+	glm::vec2 translation = glm::vec2(0.0f);
+	uint16_t sprite = 0;
+	uint16_t padding = 0;
+
+	void setSprite(const Sprite& sprite) { this->sprite = sprite.getIndex(); }
+
+	void setTransform(const Affine2D& transform) {
+		basis = transform.getBasis();
+		translation = transform.translation;
+	}
+	[[nodiscard]] Affine2D getTransform() const {
+		return { .x = glm::vec2(basis.x, basis.y), .y = glm::vec2(basis.z, basis.w), .translation = translation };
+	}
 };
+
+static_assert(sizeof(SpriteDrawable) == 28, "SpriteDrawable must match the instance layout in default_vs.hlsl");
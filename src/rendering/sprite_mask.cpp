@@ -0,0 +1,92 @@
+#include "sprite_mask.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "sprite_atlas.hpp"
+#include "transform_kernels.hpp"
+
+void buildSpriteMask(const BakedPageView& page, const Sprite& sprite, std::vector<MaskRun>& runs) {
+	// Sprites only keep normalized rects, the pixel rects are recovered by rounding
+	glm::vec4 st = sprite.getScaleOffset();
+	glm::vec4 quad = sprite.getQuadScaleOffset();
+	glm::vec2 dimensions = glm::vec2(sprite.getDimensions());
+	glm::ivec2 atlasMin = glm::ivec2(glm::round(glm::vec2(st.z * float(page.width), st.w * float(page.height))));
+	glm::ivec2 trim = glm::ivec2(glm::round(glm::vec2(quad.z, quad.w) * dimensions));
+	glm::ivec2 size = glm::ivec2(glm::round(glm::vec2(quad.x, quad.y) * dimensions));
+
+	size_t previousRow = runs.size();
+	std::vector<MaskRun> row;
+	for(int y = 0; y < size.y; ++y) {
+		row.clear();
+		for(int x = 0; x < size.x; ++x) {
+			// Rotated sprites are stored turned clockwise in the atlas
+			glm::ivec2 texel = sprite.isRotated() ? atlasMin + glm::ivec2(size.y - 1 - y, x) : atlasMin + glm::ivec2(x, y);
+			uint32_t color = page.pixels[(size_t(texel.y) * page.rowPitch / sizeof(uint32_t)) + size_t(texel.x)];
+			if(color < 0x80000000u) continue; // alpha test, a < 0.5
+
+			auto column = uint16_t(trim.x + x);
+			if(!row.empty() && row.back().end == column) {
+				++row.back().end;
+			} else {
+				row.push_back({ .begin = column, .end = uint16_t(column + 1), .top = uint16_t(trim.y + y), .bottom = uint16_t(trim.y + y + 1) });
+			}
+		}
+
+		// A row that matches the one above only grows the runs of that row
+		std::span<MaskRun> above = std::span(runs).subspan(previousRow);
+		bool same = !row.empty() && row.size() == above.size() && std::ranges::equal(row, above, [&](const MaskRun& a, const MaskRun& b) {
+			return a.begin == b.begin && a.end == b.end && b.bottom == a.top;
+		});
+		if(same) {
+			for(MaskRun& run : above) ++run.bottom;
+		} else {
+			previousRow = runs.size();
+			runs.insert(runs.end(), row.begin(), row.end());
+		}
+	}
+}
+
+void transformSpriteMask(std::span<const MaskRun> runs, const Sprite& sprite, const glm::vec4& basis, std::vector<IntBoundingBox>& rects) {
+	// The quad goes from -0.5 to 0.5, neighbouring runs share their corners so they still touch after rounding
+	glm::vec2 dimensions = glm::vec2(sprite.getDimensions());
+	std::vector<BoundingBox> boxes(runs.size());
+	for(size_t i = 0; i < runs.size(); ++i) {
+		boxes[i].min = glm::vec2(runs[i].begin, runs[i].top) / dimensions - 0.5f;
+		boxes[i].max = glm::vec2(runs[i].end, runs[i].bottom) / dimensions - 0.5f;
+	}
+	transform_kernels::transformBounds({ .x = glm::vec2(basis.x, basis.y), .y = glm::vec2(basis.z, basis.w) }, boxes, boxes);
+
+	rects.clear();
+	for(const BoundingBox& box : boxes) {
+		IntBoundingBox rect = { .min = glm::ivec2(glm::round(box.min)), .max = glm::ivec2(glm::round(box.max)) };
+		if(rect.min.x < rect.max.x && rect.min.y < rect.max.y) rects.push_back(rect);
+	}
+}
+
+bool SpriteRegion::update(const SpriteDrawable& drawable) {
+	glm::ivec2 offset = glm::ivec2(glm::round(drawable.translation));
+	if(m_current && drawable.sprite == m_sprite && drawable.basis == m_current->basis) {
+		if(offset == m_offset) return false;
+		m_offset = offset;
+		return true;
+	}
+
+	auto [it, inserted] = m_frames.try_emplace(drawable.sprite);
+	Frame& frame = it->second;
+	if(inserted || frame.basis != drawable.basis) {
+		frame.basis = drawable.basis;
+		transformSpriteMask(SpriteAtlas::getMask(drawable.sprite), SpriteAtlas::getSprite(drawable.sprite), drawable.basis, frame.rects);
+		++m_transforms;
+	}
+
+	m_current = &frame;
+	m_sprite = drawable.sprite;
+	m_offset = offset;
+	return true;
+}
+
+std::span<const IntBoundingBox> SpriteRegion::getRects() const {
+	if(!m_current) return {};
+	return m_current->rects;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "atlas/baked_atlas.hpp"
+#include "math.hpp"
+#include "physics/bounding_box.hpp"
+#include "sprite.hpp"
+#include "sprite_drawable.hpp"
+
+// Opaque pixels of a sprite as horizontal runs, in pixels of the untrimmed source image
+// Consecutive rows with the same runs are merged, so a run covers every row from top to bottom
+struct MaskRun {
+	uint16_t begin;
+	uint16_t end;
+	uint16_t top;
+	uint16_t bottom;
+};
+
+// Appends the runs of pixels that pass the alpha test, the page has to be the one the sprite is on
+void buildSpriteMask(const BakedPageView& page, const Sprite& sprite, std::vector<MaskRun>& runs);
+// Places the runs like the drawable places its quad but without the translation, every run becomes the bounds of its transformed rect
+void transformSpriteMask(std::span<const MaskRun> runs, const Sprite& sprite, const glm::vec4& basis, std::vector<IntBoundingBox>& rects);
+
+// Screen region covered by the opaque pixels of a drawable
+// Rects are kept for every sprite the drawable showed, so they are only transformed again when the basis changes
+// Moving the drawable just moves the offset of the rects
+class SpriteRegion {
+public:
+	// Returns whether the region changed
+	bool update(const SpriteDrawable& drawable);
+
+	// Relative to the offset
+	[[nodiscard]] std::span<const IntBoundingBox> getRects() const;
+	[[nodiscard]] glm::ivec2 getOffset() const { return m_offset; }
+	[[nodiscard]] size_t getTransformCount() const { return m_transforms; }
+
+private:
+	struct Frame {
+		glm::vec4 basis = glm::vec4(0.0f);
+		std::vector<IntBoundingBox> rects;
+	};
+
+private:
+	std::unordered_map<uint16_t, Frame> m_frames;
+	const Frame* m_current = nullptr;
+	uint16_t m_sprite = 0;
+	glm::ivec2 m_offset = glm::ivec2(0);
+	size_t m_transforms = 0;
+};
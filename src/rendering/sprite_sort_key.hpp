@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+
+// Higher layers are drawn on top of lower ones, no matter which state their sprites need
+enum class SpriteLayer : uint8_t {
+	Background,
+	World,
+	Foreground,
+	Ui,
+	Count,
+};
+
+// Every pass has its own blend state
+enum class SpritePass : uint8_t {
+	AlphaTested,
+	Count,
+};
+
+// Every material has its own shaders
+enum class SpriteMaterial : uint8_t {
+	Default,
+	Count,
+};
+
+// Where a sprite goes in the draw order, sprites are drawn in ascending order of their packed 64 bit keys
+// From the most significant bits: layer 8, pass 4, material 12, atlas page 8, depth 32
+// Within a layer sprites are grouped by state before depth, so the depth only orders sprites that are drawn with the same state
+struct SpriteSortKey {
+	constexpr static unsigned LayerShift = 56;
+	constexpr static unsigned PassShift = 52;
+	constexpr static unsigned MaterialShift = 40;
+	constexpr static unsigned PageShift = 32;
+
+	SpriteLayer layer = SpriteLayer::World;
+	SpritePass pass = SpritePass::AlphaTested;
+	SpriteMaterial material = SpriteMaterial::Default;
+	uint32_t depth = 0;
+
+	[[nodiscard]] constexpr uint64_t pack(unsigned page) const {
+		return (uint64_t(layer) << LayerShift) | (uint64_t(pass) << PassShift) | (uint64_t(material) << MaterialShift) |
+		       (uint64_t(page & 0xff) << PageShift) | depth;
+	}
+
+	// The part of a packed key that needs a state change, the page is bound separately
+	[[nodiscard]] constexpr static uint32_t getState(uint64_t key) { return uint32_t(key >> MaterialShift) & 0xffff; }
+	[[nodiscard]] constexpr static SpriteLayer getLayer(uint64_t key) { return SpriteLayer(key >> LayerShift); }
+	[[nodiscard]] constexpr static SpritePass getPass(uint64_t key) { return SpritePass((key >> PassShift) & 0xf); }
+	[[nodiscard]] constexpr static SpriteMaterial getMaterial(uint64_t key) { return SpriteMaterial((key >> MaterialShift) & 0xfff); }
+	[[nodiscard]] constexpr static unsigned getPage(uint64_t key) { return unsigned(key >> PageShift) & 0xff; }
+};
@@ -0,0 +1,48 @@
+#include "sprite_sorter.hpp"
+
+#include <cassert>
+
+void SpriteSorter::sort(std::vector<uint64_t>& keys, std::vector<SpriteDrawable>& drawables) {
+	assert(keys.size() == drawables.size());
+	m_lastPassCount = 0;
+
+	// Already sorted is the common case, a frame usually draws the same sprites in the same order as the last one
+	bool sorted = true;
+	for(size_t i = 1; i < keys.size() && sorted; ++i) sorted = keys[i - 1] <= keys[i];
+	if(sorted) return;
+
+	// All histograms are built in a single pass over the keys
+	for(auto& histogram : m_histograms) histogram.fill(0);
+	m_entries.resize(keys.size());
+	for(size_t i = 0; i < keys.size(); ++i) {
+		m_entries[i] = { .key = keys[i], .index = uint32_t(i) };
+		for(unsigned digit = 0; digit < DigitCount; ++digit) ++m_histograms[digit][(keys[i] >> (digit * DigitBits)) & (BucketCount - 1)];
+	}
+
+	m_scratch.resize(keys.size());
+	for(unsigned digit = 0; digit < DigitCount; ++digit) {
+		auto& histogram = m_histograms[digit];
+		unsigned shift = digit * DigitBits;
+
+		// When every key has the same byte here the pass would not move anything
+		if(histogram[(m_entries[0].key >> shift) & (BucketCount - 1)] == keys.size()) continue;
+
+		uint32_t offset = 0;
+		for(uint32_t& count : histogram) {
+			uint32_t bucketSize = count;
+			count = offset;
+			offset += bucketSize;
+		}
+
+		for(const Entry& entry : m_entries) m_scratch[histogram[(entry.key >> shift) & (BucketCount - 1)]++] = entry;
+		m_entries.swap(m_scratch);
+		++m_lastPassCount;
+	}
+
+	m_drawables.resize(drawables.size());
+	for(size_t i = 0; i < m_entries.size(); ++i) {
+		keys[i] = m_entries[i].key;
+		m_drawables[i] = drawables[m_entries[i].index];
+	}
+	drawables.swap(m_drawables);
+}
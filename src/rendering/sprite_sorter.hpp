@@ -0,0 +1,38 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "sprite_drawable.hpp"
+
+// Sorts sprites by their packed sort keys with an LSD radix sort over bytes
+// The sort is stable, so sprites with equal keys stay in the order they were added
+// Bytes that are the same in every key are skipped, in practice most of them are
+class SpriteSorter {
+public:
+	constexpr static unsigned DigitBits = 8;
+	constexpr static unsigned DigitCount = 64 / DigitBits;
+	constexpr static unsigned BucketCount = 1u << DigitBits;
+
+public:
+	// Sorts both vectors by the keys, they have to be the same size
+	void sort(std::vector<uint64_t>& keys, std::vector<SpriteDrawable>& drawables);
+
+	// Number of passes over the keys the last sort needed, at most DigitCount
+	[[nodiscard]] unsigned getLastPassCount() const { return m_lastPassCount; }
+
+private:
+	struct Entry {
+		uint64_t key;
+		uint32_t index;
+	};
+
+private:
+	std::array<std::array<uint32_t, BucketCount>, DigitCount> m_histograms = {};
+	std::vector<Entry> m_entries;
+	std::vector<Entry> m_scratch;
+	std::vector<SpriteDrawable> m_drawables;
+	unsigned m_lastPassCount = 0;
+};
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include "sprite.hpp"
+
+using SpriteId = uint16_t;
+
+// Sprites of the atlas json, parsed once at compile time and looked up by name through a perfect hash
+// Every name lands in its own slot, so a lookup is two hashes and one string compare, at compile time and at runtime
+template<size_t Count>
+class SpriteTable {
+public:
+	// Each bucket gets a seed that sends all of its names to free slots, with twice as many slots as names this is found quickly
+	constexpr static size_t BucketCount = std::bit_ceil(std::max<size_t>(Count / 2, 1));
+	constexpr static size_t SlotCount = std::bit_ceil(std::max<size_t>(Count * 2, 1));
+	constexpr static SpriteId EmptySlot = UINT16_MAX;
+	constexpr static size_t MaxBucketSize = 16;
+	constexpr static size_t MaxPages = 64;
+	static_assert(Count < EmptySlot, "Sprite ids have to fit in 16 bits");
+
+public:
+	static consteval SpriteTable parse(std::string_view json) {
+		SpriteTable table;
+		std::array<Fields, Count> fields = {};
+		std::array<unsigned, MaxPages> pageWidths = {};
+		std::array<unsigned, MaxPages> pageHeights = {};
+
+		// One pass over all keys, the keys in front of the first name belong to the atlas and every name starts the next sprite
+		// Every width in front of the first name starts the next page, older atlases only have the size of a single page
+		size_t sprite = Count;
+		for(size_t pos = json.find('"'); pos != std::string_view::npos;) {
+			size_t keyEnd = json.find('"', pos + 1);
+			std::string_view key = json.substr(pos + 1, keyEnd - pos - 1);
+
+			size_t valueStart = json.find_first_not_of(" \n\r\t", json.find(':', keyEnd) + 1);
+			size_t valueEnd = json[valueStart] == '"' ? json.find('"', ++valueStart)
+			                                          : json.find_first_not_of("1234567890abcdefghijklmnopqrstuvwxyz", valueStart);
+			std::string_view value = json.substr(valueStart, valueEnd - valueStart);
+			pos = json.find('"', valueEnd + 1);
+
+			if(key == "name") {
+				sprite = sprite == Count ? 0 : sprite + 1;
+				table.m_names[sprite] = value;
+			} else if(sprite == Count) {
+				if(key == "width") pageWidths[table.m_pageCount++] = readUnsigned(value);
+				if(key == "height") pageHeights[table.m_pageCount - 1] = readUnsigned(value);
+			} else {
+				readField(fields[sprite], key, value);
+			}
+		}
+
+		for(size_t i = 0; i < Count; ++i) {
+			const Fields& f = fields[i];
+			unsigned pageWidth = pageWidths[f.page];
+			unsigned pageHeight = pageHeights[f.page];
+			table.m_sprites[i] = Sprite(
+			    unsigned(i), f.page, f.x, f.y, f.width, f.height, pageWidth, pageHeight, f.rotated, f.trimX, f.trimY, f.sourceWidth, f.sourceHeight
+			);
+		}
+
+		table.buildHash();
+		return table;
+	}
+
+	// Every sprite entry has exactly one "name" key
+	static consteval size_t count(std::string_view json) {
+		size_t count = 0;
+		for(size_t pos = json.find(nameId); pos != std::string_view::npos; pos = json.find(nameId, pos + 1)) ++count;
+		return count;
+	}
+
+	[[nodiscard]] constexpr std::optional<SpriteId> find(std::string_view name) const {
+		uint32_t seed = m_seeds[hash(name, 0) & (BucketCount - 1)];
+		SpriteId id = m_slots[hash(name, seed) & (SlotCount - 1)];
+		if(id == EmptySlot || m_names[id] != name) return std::nullopt;
+		return id;
+	}
+
+	[[nodiscard]] constexpr const Sprite& getSprite(SpriteId id) const { return m_sprites[id]; }
+	[[nodiscard]] constexpr std::string_view getName(SpriteId id) const { return m_names[id]; }
+	[[nodiscard]] constexpr const std::array<Sprite, Count>& getSprites() const { return m_sprites; }
+	[[nodiscard]] constexpr size_t getPageCount() const { return m_pageCount; }
+
+private:
+	constexpr static std::string_view nameId = "\"name\"";
+
+	struct Fields {
+		unsigned page = 0;
+		unsigned x = 0;
+		unsigned y = 0;
+		unsigned width = 0;
+		unsigned height = 0;
+		bool rotated = false;
+		unsigned trimX = 0;
+		unsigned trimY = 0;
+		unsigned sourceWidth = 0;
+		unsigned sourceHeight = 0;
+	};
+
+	// FNV-1a with a final mix, since the slot is taken from the low bits
+	static constexpr uint32_t hash(std::string_view str, uint32_t seed) {
+		uint32_t h = 2166136261u ^ (seed * 0x9e3779b9u);
+		for(char c : str) h = (h ^ uint8_t(c)) * 16777619u;
+		h ^= h >> 16;
+		h *= 0x7feb352du;
+		h ^= h >> 15;
+		return h;
+	}
+
+	consteval void buildHash() {
+		m_slots.fill(EmptySlot);
+
+		std::array<size_t, Count> bucketOf = {};
+		std::array<size_t, BucketCount> bucketSizes = {};
+		for(size_t i = 0; i < Count; ++i) {
+			bucketOf[i] = hash(m_names[i], 0) & (BucketCount - 1);
+			++bucketSizes[bucketOf[i]];
+		}
+
+		// Names are grouped by bucket, large buckets are the hardest to place so they go first while most slots are still free
+		std::array<SpriteId, Count> order = {};
+		for(size_t i = 0; i < Count; ++i) order[i] = SpriteId(i);
+		std::ranges::sort(order, [&](SpriteId a, SpriteId b) {
+			if(bucketSizes[bucketOf[a]] != bucketSizes[bucketOf[b]]) return bucketSizes[bucketOf[a]] > bucketSizes[bucketOf[b]];
+			return bucketOf[a] < bucketOf[b];
+		});
+
+		for(size_t begin = 0; begin < Count;) {
+			size_t bucket = bucketOf[order[begin]];
+			size_t size = bucketSizes[bucket];
+
+			// With two names per bucket on average, a bucket that does not fit in here does not happen in practice
+			std::array<size_t, MaxBucketSize> slots = {};
+			for(uint32_t seed = 1;; ++seed) {
+				bool placed = true;
+				for(size_t i = 0; i < size && placed; ++i) {
+					slots[i] = hash(m_names[order[begin + i]], seed) & (SlotCount - 1);
+					placed = m_slots[slots[i]] == EmptySlot && std::find(slots.begin(), slots.begin() + i, slots[i]) == slots.begin() + i;
+				}
+				if(!placed) continue;
+
+				for(size_t i = 0; i < size; ++i) m_slots[slots[i]] = order[begin + i];
+				m_seeds[bucket] = seed;
+				break;
+			}
+
+			begin += size;
+		}
+	}
+
+	// Trimming and rotation are optional, atlases without them describe the whole source image
+	static consteval void readField(Fields& fields, std::string_view key, std::string_view value) {
+		if(key == "page") fields.page = readUnsigned(value);
+		if(key == "x") fields.x = readUnsigned(value);
+		if(key == "y") fields.y = readUnsigned(value);
+		if(key == "width") fields.width = readUnsigned(value);
+		if(key == "height") fields.height = readUnsigned(value);
+		if(key == "rotated") fields.rotated = value == "true";
+		if(key == "trimX") fields.trimX = readUnsigned(value);
+		if(key == "trimY") fields.trimY = readUnsigned(value);
+		if(key == "sourceWidth") fields.sourceWidth = readUnsigned(value);
+		if(key == "sourceHeight") fields.sourceHeight = readUnsigned(value);
+	}
+
+	static consteval unsigned readUnsigned(std::string_view str) {
+		unsigned value = 0;
+		for(char c : str) value = value * 10 + (c - '0');
+		return value;
+	}
+
+private:
+	std::array<Sprite, Count> m_sprites = {};
+	std::array<std::string_view, Count> m_names = {};
+	std::array<uint32_t, BucketCount> m_seeds = {};
+	std::array<SpriteId, SlotCount> m_slots = {};
+	size_t m_pageCount = 0;
+};
@@ -0,0 +1,150 @@
+#include "static_sprite_layer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "sprite_atlas.hpp"
+#include "transform_kernels.hpp"
+
+StaticSpriteLayer::Handle StaticSpriteLayer::add(const SpriteDrawable& drawable, SpriteSortKey key) {
+	Handle handle = m_nextHandle++;
+	std::lock_guard lock(m_mutex);
+	m_pendingEdits.push_back({ .handle = handle, .drawable = drawable, .key = key });
+	return handle;
+}
+
+void StaticSpriteLayer::remove(Handle handle) {
+	std::lock_guard lock(m_mutex);
+	m_pendingEdits.push_back({ .handle = handle, .drawable = std::nullopt, .key = {} });
+}
+
+void StaticSpriteLayer::update(ID3D11Device* device) {
+	{
+		std::lock_guard lock(m_mutex);
+		m_edits.swap(m_pendingEdits);
+	}
+
+	for(const Edit& edit : m_edits) apply(edit);
+	m_edits.clear();
+
+	// Chunks whose sprites were all removed are dropped, the last chunk takes the place of the dropped one and is checked next
+	for(uint32_t index = 0; index < uint32_t(m_chunks.size());) {
+		if(m_chunks[index].drawables.empty()) {
+			removeChunk(index);
+			continue;
+		}
+		if(m_chunks[index].dirty) rebuild(m_chunks[index], device);
+		++index;
+	}
+}
+
+void StaticSpriteLayer::apply(const Edit& edit) {
+	if(!edit.drawable) {
+		auto it = m_handleChunks.find(edit.handle);
+		if(it == m_handleChunks.end()) return;
+
+		// Order does not matter here, the chunk is sorted again when it is rebuilt
+		Chunk& chunk = m_chunks[it->second];
+		size_t index = size_t(std::ranges::find(chunk.handles, edit.handle) - chunk.handles.begin());
+		chunk.drawables[index] = chunk.drawables.back();
+		chunk.keys[index] = chunk.keys.back();
+		chunk.handles[index] = chunk.handles.back();
+		chunk.drawables.pop_back();
+		chunk.keys.pop_back();
+		chunk.handles.pop_back();
+		chunk.dirty = true;
+
+		m_handleChunks.erase(it);
+		--m_stats.sprites;
+		return;
+	}
+
+	if(edit.drawable->sprite >= SpriteAtlas::getSprites().size()) return;
+
+	glm::ivec2 cell = glm::ivec2(glm::floor(edit.drawable->translation / ChunkSize));
+	uint64_t cellKey = (uint64_t(edit.key.layer) << 56) | (uint64_t(uint32_t(cell.x) & 0xfffffff) << 28) | (uint32_t(cell.y) & 0xfffffff);
+
+	auto [it, inserted] = m_chunkLookup.try_emplace(cellKey, uint32_t(m_chunks.size()));
+	if(inserted) {
+		Chunk& chunk = m_chunks.emplace_back();
+		chunk.layer = edit.key.layer;
+		chunk.cell = cellKey;
+		++m_stats.chunks;
+	}
+
+	Chunk& chunk = m_chunks[it->second];
+	chunk.drawables.push_back(*edit.drawable);
+	chunk.keys.push_back(edit.key.pack(SpriteAtlas::getSprite(edit.drawable->sprite).getPage()));
+	chunk.handles.push_back(edit.handle);
+	chunk.dirty = true;
+
+	m_handleChunks[edit.handle] = it->second;
+	++m_stats.sprites;
+}
+
+void StaticSpriteLayer::rebuild(Chunk& chunk, ID3D11Device* device) {
+	chunk.dirty = false;
+	chunk.runs.clear();
+	chunk.instanceBuffer.Reset();
+	if(chunk.drawables.empty()) return;
+
+	// The sorted copies are written back in place, so rebuilding does not allocate once the scratch vectors are large enough
+	m_order.resize(chunk.drawables.size());
+	std::iota(m_order.begin(), m_order.end(), 0u);
+	std::ranges::stable_sort(m_order, {}, [&](uint32_t i) { return chunk.keys[i]; });
+
+	m_sortedDrawables.clear();
+	m_sortedKeys.clear();
+	m_sortedHandles.clear();
+	for(uint32_t i : m_order) {
+		m_sortedDrawables.push_back(chunk.drawables[i]);
+		m_sortedKeys.push_back(chunk.keys[i]);
+		m_sortedHandles.push_back(chunk.handles[i]);
+	}
+	std::ranges::copy(m_sortedDrawables, chunk.drawables.begin());
+	std::ranges::copy(m_sortedKeys, chunk.keys.begin());
+	std::ranges::copy(m_sortedHandles, chunk.handles.begin());
+
+	m_bounds.resize(chunk.drawables.size());
+	transform_kernels::computeQuadBounds(chunk.drawables, m_bounds);
+	BoundingBox merged = transform_kernels::mergeBounds(m_bounds);
+	chunk.min = merged.min;
+	chunk.max = merged.max;
+
+	for(uint32_t i = 0; i < uint32_t(chunk.keys.size()); ++i) {
+		if(!chunk.runs.empty() && chunk.runs.back().key >> SpriteSortKey::PageShift == chunk.keys[i] >> SpriteSortKey::PageShift) {
+			++chunk.runs.back().count;
+		} else {
+			chunk.runs.push_back({ .key = chunk.keys[i], .first = i, .count = 1 });
+		}
+	}
+
+	if(!device) return;
+
+	D3D11_BUFFER_DESC bufferDesc = {};
+	bufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	bufferDesc.ByteWidth = UINT(sizeof(SpriteDrawable) * chunk.drawables.size());
+	bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+
+	D3D11_SUBRESOURCE_DATA bufferData = {};
+	bufferData.pSysMem = chunk.drawables.data();
+
+	handleFatalError(
+	    device->CreateBuffer(&bufferDesc, &bufferData, chunk.instanceBuffer.GetAddressOf()), "Could not create a static instance buffer"
+	);
+	++m_stats.uploads;
+}
+
+void StaticSpriteLayer::removeChunk(uint32_t index) {
+	m_chunkLookup.erase(m_chunks[index].cell);
+
+	uint32_t last = uint32_t(m_chunks.size() - 1);
+	if(index != last) {
+		m_chunks[index] = std::move(m_chunks[last]);
+		m_chunkLookup[m_chunks[index].cell] = index;
+		for(Handle handle : m_chunks[index].handles) m_handleChunks[handle] = index;
+	}
+	m_chunks.pop_back();
+	--m_stats.chunks;
+}
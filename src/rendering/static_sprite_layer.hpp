@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "math.hpp"
+#include "physics/bounding_box.hpp"
+#include "platform.hpp"
+#include "sprite_drawable.hpp"
+#include "sprite_sort_key.hpp"
+
+// Sprites that never move, like props and scenery, are kept on the GPU instead of being sent with every frame
+// They are grouped into chunks by layer and position, each chunk has an immutable instance buffer that is only rebuilt when its sprites change
+// Drawing a chunk that is not visible on a surface is skipped entirely
+class StaticSpriteLayer {
+public:
+	using Handle = uint32_t;
+
+	// Edge length of the square area a chunk covers, sprites belong to the chunk their center is in
+	constexpr static float ChunkSize = 512.0f;
+
+	// Sprites of a chunk with the same state and atlas page, each one is a single instanced draw
+	struct Run {
+		uint64_t key;
+		uint32_t first;
+		uint32_t count;
+	};
+
+	struct Chunk {
+		SpriteLayer layer = SpriteLayer::World;
+		// Key of the chunk in the lookup, made from the layer and the cell
+		uint64_t cell = 0;
+		// Bounds of all sprite quads in the chunk, they can reach into the neighbouring chunks
+		glm::vec2 min = glm::vec2(0.0f);
+		glm::vec2 max = glm::vec2(0.0f);
+		// Sorted by key, this is the content of the instance buffer
+		std::vector<SpriteDrawable> drawables;
+		std::vector<uint64_t> keys;
+		std::vector<Handle> handles;
+		std::vector<Run> runs;
+		ComPtr<ID3D11Buffer> instanceBuffer;
+		bool dirty = false;
+
+		[[nodiscard]] bool overlaps(glm::vec2 areaMin, glm::vec2 areaMax) const {
+			return !drawables.empty() && min.x < areaMax.x && max.x > areaMin.x && min.y < areaMax.y && max.y > areaMin.y;
+		}
+	};
+
+	struct Stats {
+		size_t sprites = 0;
+		size_t chunks = 0;
+		size_t uploads = 0;
+	};
+
+public:
+	// Can be called from any thread, the changes show up once the render thread calls update
+	Handle add(const SpriteDrawable& drawable, SpriteSortKey key = {});
+	void remove(Handle handle);
+
+	// Applies the pending changes and rebuilds the chunks that changed, without a device only the sprites are kept for the CPU rasterizer
+	void update(ID3D11Device* device);
+
+	// Only valid on the render thread
+	[[nodiscard]] std::span<const Chunk> getChunks() const { return m_chunks; }
+	[[nodiscard]] const Stats& getStats() const { return m_stats; }
+
+private:
+	struct Edit {
+		Handle handle;
+		// Empty for removals
+		std::optional<SpriteDrawable> drawable;
+		SpriteSortKey key;
+	};
+
+private:
+	void apply(const Edit& edit);
+	void rebuild(Chunk& chunk, ID3D11Device* device);
+	void removeChunk(uint32_t index);
+
+private:
+	std::atomic<Handle> m_nextHandle = 0;
+	std::mutex m_mutex;
+	std::vector<Edit> m_pendingEdits;
+
+	std::vector<Edit> m_edits;
+	std::vector<Chunk> m_chunks;
+	// Chunk index by layer and cell, and by handle
+	std::unordered_map<uint64_t, uint32_t> m_chunkLookup;
+	std::unordered_map<Handle, uint32_t> m_handleChunks;
+	Stats m_stats;
+
+	// Scratch memory of rebuild
+	std::vector<uint32_t> m_order;
+	std::vector<SpriteDrawable> m_sortedDrawables;
+	std::vector<uint64_t> m_sortedKeys;
+	std::vector<Handle> m_sortedHandles;
+	std::vector<BoundingBox> m_bounds;
+};
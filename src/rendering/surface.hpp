@@ -2,6 +2,7 @@
 
 #include <unordered_map>
 
+#include "affine2d.hpp"
 #include "math.hpp"
 #include "platform.hpp"
 
@@ -43,14 +44,20 @@ public:
 
 	[[nodiscard]] IDCompositionTarget* getTarget() const { return m_target.Get(); }
 	[[nodiscard]] IDCompositionVisual* getVisual() const { return m_visual.Get(); }
-	[[nodiscard]] glm::mat4 getProjectionMatrix() const {
+	// Maps desktop pixels to clip space, the y axis points up in clip space
+	[[nodiscard]] Affine2D getProjection() const {
 		glm::vec2 p = getPosition();
 		glm::vec2 s = getDimensions();
+		return Affine2D::translate(glm::vec2(-1.0f, 1.0f)) * Affine2D::scale(glm::vec2(2.0f / s.x, -2.0f / s.y)) * Affine2D::translate(-p);
+	}
+	// Laid out for mul(position, matrix) in the shaders
+	[[nodiscard]] glm::mat4 getProjectionMatrix() const {
+		Affine2D projection = getProjection();
 
 		// clang-format off
 		return glm::mat4(
-			+2.0f / s.x, 0.0f, 0.0f, -1.0f - (2.0f * p.x / s.x),
-			0.0f, -2.0f / s.y, 0.0f, +1.0f + (2.0f * p.y / s.y),
+			projection.x.x, projection.y.x, 0.0f, projection.translation.x,
+			projection.x.y, projection.y.y, 0.0f, projection.translation.y,
 			0.0f, 0.0f, 1.0f, 0.0f,
 			0.0f, 0.0f, 0.0f, 1.0f
 		);
@@ -1,4 +1,10 @@
 #include "surface_manager.hpp"
+
+#include <shellapi.h>
+
+#include <algorithm>
+#include <climits>
+
 #include "graphics_context.hpp"
 
 SurfaceManager* SurfaceManager::s_instance = nullptr;
@@ -15,6 +21,10 @@ static LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPara
 }
 
 static LRESULT CALLBACK ClickWndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+	bool keyMessage = msg >= WM_KEYFIRST && msg <= WM_KEYLAST;
+	bool mouseMessage = msg >= WM_MOUSEFIRST && msg <= WM_MOUSELAST;
+	if(keyMessage || mouseMessage || msg == WM_SETFOCUS || msg == WM_KILLFOCUS) SurfaceManager::getInstance().getFrameScheduler().wake();
+
 	switch(msg) {
 	case WindowMessageSetRegion:
 		SetWindowRgn(hWnd, reinterpret_cast<HRGN>(wParam), false); // NOLINT
@@ -37,6 +47,15 @@ static LRESULT CALLBACK ClickWndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM
 	return 0;
 }
 
+// Windows being moved, resized, shown or hidden change the physics, so the frame rate goes back up right away
+// Child windows and everything else about a window, like its title, do not change the physics
+static void CALLBACK
+    windowEventHook(HWINEVENTHOOK /* hook */, DWORD /* event */, HWND hWnd, LONG idObject, LONG idChild, DWORD /* thread */, DWORD /* time */) {
+	if(!hWnd || idObject != OBJID_WINDOW || idChild != CHILDID_SELF) return;
+	if(GetAncestor(hWnd, GA_ROOT) != hWnd) return;
+	SurfaceManager::getInstance().getFrameScheduler().wake();
+}
+
 static void initializeWindowClasses(HINSTANCE hInstance) {
 	WNDCLASS windowClass = {};
 	windowClass.style = CS_HREDRAW | CS_VREDRAW;
@@ -139,6 +158,15 @@ void SurfaceManager::initialize(HINSTANCE hInstance) {
 
 	EnumDisplayMonitors(nullptr, nullptr, createScreenSurface, reinterpret_cast<LPARAM>(hInstance));
 	GraphicsContext::getInstance().getCompositionDevice()->Commit();
+
+	// Every event in the ranges is sent to the hook system wide, so they only cover what can change the window layout
+	constexpr DWORD hookFlags = WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS;
+	s_instance->m_eventHooks = {
+		SetWinEventHook(EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND, nullptr, windowEventHook, 0, 0, hookFlags),
+		SetWinEventHook(EVENT_SYSTEM_MINIMIZESTART, EVENT_SYSTEM_MINIMIZEEND, nullptr, windowEventHook, 0, 0, hookFlags),
+		SetWinEventHook(EVENT_OBJECT_SHOW, EVENT_OBJECT_HIDE, nullptr, windowEventHook, 0, 0, hookFlags),
+		SetWinEventHook(EVENT_OBJECT_LOCATIONCHANGE, EVENT_OBJECT_LOCATIONCHANGE, nullptr, windowEventHook, 0, 0, hookFlags),
+	};
 }
 
 void SurfaceManager::close() {
@@ -147,7 +175,8 @@ void SurfaceManager::close() {
 	s_instance = nullptr;
 }
 
-SurfaceManager::SurfaceManager(HINSTANCE hInstance) : m_clickWindow(nullptr), m_rgn(nullptr), m_vScreenBounds{} {
+SurfaceManager::SurfaceManager(HINSTANCE hInstance) :
+    m_clickWindow(nullptr), m_rgn(nullptr), m_vScreenBounds{} {
 	initializeWindowClasses(hInstance);
 
 	int vScreenX = GetSystemMetrics(SM_XVIRTUALSCREEN);
@@ -159,6 +188,8 @@ SurfaceManager::SurfaceManager(HINSTANCE hInstance) : m_clickWindow(nullptr), m_
 }
 
 SurfaceManager::~SurfaceManager() {
+	for(HWINEVENTHOOK hook : m_eventHooks)
+		if(hook) UnhookWinEvent(hook);
 	CloseWindow(m_clickWindow);
 }
 
@@ -173,12 +204,50 @@ Surface* SurfaceManager::getSurface(HWND window) {
 	return it->second;
 }
 
-void SurfaceManager::pushClickableRegion(const BoundingBox region) {
-	m_rgn = CreateRectRgn(
-	    int(region.min.x - m_vScreenBounds.min.x),
-	    int(region.min.y - m_vScreenBounds.min.y),
-	    int(region.max.x - m_vScreenBounds.min.x),
-	    int(region.max.y - m_vScreenBounds.min.y)
-	);
+bool SurfaceManager::isDesktopCovered() const {
+	QUERY_USER_NOTIFICATION_STATE state;
+	if(FAILED(SHQueryUserNotificationState(&state))) return false;
+	if(state != QUNS_RUNNING_D3D_FULL_SCREEN && state != QUNS_BUSY && state != QUNS_PRESENTATION_MODE) return false;
+
+	// The state only tells that some screen shows a fullscreen application, which is the foreground window
+	// Only when that window covers every screen can nothing be seen, with more screens the others still show the pets
+	HWND foreground = GetForegroundWindow();
+	RECT rect;
+	if(!foreground || !GetWindowRect(foreground, &rect)) return false;
+	return std::ranges::all_of(m_screenSurfaces, [&rect](const auto& surface) {
+		glm::ivec2 min = surface->getPosition();
+		glm::ivec2 max = min + glm::ivec2(surface->getDimensions());
+		return rect.left <= min.x && rect.top <= min.y && rect.right >= max.x && rect.bottom >= max.y;
+	});
+}
+
+void SurfaceManager::pushClickableRegion(std::span<const IntBoundingBox> rects, glm::ivec2 offset) {
+	// The region is built from a list of rects, offset into the coordinates of the click window
+	glm::ivec2 origin = offset - glm::ivec2(m_vScreenBounds.min);
+	m_rgnData.resize(sizeof(RGNDATAHEADER) + (sizeof(RECT) * rects.size()));
+	auto* data = reinterpret_cast<RGNDATA*>(m_rgnData.data());
+	auto* rectData = reinterpret_cast<RECT*>(data->Buffer);
+
+	glm::ivec2 boundsMin = glm::ivec2(INT_MAX);
+	glm::ivec2 boundsMax = glm::ivec2(INT_MIN);
+	for(size_t i = 0; i < rects.size(); ++i) {
+		glm::ivec2 min = rects[i].min + origin;
+		glm::ivec2 max = rects[i].max + origin;
+		rectData[i] = { .left = min.x, .top = min.y, .right = max.x, .bottom = max.y };
+		boundsMin = glm::min(boundsMin, min);
+		boundsMax = glm::max(boundsMax, max);
+	}
+
+	data->rdh.dwSize = sizeof(RGNDATAHEADER);
+	data->rdh.iType = RDH_RECTANGLES;
+	data->rdh.nCount = DWORD(rects.size());
+	data->rdh.nRgnSize = DWORD(sizeof(RECT) * rects.size());
+	data->rdh.rcBound = {};
+	if(!rects.empty()) data->rdh.rcBound = { .left = boundsMin.x, .top = boundsMin.y, .right = boundsMax.x, .bottom = boundsMax.y };
+
+	m_rgn = ExtCreateRegion(nullptr, DWORD(m_rgnData.size()), data);
+	if(!m_rgn) return;
+
+	m_canPushRegion = false;
 	PostMessage(m_clickWindow, WindowMessageSetRegion, reinterpret_cast<WPARAM>(m_rgn), 0);
 }
@@ -1,10 +1,12 @@
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <memory>
 #include <span>
 #include <vector>
 
+#include "frame_scheduler.hpp"
 #include "input/input.hpp"
 #include "physics/bounding_box.hpp"
 #include "surface.hpp"
@@ -29,17 +31,24 @@ public:
 
 public:
 	[[nodiscard]] static SurfaceManager& getInstance();
+	// False while replaying headless, there are no windows then
+	[[nodiscard]] static bool isInitialized() { return s_instance != nullptr; }
 
 	[[nodiscard]] Surface* getSurface(HWND window);
 	[[nodiscard]] size_t getSurfaceCount() const { return m_surfaces.size(); }
 	[[nodiscard]] std::span<const std::unique_ptr<ScreenSurface>> getScreenSurfaces() const { return m_screenSurfaces; }
 
-	void pushClickableRegion(const BoundingBox region);
+	// The rects are in screen coordinates relative to the offset, they can overlap
+	void pushClickableRegion(std::span<const IntBoundingBox> rects, glm::ivec2 offset = glm::ivec2(0));
 	bool canPushClickableRegion() const { return m_canPushRegion; }
 	void consumeClickableRegion() { m_canPushRegion = true; }
 
+	// True while a fullscreen application (like a game or a presentation) covers every screen, other screens can still be seen otherwise
+	[[nodiscard]] bool isDesktopCovered() const;
+
 	BoundingBox getVirtualScreenBounds() { return m_vScreenBounds; }
 	Input& getMainInput() { return m_input; }
+	FrameScheduler& getFrameScheduler() { return m_frameScheduler; }
 
 private:
 	static SurfaceManager* s_instance;
@@ -49,6 +58,9 @@ private:
 	std::vector<std::unique_ptr<ScreenSurface>> m_screenSurfaces;
 	HWND m_clickWindow;
 	Input m_input;
+	FrameScheduler m_frameScheduler;
+	// Foreground changes, minimizing, showing and hiding, and moving windows
+	std::array<HWINEVENTHOOK, 4> m_eventHooks = {};
 
 	HRGN m_rgn;
 	std::atomic_bool m_canPushRegion = true;
@@ -0,0 +1,151 @@
+#include "text_cache.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <format>
+
+#include "logger.hpp"
+
+const TextRun& TextCache::get(std::string_view text, const TextStyle& style) {
+	auto [it, inserted] = m_entries.try_emplace(hash(text, style));
+	Entry& entry = it->second;
+	entry.lastUsed = m_frame;
+
+	if(!inserted && entry.style == style && entry.text == text) {
+		++m_stats.hits;
+		return entry.run;
+	}
+
+	entry.text = text;
+	entry.style = style;
+	entry.run = layout(text, style);
+	++m_stats.layouts;
+	return entry.run;
+}
+
+const TextRun& TextCache::draw(
+    std::string_view text, const TextStyle& style, glm::vec2 position, SpriteSortKey key, std::vector<SpriteDrawable>& drawables,
+    std::vector<uint64_t>& keys
+) {
+	const TextRun& run = get(text, style);
+	for(SpriteDrawable glyph : run.glyphs) {
+		glyph.translation += position;
+		drawables.push_back(glyph);
+		keys.push_back(key.pack(SpriteAtlas::getSprite(glyph.sprite).getPage()));
+	}
+	return run;
+}
+
+void TextCache::endFrame() {
+	++m_frame;
+	if(m_frame % EvictionInterval != 0 || m_frame < MaxUnusedFrames) return;
+
+	m_stats.evictions += std::erase_if(m_entries, [&](const auto& item) { return item.second.lastUsed < m_frame - MaxUnusedFrames; });
+}
+
+TextRun TextCache::layout(std::string_view text, const TextStyle& style) {
+	const BitmapFont& font = *style.font;
+	TextRun run;
+
+	// Lines are laid out from the left and shifted once their width is known
+	float y = 0.0f;
+	size_t lineStart = 0;
+	float lineWidth = 0.0f;
+	float x = 0.0f;
+	auto endLine = [&]() {
+		if(style.align == TextAlign::Center) {
+			float shift = std::floor(lineWidth * 0.5f);
+			for(size_t i = lineStart; i < run.glyphs.size(); ++i) run.glyphs[i].translation.x -= shift;
+		}
+
+		run.size.x = std::max(run.size.x, lineWidth);
+		lineStart = run.glyphs.size();
+		lineWidth = 0.0f;
+		x = 0.0f;
+		y += float(font.getLineHeight()) * style.scale;
+	};
+
+	for(char c : text) {
+		if(c == '\n') {
+			endLine();
+			continue;
+		}
+
+		const BitmapFont::Glyph& glyph = font.getGlyph(c);
+		if(glyph.visible) {
+			glm::vec2 size = glm::vec2(glyph.width, glyph.height) * style.scale;
+			SpriteDrawable& drawable = run.glyphs.emplace_back();
+			drawable.basis = glm::vec4(size.x, 0.0f, 0.0f, size.y);
+			drawable.translation = glm::vec2(x, y) + size * 0.5f;
+			drawable.sprite = glyph.sprite;
+			lineWidth = std::max(lineWidth, x + size.x);
+		}
+		x += float(glyph.advance) * style.scale;
+	}
+
+	endLine();
+	run.size.y = y;
+	return run;
+}
+
+uint64_t TextCache::hash(std::string_view text, const TextStyle& style) {
+	// FNV-1a over the text, followed by the style
+	uint64_t h = 14695981039346656037ull;
+	auto mix = [&](uint64_t value) { h = (h ^ value) * 1099511628211ull; };
+	for(char c : text) mix(uint8_t(c));
+	mix(uint64_t(std::bit_cast<uintptr_t>(style.font)));
+	mix(std::bit_cast<uint32_t>(style.scale));
+	mix(uint64_t(style.align));
+	return h;
+}
+
+#ifndef SHIPPING
+void TextCache::runBenchmark(unsigned labelCount, unsigned frameCount) {
+	using Clock = std::chrono::steady_clock;
+	using Milliseconds = std::chrono::duration<double, std::milli>;
+
+	constexpr std::string_view moods[] = { "happy", "hungry", "sleepy", "bored", "playful" };
+	std::vector<std::string> labels;
+	for(unsigned i = 0; i < labelCount; ++i) labels.push_back(std::format("Pet #{}\n{}", i, moods[i % std::size(moods)]));
+
+	TextCache cache;
+	TextStyle style = { .align = TextAlign::Center };
+	std::vector<SpriteDrawable> drawables;
+	std::vector<uint64_t> keys;
+
+	auto drawFrame = [&]() {
+		drawables.clear();
+		keys.clear();
+		for(unsigned i = 0; i < labelCount; ++i) {
+			glm::vec2 position = glm::vec2(float(i % 64) * 60.0f, float(i / 64) * 24.0f);
+			cache.draw(labels[i], style, position, {}, drawables, keys);
+		}
+		cache.endFrame();
+	};
+
+	Clock::time_point firstStart = Clock::now();
+	drawFrame();
+	double firstMilliseconds = Milliseconds(Clock::now() - firstStart).count();
+
+	// Every allocation after the first frame would either be a new layout or a vector that had to grow
+	size_t layouts = cache.getStats().layouts;
+	const SpriteDrawable* drawableData = drawables.data();
+	const uint64_t* keyData = keys.data();
+
+	Clock::time_point cachedStart = Clock::now();
+	for(unsigned frame = 0; frame < frameCount; ++frame) drawFrame();
+	double cachedMilliseconds = Milliseconds(Clock::now() - cachedStart).count() / double(std::max(frameCount, 1u));
+
+	logger::log(
+	    "Text benchmark: {} labels, {} glyphs, first frame {:.3f} ms, cached {:.3f} ms/frame, {} layouts and {} reallocations after the first frame",
+	    labelCount,
+	    drawables.size(),
+	    firstMilliseconds,
+	    cachedMilliseconds,
+	    cache.getStats().layouts - layouts,
+	    int(drawables.data() != drawableData) + int(keys.data() != keyData)
+	);
+}
+#endif
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "bitmap_font.hpp"
+#include "math.hpp"
+#include "sprite_drawable.hpp"
+#include "sprite_sort_key.hpp"
+
+enum class TextAlign : uint8_t {
+	Left,
+	Center,
+};
+
+struct TextStyle {
+	const BitmapFont* font = &fonts::Small;
+	// Whole numbers keep the glyphs pixel exact
+	float scale = 1.0f;
+	TextAlign align = TextAlign::Left;
+
+	bool operator==(const TextStyle&) const = default;
+};
+
+// Glyph sprites of a laid out string, relative to the top left corner of the text or the top center for centered text
+struct TextRun {
+	std::vector<SpriteDrawable> glyphs;
+	glm::vec2 size = glm::vec2(0.0f);
+};
+
+// Lays out every string and style once and keeps the result while it is drawn, so unchanged labels cost a lookup and a copy per frame
+// Drawing cached text does not allocate once the output vectors have grown to their final size
+class TextCache {
+public:
+	// Runs that were not drawn for this many frames are dropped, the check only runs every few frames
+	constexpr static uint64_t MaxUnusedFrames = 300;
+	constexpr static uint64_t EvictionInterval = 64;
+
+	struct Stats {
+		size_t layouts = 0;
+		size_t hits = 0;
+		size_t evictions = 0;
+	};
+
+public:
+	// The run stays valid until the next endFrame
+	[[nodiscard]] const TextRun& get(std::string_view text, const TextStyle& style);
+	// Appends the glyphs of the text at the position, every glyph gets the sort key
+	const TextRun& draw(
+	    std::string_view text, const TextStyle& style, glm::vec2 position, SpriteSortKey key, std::vector<SpriteDrawable>& drawables,
+	    std::vector<uint64_t>& keys
+	);
+	void endFrame();
+
+	[[nodiscard]] static TextRun layout(std::string_view text, const TextStyle& style);
+	[[nodiscard]] const Stats& getStats() const { return m_stats; }
+
+#ifndef SHIPPING
+	// Draws the labels for a number of frames and logs how long the first and the cached frames take
+	static void runBenchmark(unsigned labelCount, unsigned frameCount);
+#endif
+
+private:
+	struct Entry {
+		std::string text;
+		TextStyle style;
+		TextRun run;
+		uint64_t lastUsed = 0;
+	};
+
+private:
+	[[nodiscard]] static uint64_t hash(std::string_view text, const TextStyle& style);
+
+private:
+	// Keyed by the hash of text and style, a collision replaces the older entry
+	std::unordered_map<uint64_t, Entry> m_entries;
+	uint64_t m_frame = 0;
+	Stats m_stats;
+};
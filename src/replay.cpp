@@ -0,0 +1,132 @@
+#include "replay.hpp"
+
+#include <cstring>
+#include <system_error>
+
+static_assert(sizeof(ReplayFrameHeader) == 32, "Replay frames should not contain padding");
+static_assert(sizeof(ReplayEvent) == 16, "Replay events should not contain padding");
+static_assert(sizeof(ReplayWindow) == 20, "Replay windows should not contain padding");
+
+template<typename T>
+static void append(std::vector<std::byte>& data, const T& value) {
+	size_t offset = data.size();
+	data.resize(offset + sizeof(T));
+	std::memcpy(data.data() + offset, &value, sizeof(T));
+}
+
+template<typename T>
+static bool read(std::span<const std::byte>& data, T& value) {
+	if(data.size() < sizeof(T)) return false;
+	std::memcpy(&value, data.data(), sizeof(T));
+	data = data.subspan(sizeof(T));
+	return true;
+}
+
+std::optional<ReplayRecorder> ReplayRecorder::create(const std::filesystem::path& path, const WindowPhysics& windowPhysics) {
+	std::ofstream stream(path, std::ios::binary);
+	if(!stream) return std::nullopt;
+
+	ReplayRecorder recorder(std::move(stream));
+	std::span<const BoundingBox> screenEdges = windowPhysics.getScreenEdges();
+	append(recorder.m_frame, ReplayHeader{ .screenEdgeCount = uint32_t(screenEdges.size()) });
+	for(const BoundingBox& edge : screenEdges) append(recorder.m_frame, edge);
+	recorder.m_stream.write(reinterpret_cast<const char*>(recorder.m_frame.data()), std::streamsize(recorder.m_frame.size())); // NOLINT
+	return recorder;
+}
+
+void ReplayRecorder::record(const Time& time, const Input& input, const WindowPhysics& windowPhysics, bool layoutChanged) {
+	// The first frame has nothing to be unchanged from
+	bool writeLayout = layoutChanged || m_frames == 0;
+	std::span<const Input::FrameEvent> events = input.getFrameEvents();
+
+	m_frame.clear();
+	append(
+	    m_frame,
+	    ReplayFrameHeader{
+	        .time = time.time(),
+	        .mousePos = input.getMousePos(),
+	        .deltaTime = time.deltaTime(),
+	        .eventCount = uint32_t(events.size()),
+	        .windowCount = writeLayout ? uint32_t(windowPhysics.getWindows().size()) : ReplayFrameHeader::LayoutUnchanged,
+	        .taskBarCount = writeLayout ? uint32_t(windowPhysics.getTaskBar().size()) : 0,
+	    }
+	);
+	for(const Input::FrameEvent& event : events)
+		append(m_frame, ReplayEvent{ .time = event.time, .button = event.button, .type = event.type, .value = event.value });
+	if(writeLayout) {
+		for(const WindowPhysics::Window& window : windowPhysics.getWindows())
+			append(m_frame, ReplayWindow{ .bbox = window.bbox, .ignore = window.ignore });
+		for(const BoundingBox& taskBar : windowPhysics.getTaskBar()) append(m_frame, taskBar);
+	}
+
+	m_stream.write(reinterpret_cast<const char*>(m_frame.data()), std::streamsize(m_frame.size())); // NOLINT
+	++m_frames;
+}
+
+std::optional<ReplayReader> ReplayReader::open(const std::filesystem::path& path) {
+	std::ifstream stream(path, std::ios::binary);
+	if(!stream) return std::nullopt;
+
+	ReplayReader reader;
+	std::error_code error;
+	reader.m_data.resize(std::filesystem::file_size(path, error));
+	if(error || !stream.read(reinterpret_cast<char*>(reader.m_data.data()), std::streamsize(reader.m_data.size()))) return std::nullopt; // NOLINT
+
+	std::span<const std::byte> data = reader.m_data;
+	ReplayHeader header;
+	if(!read(data, header)) return std::nullopt;
+	if(header.magic != ReplayHeader::Magic || header.version != ReplayHeader::Version) return std::nullopt;
+	if(data.size() / sizeof(BoundingBox) < header.screenEdgeCount) return std::nullopt;
+
+	reader.m_screenEdges.resize(header.screenEdgeCount);
+	for(BoundingBox& edge : reader.m_screenEdges)
+		if(!read(data, edge)) return std::nullopt;
+
+	reader.m_offset = reader.m_data.size() - data.size();
+	return reader;
+}
+
+bool ReplayReader::next() {
+	std::span<const std::byte> data = std::span<const std::byte>(m_data).subspan(m_offset);
+	ReplayFrameHeader frame;
+	if(!read(data, frame)) return false;
+
+	// Everything is read before anything is kept, a frame that was cut off ends the replay without changing the last one
+	// The counts are checked against what is left before anything is allocated for them
+	if(data.size() / sizeof(ReplayEvent) < frame.eventCount) return false;
+	std::vector<Input::FrameEvent> events(frame.eventCount);
+	for(Input::FrameEvent& event : events) {
+		ReplayEvent replayEvent;
+		if(!read(data, replayEvent)) return false;
+		event = { .time = replayEvent.time, .button = replayEvent.button, .type = replayEvent.type, .value = replayEvent.value };
+	}
+
+	if(frame.windowCount != ReplayFrameHeader::LayoutUnchanged) {
+		if(data.size() / sizeof(ReplayWindow) < frame.windowCount || data.size() / sizeof(BoundingBox) < frame.taskBarCount) return false;
+		std::vector<WindowPhysics::Window> windows(frame.windowCount);
+		for(WindowPhysics::Window& window : windows) {
+			ReplayWindow replayWindow;
+			if(!read(data, replayWindow)) return false;
+			window = { .bbox = replayWindow.bbox, .ignore = replayWindow.ignore != 0 };
+		}
+
+		std::vector<BoundingBox> taskBar(frame.taskBarCount);
+		for(BoundingBox& box : taskBar)
+			if(!read(data, box)) return false;
+
+		m_windows = std::move(windows);
+		m_taskBar = std::move(taskBar);
+	}
+
+	m_frame = frame;
+	m_events = std::move(events);
+	m_offset = m_data.size() - data.size();
+	++m_frames;
+	return true;
+}
+
+void ReplayReader::apply(Time& time, Input& input, WindowPhysics& windowPhysics) const {
+	time.set(m_frame.time, m_frame.deltaTime);
+	input.replay(m_events, m_frame.mousePos);
+	windowPhysics.setLayout(m_windows, m_taskBar);
+}
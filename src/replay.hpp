@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "input/input.hpp"
+#include "math.hpp"
+#include "physics/bounding_box.hpp"
+#include "physics/window_physics.hpp"
+#include "time.hpp"
+
+// A replay is the header and the screen edges, followed by one record per simulated frame
+// A frame is its header, its input events and, only when the windows moved since the frame before, the window layout
+struct ReplayHeader {
+	constexpr static uint32_t Magic = 0x594c5052; // "RPLY"
+	constexpr static uint32_t Version = 1;
+
+	uint32_t magic = Magic;
+	uint32_t version = Version;
+	uint32_t screenEdgeCount = 0;
+};
+
+struct ReplayFrameHeader {
+	constexpr static uint32_t LayoutUnchanged = UINT32_MAX;
+
+	double time = 0.0;
+	glm::vec2 mousePos = glm::vec2(0.0f);
+	float deltaTime = 0.0f;
+	uint32_t eventCount = 0;
+	// LayoutUnchanged when no layout follows the events
+	uint32_t windowCount = LayoutUnchanged;
+	uint32_t taskBarCount = 0;
+};
+
+struct ReplayEvent {
+	double time = 0.0;
+	InputButton button = InputButton::None;
+	Input::Event::Type type = Input::Event::Type::Button;
+	bool value = false;
+	uint16_t padding = 0;
+};
+
+struct ReplayWindow {
+	BoundingBox bbox;
+	uint32_t ignore = 0;
+};
+
+// Writes everything the simulation read from outside during every frame, so the session can be simulated again exactly
+class ReplayRecorder {
+public:
+	// Fails when the file can not be created, the screen edges of the window physics are written right away
+	[[nodiscard]] static std::optional<ReplayRecorder> create(const std::filesystem::path& path, const WindowPhysics& windowPhysics);
+
+	// Has to be called after the time, the input and the window physics were updated for the frame
+	void record(const Time& time, const Input& input, const WindowPhysics& windowPhysics, bool layoutChanged);
+
+	[[nodiscard]] size_t getFrameCount() const { return m_frames; }
+
+private:
+	explicit ReplayRecorder(std::ofstream stream) : m_stream(std::move(stream)) {}
+
+private:
+	std::ofstream m_stream;
+	// The frame is put together here so it is written in one go
+	std::vector<std::byte> m_frame;
+	size_t m_frames = 0;
+};
+
+// Steps through a recorded session, feeding the recorded frames into the clock, the input and the window physics in place of the real ones
+class ReplayReader {
+public:
+	// Reads the whole file, fails when it is not a replay of this version
+	[[nodiscard]] static std::optional<ReplayReader> open(const std::filesystem::path& path);
+
+	// Moves to the next frame, returns false at the end of the replay or when the rest of it is cut off
+	bool next();
+	// Sets up the frame that next moved to
+	void apply(Time& time, Input& input, WindowPhysics& windowPhysics) const;
+
+	[[nodiscard]] std::span<const BoundingBox> getScreenEdges() const { return m_screenEdges; }
+	[[nodiscard]] size_t getFrameCount() const { return m_frames; }
+
+private:
+	ReplayReader() = default;
+
+private:
+	std::vector<std::byte> m_data;
+	size_t m_offset = 0;
+	std::vector<BoundingBox> m_screenEdges;
+
+	ReplayFrameHeader m_frame;
+	std::vector<Input::FrameEvent> m_events;
+	// The layout stays until a frame changes it
+	std::vector<WindowPhysics::Window> m_windows;
+	std::vector<BoundingBox> m_taskBar;
+	size_t m_frames = 0;
+};
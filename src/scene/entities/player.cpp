@@ -1,11 +1,13 @@
 #include "player.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 
 #include "input/input_ids.hpp"
+#include "platform.hpp"
 #include "rendering/graphics_context.hpp"
 #include "rendering/sprite_atlas.hpp"
-#include "rendering/surface_manager.hpp"
 
 constexpr static float speed = 500.0f;
 constexpr static float friction = 18.0f;
@@ -32,7 +34,18 @@ constexpr static float gravity = 2.0f * jumpForce / jumpDuration;
 const static float duckJumpForce = std::sqrt(2.0f * gravity * duckJumpHeight); // sqrt isnt constexpr were cooked
 const static float slideJumpForce = std::sqrt(2.0f * gravity * slideJumpHeight);
 
-Player::Player(CharacterAnimations animations, const Input* input) :
+static unsigned findParameter(const StateMachineDefinition& animations, std::string_view name) {
+	std::optional<unsigned> parameter = animations.findParameter(name);
+	if(!parameter) fatalError("The player animation state machine is missing a parameter");
+	return *parameter;
+}
+
+// Buffers start counting when the button went down, not at the start of the frame that saw it
+static float getTimeSincePress(const Time& time, const InputAction& action) {
+	return std::max(float(time.time() - action.getPressTime()), 0.0f);
+}
+
+Player::Player(const StateMachineDefinition& animations, const Input* input) :
     m_input(input),
     m_movementInput(input ? input->getAxis1D(InputId_PlayerMovement) : nullptr),
     m_jumpInput(input ? input->getAction(InputId_PlayerJump) : nullptr),
@@ -45,15 +58,38 @@ Player::Player(CharacterAnimations animations, const Input* input) :
     m_jumpBuffer(0.0f),
     m_coyoteTime(0.0f),
     m_isDucked(false),
+    m_isActive(true),
     m_flipped(false),
-    m_animator(std::move(animations)),
-    m_squisher(0.25f, 5.0f, 14.0f, glm::vec2(0.0f, 0.5f)) {
-	constexpr Sprite clickAnim[] = { SpriteAtlas::get("mouse.png"), SpriteAtlas::get("mouse_left.png") };
-	m_clickAnimation = Animation(clickAnim, 24, 8); // todo: not hardcode this or sth
-
+    m_animations(&animations),
+    m_animationParameters({
+        .grounded = findParameter(animations, "grounded"),
+        .ducked = findParameter(animations, "ducked"),
+        .sliding = findParameter(animations, "sliding"),
+        .moving = findParameter(animations, "moving"),
+        .velocityY = findParameter(animations, "velocityY"),
+    }),
+    m_animation(AnimationSystem::InvalidHandle),
+    m_stateMachine(StateMachineSystem::InvalidHandle),
+    m_clickAnimation(AnimationSystem::InvalidHandle),
+    m_squash(SquashSystem::InvalidHandle) {
 	localPhysicsBounds = { .min = glm::vec2(-10.0f, 16.0f), .max = glm::vec2(10.0f, 48.0f) };
 }
 
+Player::~Player() {
+	if(!scene) return;
+	scene->getStateMachines().remove(m_stateMachine);
+	scene->getAnimations().remove(m_animation);
+	scene->getAnimations().remove(m_clickAnimation);
+	scene->getSquashes().remove(m_squash);
+}
+
+void Player::onAttach() {
+	m_animation = scene->getAnimations().add({ .clip = m_animations->states[m_animations->initialState].clip }, m_sprite);
+	m_stateMachine = scene->getStateMachines().add(*m_animations, m_animation);
+	m_clickAnimation = scene->getAnimations().add({ .clip = Clip::Mouse }, m_clickSprite);
+	m_squash = scene->getSquashes().add({ .amplitude = 0.25f, .frequency = 5.0f, .falloff = 14.0f, .origin = glm::vec2(0.0f, 0.5f) }, m_sprite);
+}
+
 void Player::setInput(const Input* input) {
 	m_input = input;
 	m_movementInput = input ? input->getAxis1D(InputId_PlayerMovement) : nullptr;
@@ -81,9 +117,9 @@ void Player::onUpdate(const Time& time) {
 	if(m_isDucked != (duck && grounded)) {
 		float intensity = slide ? 1.0f : 0.6f;
 		if(m_isDucked) {
-			m_squisher.squish(time, intensity);
+			scene->getSquashes().squish(m_squash, time, intensity);
 		} else {
-			m_squisher.squash(time, intensity);
+			scene->getSquashes().squash(m_squash, time, intensity);
 		}
 	}
 	m_isDucked = duck && grounded;
@@ -91,8 +127,8 @@ void Player::onUpdate(const Time& time) {
 	// buffering
 	if(m_isDucked && !slide) m_duckJumpBuffer = duckJumpBufferTime;
 	if(slide) m_slideJumpBuffer = slideJumpBufferTime;
-	if(duckPressed) m_slideBuffer = slideBufferTime;
-	if(jumpPressed) m_jumpBuffer = jumpBuffertime;
+	if(duckPressed) m_slideBuffer = slideBufferTime - getTimeSincePress(time, *m_duckInput);
+	if(jumpPressed) m_jumpBuffer = jumpBuffertime - getTimeSincePress(time, *m_jumpInput);
 	if(grounded) m_coyoteTime = coyoteTime;
 
 	// slide boost
@@ -115,7 +151,7 @@ void Player::onUpdate(const Time& time) {
 		}
 
 		m_velocity.y = -force;
-		m_squisher.squish(time, 2.5f);
+		scene->getSquashes().squish(m_squash, time, 2.5f);
 	}
 
 	// select physics constants based on state
@@ -147,59 +183,46 @@ void Player::onUpdate(const Time& time) {
 	} else if(inputDir > 0.0f) {
 		m_flipped = false;
 	}
-	if(m_flipped != prevFlipped) m_squisher.squish(time);
-
-	// select the correct animation for our bunny
-	if(grounded) {
-		if(m_isDucked) {
-			if(slide) {
-				m_animator.setAnimation(CharacterAnimation::Slide);
-			} else {
-				m_animator.setAnimation(CharacterAnimation::Duck);
-			}
-		} else {
-			if(inputDir != 0.0f) {
-				m_animator.setAnimation(CharacterAnimation::Run);
-			} else {
-				m_animator.setAnimation(CharacterAnimation::Idle);
-			}
-		}
-	} else {
-		if(m_velocity.y < 0.0f) {
-			m_animator.setAnimation(CharacterAnimation::Jump);
-		} else {
-			m_animator.setAnimation(CharacterAnimation::Fall);
-		}
-	}
+	if(m_flipped != prevFlipped) scene->getSquashes().squish(m_squash, time);
 
-	m_animator.update(time);
+	// the state machine picks the animation for our bunny
+	StateMachineSystem& stateMachines = scene->getStateMachines();
+	stateMachines.setParameter(m_stateMachine, m_animationParameters.grounded, grounded);
+	stateMachines.setParameter(m_stateMachine, m_animationParameters.ducked, m_isDucked);
+	stateMachines.setParameter(m_stateMachine, m_animationParameters.sliding, slide);
+	stateMachines.setParameter(m_stateMachine, m_animationParameters.moving, inputDir != 0.0f);
+	stateMachines.setParameter(m_stateMachine, m_animationParameters.velocityY, m_velocity.y);
 
-	m_clickAnimation.sync(m_animator.getCurrentAnimation());
-	m_clickAnimation.update(time);
+	// The mouse clicks in time with the player animation
+	scene->getAnimations().sync(m_clickAnimation, m_animation);
 
-	// update the visuals
-	m_sprite.sprite = m_animator.getCurrentFrame();
-	m_sprite.matrix =
-	    glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(position.x, position.y, 0.0f)), glm::vec3(m_flipped ? -96.0f : 96.0f, 96.0f, 1.0f))
-	    * m_squisher.calcMatrix(time);
+	// update the visuals, the frames and the squash and stretch are applied by their systems after the update
+	m_sprite.basis = glm::vec4(m_flipped ? -96.0f : 96.0f, 0.0f, 0.0f, 96.0f);
+	m_sprite.translation = position;
 
-	m_clickSprite.sprite = m_clickAnimation.getCurrentFrame();
-	m_clickSprite.matrix =
-	    glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(position.x + 16.0f, position.y, 0.0f)), glm::vec3(32.0f, 32.0f, 1.0f));
+	m_clickSprite.setTransform(Affine2D::translate(position + glm::vec2(16.0f, 0.0f)) * Affine2D::scale(glm::vec2(32.0f)));
 
-	updateClickableRegion();
+	m_isActive = !grounded || glm::dot(m_velocity, m_velocity) > 1.0f || !scene->getSquashes().isSettled(m_squash, time);
 }
 
 std::span<const SpriteDrawable> Player::getSprites() const {
-	return std::span<const SpriteDrawable>(&m_sprite, (m_input && !m_input->hasFocus()) ? 2 : 1);
+	return std::span<const SpriteDrawable>(&m_sprite, isClickSpriteVisible() ? 2 : 1);
 }
 
-void Player::updateClickableRegion() {
-	BoundingBox clickBounds = { .min = glm::vec2(-32.0f, -14.0f) + position, .max = glm::vec2(32.0f, 48.0f) + position };
+void Player::buildClickableRegion(ClickableRegion& region) const {
+	// Every drawn sprite catches clicks, the masks are only transformed again when the frame or the basis changed
+	std::span<const SpriteDrawable> sprites = getSprites();
+	const std::array<SpriteRegion*, 2> spriteRegions = { &m_clickRegion, &m_clickSpriteRegion };
+	for(size_t i = 0; i < sprites.size(); ++i) {
+		SpriteRegion* spriteRegion = spriteRegions[i];
+		spriteRegion->update(sprites[i]);
 #ifdef _DEBUG
-	GraphicsContext::getInstance().getDebugRenderer().box(clickBounds);
+		glm::vec2 offset = glm::vec2(spriteRegion->getOffset());
+		for(const IntBoundingBox& rect : spriteRegion->getRects())
+			GraphicsContext::getInstance().getDebugRenderer().box({ .min = glm::vec2(rect.min) + offset, .max = glm::vec2(rect.max) + offset });
 #endif
-	if(SurfaceManager::getInstance().canPushClickableRegion()) SurfaceManager::getInstance().pushClickableRegion(clickBounds);
+		region.add(spriteRegion->getRects(), spriteRegion->getOffset());
+	}
 }
 
 void Player::move(const Time& time, glm::vec2 delta) {
@@ -243,8 +266,8 @@ void Player::onImpact(const Time& time, glm::vec2 normal) {
 	if(intensity < 0.5f) return;
 
 	if(abs(normal.x) > abs(normal.y)) {
-		m_squisher.squish(time, std::min(intensity, 2.0f));
+		scene->getSquashes().squish(m_squash, time, std::min(intensity, 2.0f));
 	} else {
-		m_squisher.squash(time, std::min(intensity, 3.0f));
+		scene->getSquashes().squash(m_squash, time, std::min(intensity, 3.0f));
 	}
 }
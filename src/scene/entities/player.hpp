@@ -1,25 +1,41 @@
 #pragma once
 
-#include "animation/character_animator.hpp"
-#include "animation/squisher.hpp"
+#include "animation/squash_system.hpp"
+#include "animation/state_machine_system.hpp"
 #include "input/input.hpp"
 #include "math.hpp"
+#include "rendering/sprite_mask.hpp"
 #include "scene/entity.hpp"
 
 class Player : public Entity {
 public:
-	Player(CharacterAnimations animations, const Input* input = nullptr);
+	Player(const StateMachineDefinition& animations, const Input* input = nullptr);
+	virtual ~Player() override;
 
 	void setInput(const Input* input);
 
+	virtual void onAttach() override;
 	virtual void onUpdate(const Time& time) override;
 
 	virtual std::span<const SpriteDrawable> getSprites() const override;
+	virtual void buildClickableRegion(ClickableRegion& region) const override;
+	[[nodiscard]] virtual bool isActive() const override { return m_isActive; }
+
+private:
+	// Indices of the parameters of the animation state machine
+	struct AnimationParameters {
+		unsigned grounded;
+		unsigned ducked;
+		unsigned sliding;
+		unsigned moving;
+		unsigned velocityY;
+	};
 
 private:
-	void updateClickableRegion();
 	void move(const Time& time, glm::vec2 delta);
 	void onImpact(const Time& time, glm::vec2 normal);
+	// The mouse hints that the player can be clicked to give it focus
+	[[nodiscard]] bool isClickSpriteVisible() const { return m_input && !m_input->hasFocus(); }
 
 private:
 	const Input* m_input;
@@ -37,12 +53,21 @@ private:
 	float m_coyoteTime;
 
 	bool m_isDucked;
+	bool m_isActive;
 
 	bool m_flipped;
 	SpriteDrawable m_sprite;
 	SpriteDrawable m_clickSprite;
 
-	CharacterAnimator m_animator;
-	Animation m_clickAnimation;
-	Squisher m_squisher;
+	const StateMachineDefinition* m_animations;
+	AnimationParameters m_animationParameters;
+	AnimationSystem::Handle m_animation;
+	StateMachineSystem::Handle m_stateMachine;
+	AnimationSystem::Handle m_clickAnimation;
+	SquashSystem::Handle m_squash;
+
+	// The player only catches clicks where its sprites are opaque, one region per sprite
+	// They are only caches, so they are updated while building the region
+	mutable SpriteRegion m_clickRegion;
+	mutable SpriteRegion m_clickSpriteRegion;
 };
@@ -2,10 +2,15 @@
 
 #include <cstdint>
 #include <span>
+#include <vector>
 
+#include "animation/animation_system.hpp"
 #include "physics/bounding_box.hpp"
+#include "physics/clickable_region.hpp"
 #include "rendering/graphics_context.hpp"
 #include "rendering/sprite_drawable.hpp"
+#include "rendering/sprite_sort_key.hpp"
+#include "rendering/text_cache.hpp"
 #include "scene.hpp"
 #include "time.hpp"
 
@@ -13,8 +18,16 @@ class Entity {
 public:
 	virtual ~Entity() = default;
 
+	// Called once the entity was added to a scene
+	virtual void onAttach() {}
 	virtual void onUpdate(const Time& time) = 0;
 	virtual std::span<const SpriteDrawable> getSprites() const { return {}; }
+	// Appends labels through the cache of the scene, text that did not change since the last frame is not laid out again
+	virtual void buildText(TextCache& /* cache */, std::vector<SpriteDrawable>& /* sprites */, std::vector<uint64_t>& /* keys */) const {}
+	// Adds the screen rects where the entity should catch clicks, called every frame after the update
+	virtual void buildClickableRegion(ClickableRegion& /* region */) const {}
+	// Whether the entity moved or animated during the last update, idle scenes are updated at a lower frame rate
+	[[nodiscard]] virtual bool isActive() const { return false; }
 
 	[[nodiscard]] BoundingBox getPhysicsBounds() const { return { localPhysicsBounds.min + position, localPhysicsBounds.max + position }; }
 
@@ -27,6 +40,8 @@ public:
 public:
 	uint32_t flags = 0;
 	glm::vec2 position = glm::vec2(0.0f);
+	// Shared by all sprites of the entity
+	SpriteSortKey sortKey;
 	BoundingBox localPhysicsBounds;
 
 protected:
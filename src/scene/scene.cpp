@@ -1,13 +1,21 @@
 #include "scene.hpp"
+
+#include <algorithm>
+
 #include "entity.hpp"
+#include "profiler.hpp"
+#include "rendering/sprite_atlas.hpp"
+#include "rendering/surface_manager.hpp"
 
 Entity* Scene::addEntity(std::unique_ptr<Entity> entity) {
 	m_entities.push_back(std::move(entity));
 	m_entities.back()->setScene(this);
+	m_entities.back()->onAttach();
 	return m_entities.back().get();
 }
 
 void Scene::update(const Time& time) {
+	PROFILE_ZONE("Scene::update");
 	for(auto& e : m_entities) e->onUpdate(time);
 
 	for(auto it = m_entities.begin(); it != m_entities.end();) {
@@ -20,6 +28,20 @@ void Scene::update(const Time& time) {
 		}
 	}
 
+	// The state machines pick the clips from the parameters the entities set, then the frames are resolved before anything reads the sprites
+	m_stateMachines.update(m_animations, time);
+	m_animations.update(time);
+	// Entities set their transforms in their update, the squash and stretch is applied on top of them
+	m_squashes.update(time);
+
+	// The click window gets the union of all entities, and only when it changed
+	for(auto& e : m_entities) e->buildClickableRegion(m_clickableRegion);
+	bool canPush = SurfaceManager::isInitialized() && SurfaceManager::getInstance().canPushClickableRegion();
+	if(m_clickableRegion.update() && canPush) {
+		SurfaceManager::getInstance().pushClickableRegion(m_clickableRegion.getRects());
+		m_clickableRegion.markSubmitted();
+	}
+
 #ifdef _DEBUG
 	for(auto& e : m_entities) {
 		BoundingBox physicsBounds = e->getPhysicsBounds();
@@ -34,6 +56,7 @@ void Scene::addWindowPhysics(const WindowPhysics* windowPhysics) {
 }
 
 bool Scene::overlaps(const BoundingBox& box, uint32_t flags, const Entity* exclude, bool includeWindows) const {
+	PROFILE_ZONE("Scene::overlaps");
 	for(const auto& entity : m_entities) {
 		if(entity.get() == exclude || (entity->flags & flags) == 0) continue;
 		auto bounds = entity->getPhysicsBounds();
@@ -47,6 +70,7 @@ bool Scene::overlaps(const BoundingBox& box, uint32_t flags, const Entity* exclu
 Intersection Scene::rayCast(
     glm::vec2 origin, glm::vec2 direction, float maxDistance, uint32_t flags, const Entity* exclude, bool includeWindows
 ) const {
+	PROFILE_ZONE("Scene::rayCast");
 	Intersection hit{ .distance = maxDistance, .normal = glm::vec2(0.0f) };
 
 	for(const auto& entity : m_entities) {
@@ -67,6 +91,7 @@ Intersection Scene::rayCast(
 Intersection Scene::boxCast(
     const BoundingBox& origin, glm::vec2 direction, float maxDistance, uint32_t flags, const Entity* exclude, bool includeWindows
 ) const {
+	PROFILE_ZONE("Scene::boxCast");
 	Intersection hit{ .distance = maxDistance, .normal = glm::vec2(0.0f) };
 
 	for(const auto& entity : m_entities) {
@@ -84,10 +109,19 @@ Intersection Scene::boxCast(
 	return hit;
 }
 
-std::span<const SpriteDrawable> Scene::buildSprites() {
-	m_sprites.clear();
-
-	for(auto& e : m_entities) m_sprites.append_range(e->getSprites());
+bool Scene::isActive() const {
+	return std::ranges::any_of(m_entities, [](const auto& entity) { return entity->isActive(); });
+}
 
-	return m_sprites;
+void Scene::buildSprites(std::vector<SpriteDrawable>& sprites, std::vector<uint64_t>& keys) const {
+	PROFILE_ZONE("Scene::buildSprites");
+	for(const auto& e : m_entities) {
+		for(const SpriteDrawable& sprite : e->getSprites()) {
+			unsigned page = sprite.sprite < SpriteAtlas::getSprites().size() ? SpriteAtlas::getSprite(sprite.sprite).getPage() : 0;
+			sprites.push_back(sprite);
+			keys.push_back(e->sortKey.pack(page));
+		}
+		e->buildText(m_textCache, sprites, keys);
+	}
+	m_textCache.endFrame();
 }
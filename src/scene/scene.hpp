@@ -5,10 +5,15 @@
 #include <span>
 #include <vector>
 
+#include "animation/animation_system.hpp"
+#include "animation/squash_system.hpp"
+#include "animation/state_machine_system.hpp"
 #include "physics/bounding_box.hpp"
+#include "physics/clickable_region.hpp"
 #include "physics/intersection.hpp"
 #include "physics/window_physics.hpp"
 #include "rendering/sprite_drawable.hpp"
+#include "rendering/text_cache.hpp"
 #include "time.hpp"
 
 class Entity;
@@ -37,12 +42,23 @@ public:
 	    bool includeWindows = true
 	) const;
 
-	std::span<const SpriteDrawable> buildSprites();
+	[[nodiscard]] AnimationSystem& getAnimations() { return m_animations; }
+	[[nodiscard]] StateMachineSystem& getStateMachines() { return m_stateMachines; }
+	[[nodiscard]] SquashSystem& getSquashes() { return m_squashes; }
+
+	// Appends the sprites of all entities with their packed sort keys, the vectors are not cleared so their memory can be reused between frames
+	void buildSprites(std::vector<SpriteDrawable>& sprites, std::vector<uint64_t>& keys) const;
+	[[nodiscard]] bool isActive() const;
 
 private:
+	// Entities remove their animators, state machines and squashes when they are destroyed, so the systems have to outlive them
+	AnimationSystem m_animations;
+	StateMachineSystem m_stateMachines;
+	SquashSystem m_squashes;
 	std::vector<std::unique_ptr<Entity>> m_entities;
 	const WindowPhysics* m_windowPhysics = nullptr;
 
-	std::vector<SpriteDrawable> m_sprites;
-	std::vector<BoundingBox> m_clickRegions;
+	ClickableRegion m_clickableRegion;
+	// Only a cache, building the sprites does not change the scene
+	mutable TextCache m_textCache;
 };
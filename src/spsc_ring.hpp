@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+// Bounded queue between exactly one producer thread and one consumer thread, neither side ever blocks or allocates
+// Each side owns one index and only reads the other one, the indices run freely and wrap around the power of two capacity
+// Both sides keep a copy of the index of the other side so the shared cache line is only read when the ring looks full or empty
+template<typename T, size_t Capacity>
+class SpscRing {
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity has to be a power of two");
+
+public:
+	SpscRing() = default;
+	// Both indices start at the position instead of zero, so tests can have them wrap around soon
+	explicit SpscRing(uint32_t start) : m_write(start), m_cachedRead(start), m_read(start), m_cachedWrite(start) {}
+
+	// Producer only, fails when the ring is full
+	bool push(const T& value) {
+		uint32_t write = m_write.load(std::memory_order_relaxed);
+		if(write - m_cachedRead == Capacity) {
+			m_cachedRead = m_read.load(std::memory_order_acquire);
+			if(write - m_cachedRead == Capacity) return false;
+		}
+		m_items[write & (Capacity - 1)] = value;
+		m_write.store(write + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer only
+	std::optional<T> pop() {
+		uint32_t read = m_read.load(std::memory_order_relaxed);
+		if(read == m_cachedWrite) {
+			m_cachedWrite = m_write.load(std::memory_order_acquire);
+			if(read == m_cachedWrite) return std::nullopt;
+		}
+		T value = m_items[read & (Capacity - 1)];
+		m_read.store(read + 1, std::memory_order_release);
+		return value;
+	}
+
+private:
+	constexpr static size_t CacheLine = 64;
+
+	alignas(CacheLine) std::atomic_uint32_t m_write = 0;
+	uint32_t m_cachedRead = 0;
+	alignas(CacheLine) std::atomic_uint32_t m_read = 0;
+	uint32_t m_cachedWrite = 0;
+	alignas(CacheLine) std::array<T, Capacity> m_items = {};
+};
@@ -0,0 +1,33 @@
+#include "thread_pool.hpp"
+
+ThreadPool::ThreadPool(unsigned threadCount) {
+	m_workers.reserve(threadCount);
+	for(unsigned i = 0; i < threadCount; ++i) m_workers.emplace_back([this](const std::stop_token& stopToken) { workerLoop(stopToken); });
+}
+
+ThreadPool::~ThreadPool() {
+	for(auto& worker : m_workers) worker.request_stop();
+	m_condition.notify_all();
+	m_workers.clear();
+}
+
+void ThreadPool::enqueue(std::move_only_function<void()> task) {
+	{
+		std::lock_guard lock(m_mutex);
+		m_tasks.push_back(std::move(task));
+	}
+	m_condition.notify_one();
+}
+
+void ThreadPool::workerLoop(const std::stop_token& stopToken) {
+	while(true) {
+		std::move_only_function<void()> task;
+		{
+			std::unique_lock lock(m_mutex);
+			if(!m_condition.wait(lock, stopToken, [this]() { return !m_tasks.empty(); })) return;
+			task = std::move(m_tasks.front());
+			m_tasks.pop_front();
+		}
+		task();
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <latch>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+class ThreadPool {
+public:
+	explicit ThreadPool(unsigned threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1);
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+	ThreadPool(ThreadPool&&) = delete;
+	ThreadPool& operator=(ThreadPool&&) = delete;
+	~ThreadPool();
+
+	template<typename F>
+	[[nodiscard]] std::future<std::invoke_result_t<F>> submit(F&& task) {
+		std::packaged_task<std::invoke_result_t<F>()> packagedTask(std::forward<F>(task));
+		auto future = packagedTask.get_future();
+		enqueue(std::move(packagedTask));
+		return future;
+	}
+
+	// Runs task(i) for every i in [0, count), the calling thread helps out and this only returns once everything is done
+	template<typename F>
+	void parallelFor(unsigned count, F&& task) {
+		std::atomic_uint next = 0;
+		auto work = [&]() {
+			for(unsigned i = next++; i < count; i = next++) task(i);
+		};
+
+		unsigned helpers = count > 1 ? std::min(count - 1, getThreadCount()) : 0;
+		std::latch done(helpers);
+		for(unsigned i = 0; i < helpers; ++i) {
+			enqueue([&]() {
+				work();
+				done.count_down();
+			});
+		}
+
+		work();
+		done.wait();
+	}
+
+	[[nodiscard]] unsigned getThreadCount() const { return unsigned(m_workers.size()); }
+
+private:
+	void enqueue(std::move_only_function<void()> task);
+	void workerLoop(const std::stop_token& stopToken);
+
+private:
+	std::vector<std::jthread> m_workers;
+	std::mutex m_mutex;
+	std::condition_variable_any m_condition;
+	std::deque<std::move_only_function<void()>> m_tasks;
+};
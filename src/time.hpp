@@ -1,20 +1,35 @@
 #pragma once
 
+#include <algorithm>
 #include <chrono>
 
 class Time {
+public:
+	// Frames can be far apart after rendering was suspended, the simulation should not take that in one step
+	constexpr static float MaxDeltaTime = 0.25f;
+
 public:
 	Time() : m_start(std::chrono::steady_clock::now()), m_prevFrame(m_start), m_time(0.0), m_deltaTime(0.0f) {}
 
 	void update() {
 		auto currFrame = std::chrono::steady_clock::now();
-		m_deltaTime = std::chrono::duration<float>(currFrame - m_prevFrame).count();
+		m_deltaTime = std::min(std::chrono::duration<float>(currFrame - m_prevFrame).count(), MaxDeltaTime);
 		m_time = std::chrono::duration<double>(currFrame - m_start).count();
 		m_prevFrame = currFrame;
 	}
 
+	// Replays step the clock by the recorded frames, the clock carries on from there when update is called again
+	void set(double time, float deltaTime) {
+		m_prevFrame = std::chrono::steady_clock::now();
+		m_start = m_prevFrame - std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(time));
+		m_time = time;
+		m_deltaTime = deltaTime;
+	}
+
 	[[nodiscard]] double time() const { return m_time; }
 	[[nodiscard]] float deltaTime() const { return m_deltaTime; }
+	// The same clock as time(), for things that happened between frames
+	[[nodiscard]] double timeAt(std::chrono::steady_clock::time_point point) const { return std::chrono::duration<double>(point - m_start).count(); }
 
 private:
 	std::chrono::steady_clock::time_point m_start;
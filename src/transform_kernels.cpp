@@ -0,0 +1,205 @@
+#include "transform_kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include "cpu_features.hpp"
+
+#if defined(_M_X64) || defined(__x86_64__)
+	#define KERNELS_X64
+	#include <immintrin.h>
+#endif
+
+#if defined(__clang__) || defined(__GNUC__)
+	#define TARGET_AVX __attribute__((target("avx")))
+#else
+	#define TARGET_AVX
+#endif
+
+// The kernels load points, boxes and the basis of drawables straight into registers
+static_assert(sizeof(glm::vec2) == sizeof(float) * 2 && sizeof(BoundingBox) == sizeof(float) * 4, "Points and boxes have to be packed floats");
+static_assert(offsetof(SpriteDrawable, basis) == 0 && offsetof(SpriteDrawable, translation) == 16, "SpriteDrawable layout changed");
+
+namespace {
+	void transformPointsScalar(const Affine2D& transform, std::span<const glm::vec2> points, std::span<glm::vec2> out, size_t from) {
+		for(size_t i = from; i < points.size(); ++i) out[i] = transform.apply(points[i]);
+	}
+
+	void transformBoundsScalar(const Affine2D& transform, std::span<const BoundingBox> boxes, std::span<BoundingBox> out, size_t from) {
+		for(size_t i = from; i < boxes.size(); ++i) out[i] = transform.apply(boxes[i]);
+	}
+
+#ifdef KERNELS_X64
+	// Two points per register, every point is x * p.x + y * p.y + translation with p.x and p.y broadcast within its half
+	void transformPointsSse(const Affine2D& transform, std::span<const glm::vec2> points, std::span<glm::vec2> out) {
+		const __m128 x = _mm_setr_ps(transform.x.x, transform.x.y, transform.x.x, transform.x.y);
+		const __m128 y = _mm_setr_ps(transform.y.x, transform.y.y, transform.y.x, transform.y.y);
+		const __m128 translation = _mm_setr_ps(transform.translation.x, transform.translation.y, transform.translation.x, transform.translation.y);
+
+		size_t i = 0;
+		for(; i + 2 <= points.size(); i += 2) {
+			__m128 p = _mm_loadu_ps(&points[i].x);
+			__m128 px = _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 0, 0));
+			__m128 py = _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 1, 1));
+			_mm_storeu_ps(&out[i].x, _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, x), _mm_mul_ps(py, y)), translation));
+		}
+		transformPointsScalar(transform, points, out, i);
+	}
+
+	TARGET_AVX void transformPointsAvx(const Affine2D& transform, std::span<const glm::vec2> points, std::span<glm::vec2> out) {
+		const __m256 x = _mm256_setr_ps(
+		    transform.x.x, transform.x.y, transform.x.x, transform.x.y, transform.x.x, transform.x.y, transform.x.x, transform.x.y
+		);
+		const __m256 y = _mm256_setr_ps(
+		    transform.y.x, transform.y.y, transform.y.x, transform.y.y, transform.y.x, transform.y.y, transform.y.x, transform.y.y
+		);
+		const __m256 translation = _mm256_setr_ps(
+		    transform.translation.x, transform.translation.y, transform.translation.x, transform.translation.y, transform.translation.x,
+		    transform.translation.y, transform.translation.x, transform.translation.y
+		);
+
+		size_t i = 0;
+		for(; i + 4 <= points.size(); i += 4) {
+			__m256 p = _mm256_loadu_ps(&points[i].x);
+			__m256 px = _mm256_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 0, 0));
+			__m256 py = _mm256_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 1, 1));
+			_mm256_storeu_ps(&out[i].x, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px, x), _mm256_mul_ps(py, y)), translation));
+		}
+		transformPointsScalar(transform, points, out, i);
+	}
+
+	// One box per register as min.x, min.y, max.x, max.y, the center is transformed and the extent grows by the absolute axes
+	void transformBoundsSse(const Affine2D& transform, std::span<const BoundingBox> boxes, std::span<BoundingBox> out) {
+		const __m128 x = _mm_setr_ps(transform.x.x, transform.x.y, transform.x.x, transform.x.y);
+		const __m128 y = _mm_setr_ps(transform.y.x, transform.y.y, transform.y.x, transform.y.y);
+		const __m128 translation = _mm_setr_ps(transform.translation.x, transform.translation.y, transform.translation.x, transform.translation.y);
+		const __m128 absX = _mm_andnot_ps(_mm_set1_ps(-0.0f), x);
+		const __m128 absY = _mm_andnot_ps(_mm_set1_ps(-0.0f), y);
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128 sign = _mm_setr_ps(-1.0f, -1.0f, 1.0f, 1.0f);
+
+		for(size_t i = 0; i < boxes.size(); ++i) {
+			__m128 box = _mm_loadu_ps(&boxes[i].min.x);
+			__m128 swapped = _mm_shuffle_ps(box, box, _MM_SHUFFLE(1, 0, 3, 2));
+			__m128 center = _mm_mul_ps(_mm_add_ps(box, swapped), half);
+			__m128 extent = _mm_mul_ps(_mm_sub_ps(swapped, box), half);
+			__m128 newCenter = _mm_add_ps(
+			    _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(center, center, 0x00), x), _mm_mul_ps(_mm_shuffle_ps(center, center, 0x55), y)), translation
+			);
+			__m128 newExtent = _mm_add_ps(
+			    _mm_mul_ps(_mm_shuffle_ps(extent, extent, 0x00), absX), _mm_mul_ps(_mm_shuffle_ps(extent, extent, 0x55), absY)
+			);
+			_mm_storeu_ps(&out[i].min.x, _mm_add_ps(newCenter, _mm_mul_ps(newExtent, sign)));
+		}
+	}
+
+	TARGET_AVX void transformBoundsAvx(const Affine2D& transform, std::span<const BoundingBox> boxes, std::span<BoundingBox> out) {
+		const __m256 x = _mm256_setr_ps(
+		    transform.x.x, transform.x.y, transform.x.x, transform.x.y, transform.x.x, transform.x.y, transform.x.x, transform.x.y
+		);
+		const __m256 y = _mm256_setr_ps(
+		    transform.y.x, transform.y.y, transform.y.x, transform.y.y, transform.y.x, transform.y.y, transform.y.x, transform.y.y
+		);
+		const __m256 translation = _mm256_setr_ps(
+		    transform.translation.x, transform.translation.y, transform.translation.x, transform.translation.y, transform.translation.x,
+		    transform.translation.y, transform.translation.x, transform.translation.y
+		);
+		const __m256 absX = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x);
+		const __m256 absY = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), y);
+		const __m256 half = _mm256_set1_ps(0.5f);
+		const __m256 sign = _mm256_setr_ps(-1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f);
+
+		size_t i = 0;
+		for(; i + 2 <= boxes.size(); i += 2) {
+			__m256 box = _mm256_loadu_ps(&boxes[i].min.x);
+			__m256 swapped = _mm256_shuffle_ps(box, box, _MM_SHUFFLE(1, 0, 3, 2));
+			__m256 center = _mm256_mul_ps(_mm256_add_ps(box, swapped), half);
+			__m256 extent = _mm256_mul_ps(_mm256_sub_ps(swapped, box), half);
+			__m256 newCenter = _mm256_add_ps(
+			    _mm256_add_ps(_mm256_mul_ps(_mm256_shuffle_ps(center, center, 0x00), x), _mm256_mul_ps(_mm256_shuffle_ps(center, center, 0x55), y)),
+			    translation
+			);
+			__m256 newExtent = _mm256_add_ps(
+			    _mm256_mul_ps(_mm256_shuffle_ps(extent, extent, 0x00), absX), _mm256_mul_ps(_mm256_shuffle_ps(extent, extent, 0x55), absY)
+			);
+			_mm256_storeu_ps(&out[i].min.x, _mm256_add_ps(newCenter, _mm256_mul_ps(newExtent, sign)));
+		}
+		transformBoundsScalar(transform, boxes, out, i);
+	}
+
+	// Drawables are 28 bytes apart, so there is one per register and no AVX version
+	void computeQuadBoundsSse(std::span<const SpriteDrawable> drawables, std::span<BoundingBox> out) {
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128 sign = _mm_setr_ps(-1.0f, -1.0f, 1.0f, 1.0f);
+
+		for(size_t i = 0; i < drawables.size(); ++i) {
+			const SpriteDrawable& drawable = drawables[i];
+			__m128 basis = _mm_andnot_ps(_mm_set1_ps(-0.0f), _mm_loadu_ps(&drawable.basis.x));
+			__m128 extent = _mm_mul_ps(_mm_add_ps(basis, _mm_shuffle_ps(basis, basis, _MM_SHUFFLE(1, 0, 3, 2))), half);
+			__m128 translation = _mm_setr_ps(drawable.translation.x, drawable.translation.y, drawable.translation.x, drawable.translation.y);
+			_mm_storeu_ps(&out[i].min.x, _mm_add_ps(translation, _mm_mul_ps(extent, sign)));
+		}
+	}
+
+	// The max half is negated, so a single min covers both halves
+	BoundingBox mergeBoundsSse(std::span<const BoundingBox> boxes) {
+		const __m128 sign = _mm_setr_ps(0.0f, 0.0f, -0.0f, -0.0f);
+		__m128 merged = _mm_set1_ps(INFINITY);
+		for(const BoundingBox& box : boxes) merged = _mm_min_ps(merged, _mm_xor_ps(_mm_loadu_ps(&box.min.x), sign));
+
+		BoundingBox result;
+		_mm_storeu_ps(&result.min.x, _mm_xor_ps(merged, sign));
+		return result;
+	}
+#endif
+} // namespace
+
+void transform_kernels::transformPoints(const Affine2D& transform, std::span<const glm::vec2> points, std::span<glm::vec2> out) {
+#ifdef KERNELS_X64
+	if(cpu_features::hasAvx()) {
+		transformPointsAvx(transform, points, out);
+	} else {
+		transformPointsSse(transform, points, out);
+	}
+#else
+	transformPointsScalar(transform, points, out, 0);
+#endif
+}
+
+void transform_kernels::transformBounds(const Affine2D& transform, std::span<const BoundingBox> boxes, std::span<BoundingBox> out) {
+#ifdef KERNELS_X64
+	if(cpu_features::hasAvx()) {
+		transformBoundsAvx(transform, boxes, out);
+	} else {
+		transformBoundsSse(transform, boxes, out);
+	}
+#else
+	transformBoundsScalar(transform, boxes, out, 0);
+#endif
+}
+
+void transform_kernels::computeQuadBounds(std::span<const SpriteDrawable> drawables, std::span<BoundingBox> out) {
+#ifdef KERNELS_X64
+	computeQuadBoundsSse(drawables, out);
+#else
+	// The quad goes from -0.5 to 0.5 along both basis vectors
+	for(size_t i = 0; i < drawables.size(); ++i) {
+		glm::vec2 extent = 0.5f * (glm::abs(glm::vec2(drawables[i].basis)) + glm::abs(glm::vec2(drawables[i].basis.z, drawables[i].basis.w)));
+		out[i] = { .min = drawables[i].translation - extent, .max = drawables[i].translation + extent };
+	}
+#endif
+}
+
+BoundingBox transform_kernels::mergeBounds(std::span<const BoundingBox> boxes) {
+#ifdef KERNELS_X64
+	return mergeBoundsSse(boxes);
+#else
+	BoundingBox merged = { .min = glm::vec2(INFINITY), .max = glm::vec2(-INFINITY) };
+	for(const BoundingBox& box : boxes) {
+		merged.min = glm::min(merged.min, box.min);
+		merged.max = glm::max(merged.max, box.max);
+	}
+	return merged;
+#endif
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <span>
+
+#include "affine2d.hpp"
+#include "physics/bounding_box.hpp"
+#include "rendering/sprite_drawable.hpp"
+
+// Transforms whole arrays at once with SSE, or AVX when the build targets it, every kernel also has a plain fallback
+// Output spans have to be at least as long as the input, the output may be the input itself
+namespace transform_kernels {
+
+void transformPoints(const Affine2D& transform, std::span<const glm::vec2> points, std::span<glm::vec2> out);
+// Bounds of every transformed box
+void transformBounds(const Affine2D& transform, std::span<const BoundingBox> boxes, std::span<BoundingBox> out);
+// Bounds of the unit quad of every drawable on screen
+void computeQuadBounds(std::span<const SpriteDrawable> drawables, std::span<BoundingBox> out);
+// Returns an inverted box for an empty span
+[[nodiscard]] BoundingBox mergeBounds(std::span<const BoundingBox> boxes);
+
+} // namespace transform_kernels
@@ -0,0 +1,388 @@
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <print>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+
+#include "atlas/atlas_builder.hpp"
+#include "atlas/baked_atlas.hpp"
+#include "png_writer.hpp"
+
+namespace fs = std::filesystem;
+
+struct Arguments {
+	AtlasBuilder::Options options;
+	bool incremental = false;
+	fs::path input;
+	fs::path output;
+	std::optional<fs::path> compare;
+};
+
+struct SourceImage {
+	std::string name;
+	Image image;
+};
+
+static void printUsage() {
+	std::println("Usage: atlas_packer [options] <input directory> <output prefix>");
+	std::println("Packs all PNG files in the input directory into <output prefix>.bin and <output prefix>.json");
+	std::println("Every page is also written to <output prefix>_<page>.png");
+	std::println();
+	std::println("  --padding <pixels>   Empty pixels between sprites (default 1)");
+	std::println("  --max-size <pixels>  Largest allowed page width and height, further sprites go onto new pages (default 4096)");
+	std::println("  --no-trim            Keep transparent borders around sprites");
+	std::println("  --rotate             Allow sprites to be rotated by 90 degrees");
+	std::println("  --incremental        Keep unchanged sprites where the existing output has them");
+	std::println("  --compare <json>     Print the occupancy of another atlas next to the result");
+}
+
+static std::optional<unsigned> parseUnsigned(std::string_view str) {
+	unsigned value = 0;
+	auto [end, error] = std::from_chars(str.data(), str.data() + str.size(), value);
+	if(error != std::errc() || end != str.data() + str.size()) return std::nullopt;
+	return value;
+}
+
+static std::optional<Arguments> parseArguments(int argc, char** argv) {
+	Arguments arguments;
+	std::vector<std::string_view> positional;
+
+	for(int i = 1; i < argc; ++i) {
+		std::string_view arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if(arg == "--no-trim") {
+			arguments.options.trim = false;
+		} else if(arg == "--rotate") {
+			arguments.options.allowRotation = true;
+		} else if(arg == "--incremental") {
+			arguments.incremental = true;
+		} else if(arg == "--padding" && hasValue) {
+			auto value = parseUnsigned(argv[++i]);
+			if(!value) return std::nullopt;
+			arguments.options.padding = *value;
+		} else if(arg == "--max-size" && hasValue) {
+			auto value = parseUnsigned(argv[++i]);
+			if(!value || *value == 0) return std::nullopt;
+			arguments.options.maxSize = *value;
+		} else if(arg == "--compare" && hasValue) {
+			arguments.compare = argv[++i];
+		} else if(arg.starts_with("--")) {
+			return std::nullopt;
+		} else {
+			positional.push_back(arg);
+		}
+	}
+
+	if(positional.size() != 2) return std::nullopt;
+	arguments.input = positional[0];
+	arguments.output = positional[1];
+	return arguments;
+}
+
+static std::optional<Image> loadPng(const fs::path& path) {
+	int width = 0;
+	int height = 0;
+	int components = 0;
+	unsigned char* data = stbi_load(path.string().c_str(), &width, &height, &components, 4);
+	if(!data) return std::nullopt;
+
+	Image image;
+	image.width = unsigned(width);
+	image.height = unsigned(height);
+	image.pixels.resize(size_t(width) * size_t(height));
+	std::memcpy(image.pixels.data(), data, image.pixels.size() * sizeof(uint32_t));
+	stbi_image_free(data);
+	return image;
+}
+
+static std::optional<nlohmann::json> loadJson(const fs::path& path) {
+	std::ifstream stream(path);
+	if(!stream) return std::nullopt;
+
+	nlohmann::json json = nlohmann::json::parse(stream, nullptr, false);
+	if(json.is_discarded()) return std::nullopt;
+	return json;
+}
+
+// Works for our own output and the output of other packers, anything with a position and size counts as a sprite
+static void collectSpriteArea(const nlohmann::json& json, size_t& area) {
+	if(json.is_object() && json.contains("x") && json.contains("y") && json.contains("width") && json.contains("height")) {
+		area += json["width"].get<size_t>() * json["height"].get<size_t>();
+		return;
+	}
+
+	if(json.is_structured())
+		for(const auto& child : json) collectSpriteArea(child, area);
+}
+
+static std::optional<float> computeOccupancy(const nlohmann::json& json) {
+	if(!json.contains("width") || !json.contains("height")) return std::nullopt;
+
+	size_t area = 0;
+	for(const auto& [key, value] : json.items())
+		if(key != "width" && key != "height") collectSpriteArea(value, area);
+
+	double atlasArea = json["width"].get<double>() * json["height"].get<double>();
+	return atlasArea > 0.0 ? std::optional(float(double(area) / atlasArea)) : std::nullopt;
+}
+
+struct PreviousSprite {
+	unsigned page;
+	AtlasBuilder::Sprite sprite;
+};
+
+static std::vector<PreviousSprite> readSprites(const nlohmann::json& json) {
+	std::vector<PreviousSprite> sprites;
+	if(!json.contains("sprites")) return sprites;
+
+	for(const auto& entry : json["sprites"]) {
+		sprites.push_back({
+		    .page = entry.value("page", 0u),
+		    .sprite = {
+		        .name = entry.value("name", ""),
+		        .rect = {
+		            .x = entry.value("x", 0u),
+		            .y = entry.value("y", 0u),
+		            .width = entry.value("width", 0u),
+		            .height = entry.value("height", 0u),
+		            .rotated = entry.value("rotated", false),
+		        },
+		        .trimX = entry.value("trimX", 0u),
+		        .trimY = entry.value("trimY", 0u),
+		        .sourceWidth = entry.value("sourceWidth", 0u),
+		        .sourceHeight = entry.value("sourceHeight", 0u),
+		    },
+		});
+	}
+
+	return sprites;
+}
+
+static fs::path getPagePath(const fs::path& output, size_t page) {
+	return fs::path(output).concat("_" + std::to_string(page) + ".png");
+}
+
+static bool addAll(AtlasBuilder& builder, std::span<const SourceImage* const> sources) {
+	return std::ranges::all_of(sources, [&](const SourceImage* source) { return builder.add(source->name, source->image) != nullptr; });
+}
+
+// Packing is cheap, so a range of page widths is tried and the smallest result wins
+static std::optional<AtlasBuilder> packSinglePage(std::span<const SourceImage* const> sources, AtlasBuilder::Options options) {
+	unsigned minWidth = 1;
+	for(const SourceImage* source : sources) minWidth = std::max(minWidth, source->image.width + options.padding);
+
+	std::optional<AtlasBuilder> best;
+	bool bestIsStrip = false;
+	for(unsigned step = 0;; ++step) {
+		auto width = unsigned(double(minWidth) * std::exp2(double(step) / 16.0));
+		if(width > options.maxSize) break;
+
+		options.width = width;
+		options.height = options.maxSize;
+		AtlasBuilder candidate(options);
+		if(!addAll(candidate, sources)) continue;
+
+		// Very long strips can pack tighter, but are awkward to look at and to page in later
+		bool strip = std::max(candidate.getWidth(), candidate.getHeight()) > std::min(candidate.getWidth(), candidate.getHeight()) * 2;
+		bool better = !best || (bestIsStrip && !strip) || (bestIsStrip == strip && candidate.getOccupancy() > best->getOccupancy());
+		if(better) {
+			best = std::move(candidate);
+			bestIsStrip = strip;
+		}
+	}
+
+	return best;
+}
+
+// Sprites that do not fit on one page anymore spill over onto further full size pages
+static bool packPages(std::vector<AtlasBuilder>& pages, std::span<const SourceImage* const> sources, const AtlasBuilder::Options& options) {
+	std::vector<const SourceImage*> remaining(sources.begin(), sources.end());
+	while(!remaining.empty()) {
+		if(std::optional<AtlasBuilder> page = packSinglePage(remaining, options)) {
+			pages.push_back(std::move(*page));
+			return true;
+		}
+
+		AtlasBuilder::Options pageOptions = options;
+		pageOptions.width = options.maxSize;
+		pageOptions.height = options.maxSize;
+		AtlasBuilder& page = pages.emplace_back(pageOptions);
+
+		std::vector<const SourceImage*> spilled;
+		for(const SourceImage* source : remaining)
+			if(!page.add(source->name, source->image)) spilled.push_back(source);
+
+		if(spilled.size() == remaining.size()) {
+			std::println(stderr, "{} does not fit into a {}x{} page", spilled.front()->name, options.maxSize, options.maxSize);
+			return false;
+		}
+		remaining = std::move(spilled);
+	}
+
+	return true;
+}
+
+int main(int argc, char** argv) {
+	std::optional<Arguments> arguments = parseArguments(argc, argv);
+	if(!arguments) {
+		printUsage();
+		return 1;
+	}
+
+	// The runtime looks sprites up by file name, so names have to be unique across all directories
+	std::map<std::string, SourceImage> sources;
+	std::error_code error;
+	for(const auto& entry : fs::recursive_directory_iterator(arguments->input, error)) {
+		if(!entry.is_regular_file() || entry.path().extension() != ".png") continue;
+
+		std::string name = entry.path().filename().string();
+		if(sources.contains(name)) {
+			std::println(stderr, "Sprite name {} is used more than once", name);
+			return 1;
+		}
+
+		std::optional<Image> image = loadPng(entry.path());
+		if(!image) {
+			std::println(stderr, "Could not load {}: {}", entry.path().string(), stbi_failure_reason());
+			return 1;
+		}
+
+		sources.emplace(name, SourceImage{ .name = name, .image = std::move(*image) });
+	}
+
+	if(error || sources.empty()) {
+		std::println(stderr, "No sprites found in {}", arguments->input.string());
+		return 1;
+	}
+
+	fs::path jsonPath = fs::path(arguments->output).concat(".json");
+	fs::path bakedPath = fs::path(arguments->output).concat(".bin");
+
+	std::vector<PreviousSprite> previousSprites;
+	std::vector<Image> previousPages;
+	if(arguments->incremental) {
+		std::optional<nlohmann::json> json = loadJson(jsonPath);
+		size_t pageCount = json && json->contains("pages") ? (*json)["pages"].size() : 0;
+		for(size_t page = 0; page < pageCount; ++page) {
+			std::optional<Image> image = loadPng(getPagePath(arguments->output, page));
+			if(!image) break;
+			previousPages.push_back(std::move(*image));
+		}
+		if(pageCount > 0 && previousPages.size() == pageCount) previousSprites = readSprites(*json);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	const AtlasBuilder::Options& options = arguments->options;
+
+	// Sprites that did not change stay where they were, everything else is packed around them
+	std::vector<AtlasBuilder> pages;
+	size_t restored = 0;
+	if(!previousSprites.empty()) {
+		for(const Image& previousPage : previousPages) {
+			AtlasBuilder::Options pageOptions = options;
+			pageOptions.width = previousPage.width;
+			pageOptions.height = previousPage.height;
+			pages.emplace_back(pageOptions);
+		}
+
+		for(const auto& [page, sprite] : previousSprites) {
+			auto source = sources.find(sprite.name);
+			if(page >= pages.size() || source == sources.end()) continue;
+			if(!pages[page].matches(sprite, previousPages[page], source->second.image)) continue;
+			if(!pages[page].restore(sprite, previousPages[page])) continue;
+
+			sources.erase(source);
+			++restored;
+		}
+	}
+
+	// Packing large sprites first leaves the small ones to fill the gaps
+	std::vector<const SourceImage*> order;
+	for(const auto& [name, source] : sources) order.push_back(&source);
+	std::ranges::stable_sort(order, [](const SourceImage* a, const SourceImage* b) {
+		unsigned sideA = std::max(a->image.width, a->image.height);
+		unsigned sideB = std::max(b->image.width, b->image.height);
+		if(sideA != sideB) return sideA > sideB;
+		return size_t(a->image.width) * a->image.height > size_t(b->image.width) * b->image.height;
+	});
+
+	if(!pages.empty()) {
+		// New sprites go onto the first page with room, the rest start new pages
+		std::vector<const SourceImage*> remaining;
+		for(const SourceImage* source : order) {
+			bool added = std::ranges::any_of(pages, [&](AtlasBuilder& page) { return page.add(source->name, source->image) != nullptr; });
+			if(!added) remaining.push_back(source);
+		}
+		std::erase_if(pages, [](const AtlasBuilder& page) { return page.getSprites().empty(); });
+		if(!packPages(pages, remaining, options)) return 1;
+	} else if(!packPages(pages, order, options)) {
+		return 1;
+	}
+
+	std::vector<Image> images;
+	for(const AtlasBuilder& page : pages) images.push_back(page.getImage());
+	double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	fs::create_directories(fs::absolute(jsonPath).parent_path());
+	for(size_t page = 0; page < images.size(); ++page) {
+		fs::path pngPath = getPagePath(arguments->output, page);
+		if(!writePng(pngPath, images[page])) {
+			std::println(stderr, "Could not write {}", pngPath.string());
+			return 1;
+		}
+	}
+
+	// The runtime embeds the baked atlas, the PNGs are kept for incremental packing and to look at
+	std::vector<std::byte> baked = bakeAtlas(images);
+	std::ofstream bakedStream(bakedPath, std::ios::binary);
+	bakedStream.write(reinterpret_cast<const char*>(baked.data()), std::streamsize(baked.size()));
+	if(!bakedStream) {
+		std::println(stderr, "Could not write {}", bakedPath.string());
+		return 1;
+	}
+
+	std::ofstream jsonStream(jsonPath);
+	jsonStream << AtlasBuilder::toJson(pages);
+	if(!jsonStream) {
+		std::println(stderr, "Could not write {}", jsonPath.string());
+		return 1;
+	}
+
+	size_t spriteCount = 0;
+	for(const AtlasBuilder& page : pages) spriteCount += page.getSprites().size();
+	std::println("Packed {} sprites ({} unchanged) onto {} pages in {:.2f} ms", spriteCount, restored, pages.size(), milliseconds);
+	for(size_t page = 0; page < pages.size(); ++page)
+		std::println("  Page {}: {}x{} at {:.1f}% occupancy", page, images[page].width, images[page].height, pages[page].getOccupancy() * 100.0f);
+
+	if(arguments->compare) {
+		std::optional<nlohmann::json> json = loadJson(*arguments->compare);
+		std::optional<float> occupancy = json ? computeOccupancy(*json) : std::nullopt;
+		if(occupancy) {
+			std::println(
+			    "{}: {}x{} at {:.1f}% occupancy",
+			    arguments->compare->string(),
+			    (*json)["width"].get<unsigned>(),
+			    (*json)["height"].get<unsigned>(),
+			    *occupancy * 100.0f
+			);
+		} else {
+			std::println(stderr, "Could not read the atlas size from {}", arguments->compare->string());
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,89 @@
+#include "png_writer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string_view>
+#include <vector>
+
+static constexpr std::array<uint32_t, 256> crcTable = []() {
+	std::array<uint32_t, 256> table = {};
+	for(uint32_t i = 0; i < 256; ++i) {
+		uint32_t crc = i;
+		for(int bit = 0; bit < 8; ++bit) crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+		table[i] = crc;
+	}
+	return table;
+}();
+
+static void appendBigEndian(std::vector<uint8_t>& data, uint32_t value) {
+	data.push_back(uint8_t(value >> 24));
+	data.push_back(uint8_t(value >> 16));
+	data.push_back(uint8_t(value >> 8));
+	data.push_back(uint8_t(value));
+}
+
+static void appendChunk(std::vector<uint8_t>& file, std::string_view type, const std::vector<uint8_t>& data) {
+	appendBigEndian(file, uint32_t(data.size()));
+
+	size_t start = file.size();
+	file.insert(file.end(), type.begin(), type.end());
+	file.insert(file.end(), data.begin(), data.end());
+
+	uint32_t crc = 0xFFFFFFFFu;
+	for(size_t i = start; i < file.size(); ++i) crc = crcTable[(crc ^ file[i]) & 0xFF] ^ (crc >> 8);
+	appendBigEndian(file, crc ^ 0xFFFFFFFFu);
+}
+
+bool writePng(const std::filesystem::path& path, const Image& image) {
+	// Every row starts with the filter type, zero means no filtering
+	std::vector<uint8_t> raw;
+	raw.reserve((size_t(image.width) * 4 + 1) * image.height);
+	for(unsigned y = 0; y < image.height; ++y) {
+		raw.push_back(0);
+		for(unsigned x = 0; x < image.width; ++x) {
+			uint32_t pixel = image.pixels[(size_t(y) * image.width) + x];
+			raw.push_back(uint8_t(pixel));
+			raw.push_back(uint8_t(pixel >> 8));
+			raw.push_back(uint8_t(pixel >> 16));
+			raw.push_back(uint8_t(pixel >> 24));
+		}
+	}
+
+	// Zlib stream made of stored deflate blocks, which hold at most 65535 bytes each
+	std::vector<uint8_t> zlib = { 0x78, 0x01 };
+	for(size_t offset = 0;; offset += 0xFFFF) {
+		auto length = uint16_t(std::min<size_t>(raw.size() - offset, 0xFFFF));
+		bool last = offset + length >= raw.size();
+		zlib.push_back(last ? 1 : 0);
+		zlib.push_back(uint8_t(length));
+		zlib.push_back(uint8_t(length >> 8));
+		zlib.push_back(uint8_t(~length));
+		zlib.push_back(uint8_t(~length >> 8));
+		zlib.insert(zlib.end(), raw.begin() + ptrdiff_t(offset), raw.begin() + ptrdiff_t(offset + length));
+		if(last) break;
+	}
+
+	uint32_t a = 1;
+	uint32_t b = 0;
+	for(uint8_t byte : raw) {
+		a = (a + byte) % 65521;
+		b = (b + a) % 65521;
+	}
+	appendBigEndian(zlib, (b << 16) | a);
+
+	std::vector<uint8_t> header;
+	appendBigEndian(header, image.width);
+	appendBigEndian(header, image.height);
+	header.insert(header.end(), { 8, 6, 0, 0, 0 }); // 8 bit RGBA, no interlacing
+
+	std::vector<uint8_t> file = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	appendChunk(file, "IHDR", header);
+	appendChunk(file, "IDAT", zlib);
+	appendChunk(file, "IEND", {});
+
+	std::ofstream stream(path, std::ios::binary);
+	stream.write(reinterpret_cast<const char*>(file.data()), std::streamsize(file.size()));
+	return bool(stream);
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <filesystem>
+
+#include "rendering/image.hpp"
+
+// Writes an RGBA8 PNG, the image data is stored without compression to keep the writer small
+bool writePng(const std::filesystem::path& path, const Image& image);
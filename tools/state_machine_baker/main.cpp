@@ -0,0 +1,68 @@
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <print>
+#include <string>
+#include <vector>
+
+#include "animation/state_machine.hpp"
+#include "animation/state_machine_builder.hpp"
+
+namespace fs = std::filesystem;
+
+static void printUsage() {
+	std::println("Usage: state_machine_baker <input directory> <output directory>");
+	std::println("Bakes every JSON state machine in the input directory into <output directory>/<name>.bin");
+}
+
+int main(int argc, char** argv) {
+	if(argc != 3) {
+		printUsage();
+		return 1;
+	}
+
+	fs::path input = argv[1];
+	fs::path output = argv[2];
+	std::error_code error;
+	fs::create_directories(output, error);
+
+	size_t count = 0;
+	for(const auto& entry : fs::directory_iterator(input, error)) {
+		if(!entry.is_regular_file() || entry.path().extension() != ".json") continue;
+
+		std::ifstream stream(entry.path());
+		std::string json((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+		if(!stream) {
+			std::println(stderr, "Could not read {}", entry.path().string());
+			return 1;
+		}
+
+		std::string parseError;
+		std::optional<StateMachineDefinition> definition = parseStateMachine(json, parseError);
+		if(!definition) {
+			std::println(stderr, "{}: {}", entry.path().string(), parseError);
+			return 1;
+		}
+
+		fs::path bakedPath = output / entry.path().filename().replace_extension(".bin");
+		std::vector<std::byte> baked = bakeStateMachine(*definition);
+		std::ofstream bakedStream(bakedPath, std::ios::binary);
+		bakedStream.write(reinterpret_cast<const char*>(baked.data()), std::streamsize(baked.size()));
+		if(!bakedStream) {
+			std::println(stderr, "Could not write {}", bakedPath.string());
+			return 1;
+		}
+
+		std::println(
+		    "{}: {} states, {} transitions, {} bytes", entry.path().filename().string(), definition->states.size(), definition->transitions.size(),
+		    baked.size()
+		);
+		++count;
+	}
+
+	if(error || count == 0) {
+		std::println(stderr, "No state machines found in {}", input.string());
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,147 @@
+#include <array>
+#include <initializer_list>
+#include <vector>
+
+#include "harness.hpp"
+#include "rendering/atlas_residency.hpp"
+
+namespace {
+	using PageState = AtlasResidency::PageState;
+
+	constexpr size_t PageBytes = 100;
+
+	// Does what SpriteAtlas::updateResidency does with the textures, a load started in one frame finishes in the next
+	struct FakeLoader {
+		AtlasResidency residency;
+		std::vector<bool> loaded;
+		std::vector<unsigned> pending;
+		std::vector<unsigned> loads;
+		std::vector<unsigned> evictions;
+
+		FakeLoader(size_t pageCount, size_t budget) : residency(std::vector<size_t>(pageCount, PageBytes), budget), loaded(pageCount, false) {
+			// Like the atlas, the first page is loaded before the first frame
+			residency.pin(0);
+			frame();
+			residency.finishLoad(0);
+			pending.clear();
+		}
+
+		void frame() {
+			for(unsigned page : pending) residency.finishLoad(page);
+			pending.clear();
+
+			residency.endFrame(loads, evictions);
+			for(unsigned page : evictions) {
+				CHECK(loaded[page]);
+				loaded[page] = false;
+			}
+			for(unsigned page : loads) {
+				CHECK(!loaded[page]);
+				loaded[page] = true;
+				pending.push_back(page);
+			}
+		}
+
+		// Uses the pages until they are all resident
+		void useAll(std::initializer_list<unsigned> pages) {
+			for(unsigned attempt = 0; attempt < 4; ++attempt) {
+				bool resident = true;
+				for(unsigned page : pages) resident = residency.use(page) && resident;
+				frame();
+				if(resident) return;
+			}
+			test::fail("The pages did not become resident");
+		}
+	};
+
+	Sprite createSprite(uint16_t index, unsigned page) {
+		return Sprite(index, page, 0, 0, 8, 8, 64, 64, false, 0, 0, 8, 8);
+	}
+} // namespace
+
+TEST(atlasResidencyEvictsLeastRecentlyUsed) {
+	FakeLoader loader(5, 3 * PageBytes);
+	loader.useAll({ 1 });
+	loader.useAll({ 2 });
+	CHECK(loader.residency.getCommittedBytes() == 3 * PageBytes);
+
+	// Page 1 was used after page 2, so page 2 is the one that makes room
+	loader.useAll({ 1 });
+	loader.useAll({ 3 });
+	CHECK(loader.residency.getState(1) == PageState::Resident);
+	CHECK(loader.residency.getState(2) == PageState::Unloaded);
+	CHECK(loader.residency.getState(3) == PageState::Resident);
+	CHECK(!loader.loaded[2]);
+
+	loader.useAll({ 4 });
+	CHECK(loader.residency.getState(1) == PageState::Unloaded);
+	CHECK(loader.residency.getState(3) == PageState::Resident);
+	CHECK(loader.residency.getCommittedBytes() <= loader.residency.getBudget());
+	CHECK(loader.residency.getStats().evictions == 2);
+}
+
+TEST(atlasResidencyKeepsPinnedPages) {
+	FakeLoader loader(3, 2 * PageBytes);
+	CHECK(loader.residency.getState(0) == PageState::Resident);
+
+	// Page 0 is never used here and still stays, even when the budget only has room for one page
+	for(unsigned frame = 0; frame < 4; ++frame) loader.useAll({ 1 + (frame % 2) });
+	loader.residency.setBudget(PageBytes);
+	loader.frame();
+	CHECK(loader.residency.getState(0) == PageState::Resident);
+	CHECK(loader.residency.getState(1) == PageState::Unloaded);
+	CHECK(loader.residency.getState(2) == PageState::Unloaded);
+	CHECK(loader.residency.getCommittedBytes() == PageBytes);
+}
+
+TEST(atlasResidencyDropsUnusedRequests) {
+	FakeLoader loader(4, 2 * PageBytes);
+	loader.useAll({ 1 });
+
+	// Page 1 is in use, so neither request fits, page 2 is asked for again and page 3 is not
+	CHECK(!loader.residency.use(2));
+	CHECK(!loader.residency.use(3));
+	CHECK(loader.residency.use(1));
+	loader.frame();
+	CHECK(loader.loads.empty());
+	CHECK(loader.residency.getState(2) == PageState::Requested);
+
+	CHECK(!loader.residency.use(2));
+	loader.frame();
+	CHECK(loader.residency.getState(2) == PageState::Loading);
+	CHECK(loader.residency.getState(3) == PageState::Unloaded);
+	CHECK(loader.residency.getState(1) == PageState::Unloaded);
+
+	// A dropped page is requested again the next time it is drawn
+	loader.useAll({ 3 });
+	CHECK(loader.residency.getState(3) == PageState::Resident);
+	CHECK(loader.residency.getStats().loads == 4);
+}
+
+TEST(atlasResidencyDrawsFallback) {
+	constexpr uint16_t Fallback = 0;
+	const std::array<Sprite, 3> sprites = { createSprite(0, 0), createSprite(1, 0), createSprite(2, 1) };
+	std::array<SpriteDrawable, 3> drawables;
+	for(size_t i = 0; i < drawables.size(); ++i) drawables[i].sprite = uint16_t(i + 1);
+
+	FakeLoader loader(2, 2 * PageBytes);
+	std::vector<SpriteDrawable> scratch;
+
+	// Sprite 2 is on a page that is not loaded yet, the sprite that does not exist is left out either way
+	std::span<const SpriteDrawable> resolved = loader.residency.resolve(drawables, sprites, Fallback, scratch);
+	CHECK(resolved.data() == scratch.data());
+	CHECK(resolved.size() == 2);
+	CHECK(resolved[0].sprite == 1);
+	CHECK(resolved[1].sprite == Fallback);
+	CHECK(resolved[1].translation == drawables[1].translation);
+
+	resolved = loader.residency.resolve(drawables, sprites, std::nullopt, scratch);
+	CHECK(resolved.size() == 1);
+	CHECK(resolved[0].sprite == 1);
+	CHECK(loader.residency.getStats().misses == 2);
+
+	loader.frame();
+	loader.frame();
+	resolved = loader.residency.resolve(drawables, sprites, Fallback, scratch);
+	CHECK(resolved.data() == drawables.data());
+}
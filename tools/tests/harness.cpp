@@ -0,0 +1,95 @@
+#include "harness.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <print>
+#include <set>
+#include <string>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+
+#include "png_writer.hpp"
+
+namespace {
+	struct Case {
+		std::string_view name;
+		test::Function function;
+	};
+
+	std::vector<Case>& getCases() {
+		static std::vector<Case> cases;
+		return cases;
+	}
+
+	size_t s_failures = 0;
+	bool s_updateGolden = false;
+	// Only the first image of a name is written, the ones after it are compared with that
+	std::set<std::string, std::less<>> s_updatedGolden;
+} // namespace
+
+test::Registration::Registration(std::string_view name, Function function) {
+	getCases().push_back({ .name = name, .function = function });
+}
+
+void test::fail(std::string_view message, std::source_location location) {
+	std::println(stderr, "{}:{}: {}", location.file_name(), location.line(), message);
+	++s_failures;
+}
+
+void test::checkNear(double value, double expected, double tolerance, std::string_view expression, std::source_location location) {
+	if(std::abs(value - expected) <= tolerance) return;
+	fail(std::format("{} (got {}, expected {} within {})", expression, value, expected, tolerance), location);
+}
+
+void test::checkGolden(std::string_view name, const Image& image, std::source_location location) {
+	std::filesystem::path path = std::filesystem::path(GOLDEN_DIR) / std::format("{}.png", name);
+	if(s_updateGolden && !s_updatedGolden.contains(name)) {
+		if(!writePng(path, image)) fail(std::format("Could not write {}", path.string()), location);
+		s_updatedGolden.emplace(name);
+		return;
+	}
+
+	int width = 0;
+	int height = 0;
+	int channels = 0;
+	stbi_uc* data = stbi_load(path.string().c_str(), &width, &height, &channels, 4);
+	bool matches = data && unsigned(width) == image.width && unsigned(height) == image.height
+	               && std::memcmp(data, image.pixels.data(), image.pixels.size() * sizeof(uint32_t)) == 0;
+	stbi_image_free(data);
+	if(matches) return;
+
+	std::string actual = std::format("{}_actual.png", name);
+	writePng(actual, image);
+	fail(std::format("{} does not match {}, the result was written to {}", name, path.string(), actual), location);
+}
+
+int main(int argc, char** argv) {
+	std::string_view filter;
+	for(int i = 1; i < argc; ++i) {
+		std::string_view arg = argv[i];
+		if(arg == "--update-golden") {
+			s_updateGolden = true;
+		} else {
+			filter = arg;
+		}
+	}
+
+	size_t failedCases = 0;
+	size_t ran = 0;
+	for(const Case& testCase : getCases()) {
+		if(!testCase.name.contains(filter)) continue;
+
+		size_t failures = s_failures;
+		testCase.function();
+		++ran;
+		if(s_failures != failures) {
+			std::println(stderr, "FAILED {}", testCase.name);
+			++failedCases;
+		}
+	}
+
+	std::println("{} of {} cases passed", ran - failedCases, ran);
+	return failedCases == 0 ? 0 : 1;
+}
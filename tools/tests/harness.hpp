@@ -0,0 +1,42 @@
+#pragma once
+
+#include <filesystem>
+#include <source_location>
+#include <string_view>
+
+#include "rendering/image.hpp"
+
+// Tests and benchmarks register themselves before main runs, main runs every case whose name contains the filter given on the command line
+// A failed check is reported and the case keeps running, the executable fails when any check did
+namespace test {
+	using Function = void (*)();
+
+	struct Registration {
+		Registration(std::string_view name, Function function);
+	};
+
+	void fail(std::string_view message, std::source_location location = std::source_location::current());
+
+	inline void check(bool passed, std::string_view expression, std::source_location location = std::source_location::current()) {
+		if(!passed) fail(expression, location);
+	}
+
+	void checkNear(
+	    double value, double expected, double tolerance, std::string_view expression, std::source_location location = std::source_location::current()
+	);
+
+	// Compares the image with tools/tests/golden/<name>.png, --update-golden writes the first image of every name there instead
+	// A mismatching image is written next to the executable as <name>_actual.png
+	void checkGolden(std::string_view name, const Image& image, std::source_location location = std::source_location::current());
+} // namespace test
+
+#define TEST(name)                                                    \
+	static void name();                                               \
+	static const test::Registration name##Registration(#name, &name); \
+	static void name()
+
+// Benchmarks print their own results, they are cases of the benchmark executable
+#define BENCHMARK(name) TEST(name)
+
+#define CHECK(expression) test::check(bool(expression), #expression)
+#define CHECK_NEAR(value, expected, tolerance) test::checkNear(double(value), double(expected), double(tolerance), #value " ~ " #expected)
@@ -0,0 +1,51 @@
+#include <array>
+#include <chrono>
+#include <print>
+
+#include "harness.hpp"
+#include "rasterizer_fixture.hpp"
+#include "rendering/software_rasterizer.hpp"
+#include "thread_pool.hpp"
+
+// Full screen frames of many sprites from the fixture atlas, for every kernel on the thread pool
+BENCHMARK(rasterizerThroughput) {
+	constexpr unsigned SpriteCount = 2000;
+	constexpr unsigned FrameCount = 60;
+	constexpr glm::uvec2 Dimensions = glm::uvec2(1920, 1080);
+
+	RasterizerFixture fixture = createRasterizerFixture();
+	std::vector<SpriteDrawable> drawables;
+	for(unsigned i = 0; i < SpriteCount; ++i) {
+		SpriteDrawable drawable;
+		drawable.sprite = uint16_t(i % RasterizerFixture::SpriteCount);
+		float scale = 2.0f + float(i % 5);
+		drawable.setTransform({
+		    .x = glm::vec2(16.0f * scale, 0.0f),
+		    .y = glm::vec2(0.0f, 16.0f * scale),
+		    .translation = glm::vec2(float((i * 97) % Dimensions.x), float((i * 61) % Dimensions.y)),
+		});
+		drawables.push_back(drawable);
+	}
+
+	ThreadPool threadPool;
+	constexpr std::array<std::string_view, 3> KernelNames = { "Scalar", "SSE2", "AVX2" };
+	for(auto kernel : { SoftwareRasterizer::Kernel::Scalar, SoftwareRasterizer::Kernel::Sse2, SoftwareRasterizer::Kernel::Avx2 }) {
+		SoftwareRasterizer rasterizer(&threadPool);
+		if(!rasterizer.setKernel(kernel)) continue;
+
+		rasterizer.drawSprites(fixture.pages, fixture.sprites, glm::vec2(0.0f), Dimensions, drawables);
+		rasterizer.resetStats();
+		for(unsigned frame = 0; frame < FrameCount; ++frame)
+			rasterizer.drawSprites(fixture.pages, fixture.sprites, glm::vec2(0.0f), Dimensions, drawables);
+
+		const SoftwareRasterizer::Stats& stats = rasterizer.getStats();
+		std::println(
+		    "Software rasterizer ({}, {} threads): {:.2f} ms/frame, {:.0f} sprites/s, {:.1f} MP/s",
+		    KernelNames[size_t(kernel)],
+		    threadPool.getThreadCount() + 1,
+		    stats.seconds * 1000.0 / double(stats.frames),
+		    stats.getSpritesPerSecond(),
+		    stats.getMegapixelsPerSecond()
+		);
+	}
+}
@@ -0,0 +1,122 @@
+#include "rasterizer_fixture.hpp"
+
+namespace {
+	constexpr uint32_t Background = 0xffff00ff;
+
+	uint32_t pack(unsigned r, unsigned g, unsigned b, unsigned a) {
+		// The atlas is premultiplied
+		return ((r * a / 255) << 0) | ((g * a / 255) << 8) | ((b * a / 255) << 16) | (a << 24);
+	}
+
+	// A gradient that tells every pixel apart, with transparent pixels and pixels on both sides of the alpha test
+	Image createSource(unsigned width, unsigned height, unsigned seed, glm::uvec4 content) {
+		Image image = { .width = width, .height = height, .pixels = std::vector<uint32_t>(size_t(width) * height, 0u) };
+		for(unsigned y = content.y; y < content.y + content.w; ++y) {
+			for(unsigned x = content.x; x < content.x + content.z; ++x) {
+				unsigned pattern = ((x * 3) + (y * 5) + seed) % 11;
+				unsigned alpha = pattern == 0 ? 0 : pattern == 1 ? 0x7f : pattern == 2 ? 0x80 : 0xff;
+				image.pixels[(size_t(y) * width) + x] = pack(40 + (x * 200 / width), 40 + (y * 200 / height), seed * 50, alpha);
+			}
+		}
+		return image;
+	}
+
+	// Copies the trimmed part of the source into the page, rotated sprites are turned clockwise like the atlas packer does
+	Sprite packSprite(Image& page, unsigned pageIndex, const Image& source, glm::uvec2 position, glm::uvec4 content, bool rotated, unsigned index) {
+		unsigned rectWidth = rotated ? content.w : content.z;
+		unsigned rectHeight = rotated ? content.z : content.w;
+		for(unsigned y = 0; y < content.w; ++y) {
+			for(unsigned x = 0; x < content.z; ++x) {
+				glm::uvec2 texel = rotated ? glm::uvec2(position.x + rectWidth - 1 - y, position.y + x) : position + glm::uvec2(x, y);
+				page.pixels[(size_t(texel.y) * page.width) + texel.x] = source.pixels[(size_t(content.y + y) * source.width) + content.x + x];
+			}
+		}
+
+		return Sprite(
+		    index,
+		    pageIndex,
+		    position.x,
+		    position.y,
+		    rectWidth,
+		    rectHeight,
+		    page.width,
+		    page.height,
+		    rotated,
+		    content.x,
+		    content.y,
+		    source.width,
+		    source.height
+		);
+	}
+
+	SpriteDrawable createDrawable(uint16_t sprite, glm::vec2 x, glm::vec2 y, glm::vec2 center) {
+		SpriteDrawable drawable;
+		drawable.sprite = sprite;
+		drawable.setTransform({ .x = x, .y = y, .translation = center });
+		return drawable;
+	}
+} // namespace
+
+RasterizerFixture createRasterizerFixture() {
+	RasterizerFixture fixture;
+	fixture.pages.push_back({ .width = 64, .height = 64, .pixels = std::vector<uint32_t>(size_t(64) * 64, Background) });
+	fixture.pages.push_back({ .width = 32, .height = 32, .pixels = std::vector<uint32_t>(size_t(32) * 32, Background) });
+
+	struct Definition {
+		glm::uvec2 size;
+		glm::uvec4 content;
+		unsigned page;
+		glm::uvec2 position;
+		bool rotated;
+	};
+
+	constexpr Definition Definitions[RasterizerFixture::SpriteCount] = {
+		{ .size = { 16, 16 }, .content = { 0, 0, 16, 16 }, .page = 0, .position = { 0, 0 }, .rotated = false },
+		{ .size = { 12, 20 }, .content = { 0, 0, 12, 20 }, .page = 0, .position = { 17, 0 }, .rotated = true },
+		{ .size = { 24, 24 }, .content = { 6, 4, 10, 14 }, .page = 0, .position = { 0, 21 }, .rotated = false },
+		{ .size = { 20, 16 }, .content = { 5, 2, 8, 12 }, .page = 0, .position = { 17, 21 }, .rotated = true },
+		{ .size = { 8, 8 }, .content = { 0, 0, 8, 8 }, .page = 1, .position = { 4, 4 }, .rotated = false },
+	};
+
+	for(unsigned i = 0; i < RasterizerFixture::SpriteCount; ++i) {
+		const Definition& definition = Definitions[i];
+		Image& page = fixture.pages[definition.page];
+		fixture.sources.push_back(createSource(definition.size.x, definition.size.y, i, definition.content));
+		fixture.sprites.push_back(
+		    packSprite(page, definition.page, fixture.sources.back(), definition.position, definition.content, definition.rotated, i)
+		);
+	}
+
+	// Every sprite as it is, then scaled, rotated, flipped, overlapping each other, across tiles and partly off screen
+	// The rotations are written out so the result does not depend on the math library
+	constexpr float Cos30 = 0.8660254f;
+	constexpr float Sin30 = 0.5f;
+	constexpr float Cos45 = 0.70710677f;
+
+	for(uint16_t i = 0; i < RasterizerFixture::SpriteCount; ++i) fixture.drawables.push_back(placeSprite(fixture, i, glm::ivec2(2 + (i * 26), 2)));
+
+	using Id = RasterizerFixture::SpriteId;
+	fixture.drawables.push_back(createDrawable(Id::Plain, glm::vec2(40.0f, 0.0f), glm::vec2(0.0f, 40.0f), glm::vec2(30.3f, 60.7f)));
+	fixture.drawables.push_back(
+	    createDrawable(Id::Rotated, glm::vec2(12.0f * Cos30, 12.0f * Sin30), glm::vec2(-20.0f * Sin30, 20.0f * Cos30), glm::vec2(70.0f, 50.0f))
+	);
+	fixture.drawables.push_back(createDrawable(Id::Trimmed, glm::vec2(-36.0f, 0.0f), glm::vec2(0.0f, 36.0f), glm::vec2(100.5f, 56.25f)));
+	fixture.drawables.push_back(
+	    createDrawable(Id::RotatedTrimmed, glm::vec2(40.0f * Cos45, -40.0f * Cos45), glm::vec2(32.0f * Cos45, 32.0f * Cos45), glm::vec2(64.0f, 64.0f))
+	);
+	fixture.drawables.push_back(createDrawable(Id::SecondPage, glm::vec2(30.0f, 0.0f), glm::vec2(0.0f, -30.0f), glm::vec2(128.0f, 64.0f)));
+	fixture.drawables.push_back(createDrawable(Id::Plain, glm::vec2(24.0f, 0.0f), glm::vec2(0.0f, 24.0f), glm::vec2(-4.0f, 110.0f)));
+	fixture.drawables.push_back(createDrawable(Id::Rotated, glm::vec2(0.0f, 24.0f), glm::vec2(-40.0f, 0.0f), glm::vec2(158.0f, 100.0f)));
+	fixture.drawables.push_back(createDrawable(Id::Trimmed, glm::vec2(17.0f, 3.0f), glm::vec2(-2.0f, 15.0f), glm::vec2(40.0f, 100.0f)));
+	// Neither of these draws anything
+	fixture.drawables.push_back(
+	    createDrawable(RasterizerFixture::SpriteCount, glm::vec2(16.0f, 0.0f), glm::vec2(0.0f, 16.0f), glm::vec2(80.0f, 100.0f))
+	);
+	fixture.drawables.push_back(createDrawable(Id::Plain, glm::vec2(16.0f, 16.0f), glm::vec2(8.0f, 8.0f), glm::vec2(100.0f, 100.0f)));
+	return fixture;
+}
+
+SpriteDrawable placeSprite(const RasterizerFixture& fixture, uint16_t sprite, glm::ivec2 pixel) {
+	glm::vec2 size = glm::vec2(fixture.sources[sprite].width, fixture.sources[sprite].height);
+	return createDrawable(sprite, glm::vec2(size.x, 0.0f), glm::vec2(0.0f, size.y), glm::vec2(pixel) + (size * 0.5f));
+}
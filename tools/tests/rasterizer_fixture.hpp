@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+
+#include "math.hpp"
+#include "rendering/image.hpp"
+#include "rendering/sprite.hpp"
+#include "rendering/sprite_drawable.hpp"
+
+// Two atlas pages with plain, rotated and trimmed sprites, and a frame that draws them scaled, rotated, flipped and partly off screen
+// Everything outside the sprites is opaque magenta, so sampling outside of a sprite shows up in the result
+struct RasterizerFixture {
+	enum SpriteId : uint16_t { Plain, Rotated, Trimmed, RotatedTrimmed, SecondPage, SpriteCount };
+
+	std::vector<Image> pages;
+	std::vector<Sprite> sprites;
+	// What every sprite looks like before it is trimmed and packed
+	std::vector<Image> sources;
+
+	glm::uvec2 dimensions = glm::uvec2(160, 120);
+	std::vector<SpriteDrawable> drawables;
+};
+
+[[nodiscard]] RasterizerFixture createRasterizerFixture();
+// Draws the sprite at its source size with its top left corner on the pixel
+[[nodiscard]] SpriteDrawable placeSprite(const RasterizerFixture& fixture, uint16_t sprite, glm::ivec2 pixel);
@@ -0,0 +1,72 @@
+#include <array>
+#include <format>
+#include <print>
+
+#include "harness.hpp"
+#include "rasterizer_fixture.hpp"
+#include "rendering/software_rasterizer.hpp"
+#include "thread_pool.hpp"
+
+namespace {
+	constexpr std::array<SoftwareRasterizer::Kernel, 3> Kernels = {
+		SoftwareRasterizer::Kernel::Scalar,
+		SoftwareRasterizer::Kernel::Sse2,
+		SoftwareRasterizer::Kernel::Avx2,
+	};
+
+	constexpr std::array<std::string_view, 3> KernelNames = { "scalar", "sse2", "avx2" };
+
+	bool selectKernel(SoftwareRasterizer& rasterizer, SoftwareRasterizer::Kernel kernel) {
+		if(rasterizer.setKernel(kernel)) return true;
+		std::println("Skipped the {} kernel, the CPU does not support it", KernelNames[size_t(kernel)]);
+		return false;
+	}
+} // namespace
+
+// Drawn at their source size, sprites have to come out exactly like their source images, however they were trimmed and rotated
+TEST(rasterizerDrawsSourceImages) {
+	RasterizerFixture fixture = createRasterizerFixture();
+	const glm::ivec2 offset = glm::ivec2(3, 5);
+
+	for(SoftwareRasterizer::Kernel kernel : Kernels) {
+		SoftwareRasterizer rasterizer;
+		if(!selectKernel(rasterizer, kernel)) continue;
+
+		for(uint16_t sprite = 0; sprite < RasterizerFixture::SpriteCount; ++sprite) {
+			SpriteDrawable drawable = placeSprite(fixture, sprite, offset);
+			rasterizer.drawSprites(fixture.pages, fixture.sprites, glm::vec2(0.0f), glm::uvec2(40, 40), std::span(&drawable, 1));
+
+			const Image& source = fixture.sources[sprite];
+			const Image& framebuffer = rasterizer.getFramebuffer();
+			size_t mismatches = 0;
+			for(unsigned y = 0; y < framebuffer.height; ++y) {
+				for(unsigned x = 0; x < framebuffer.width; ++x) {
+					glm::ivec2 texel = glm::ivec2(x, y) - offset;
+					bool inside = texel.x >= 0 && texel.y >= 0 && unsigned(texel.x) < source.width && unsigned(texel.y) < source.height;
+					uint32_t expected = inside ? source.pixels[(size_t(texel.y) * source.width) + texel.x] : 0u;
+					if(expected < 0x80000000u) expected = 0u;
+					if(framebuffer.pixels[(size_t(y) * framebuffer.width) + x] != expected) ++mismatches;
+				}
+			}
+
+			if(mismatches != 0)
+				test::fail(std::format("Sprite {} has {} wrong pixels with the {} kernel", sprite, mismatches, KernelNames[size_t(kernel)]));
+		}
+	}
+}
+
+// The full frame through every kernel, on the thread pool and on the calling thread
+TEST(rasterizerMatchesGolden) {
+	RasterizerFixture fixture = createRasterizerFixture();
+	ThreadPool threadPool(3);
+
+	for(ThreadPool* pool : { static_cast<ThreadPool*>(nullptr), &threadPool }) {
+		for(SoftwareRasterizer::Kernel kernel : Kernels) {
+			SoftwareRasterizer rasterizer(pool);
+			if(!selectKernel(rasterizer, kernel)) continue;
+
+			rasterizer.drawSprites(fixture.pages, fixture.sprites, glm::vec2(0.0f), fixture.dimensions, fixture.drawables);
+			test::checkGolden("rasterizer", rasterizer.getFramebuffer());
+		}
+	}
+}
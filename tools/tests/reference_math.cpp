@@ -0,0 +1,37 @@
+#include "reference_math.hpp"
+
+#include <cmath>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+glm::mat4 squashReference(const SquashSettings& settings, const glm::mat4& transform, float t, float intensity) {
+	float jiggle = intensity * settings.amplitude * std::sin(t * settings.frequency * glm::two_pi<float>()) * std::exp(-settings.falloff * t);
+	glm::vec2 scale(1.0f / (1.0f + jiggle), 1.0f + jiggle);
+	glm::mat4 squash = glm::translate(glm::mat4(1.0f), glm::vec3(settings.origin, 0.0f));
+	squash = glm::translate(glm::scale(squash, glm::vec3(scale, 1.0f)), glm::vec3(-settings.origin, 0.0f));
+	return transform * squash;
+}
+
+glm::vec2 transformPointReference(const glm::mat4& matrix, glm::vec2 point) {
+	return glm::vec2(matrix * glm::vec4(point, 0.0f, 1.0f));
+}
+
+BoundingBox transformBoundsReference(const glm::mat4& matrix, const BoundingBox& box) {
+	BoundingBox bounds = { .min = glm::vec2(INFINITY), .max = glm::vec2(-INFINITY) };
+	for(glm::vec2 corner : { box.min, glm::vec2(box.max.x, box.min.y), glm::vec2(box.min.x, box.max.y), box.max }) {
+		glm::vec2 transformed = transformPointReference(matrix, corner);
+		bounds.min = glm::min(bounds.min, transformed);
+		bounds.max = glm::max(bounds.max, transformed);
+	}
+	return bounds;
+}
+
+BoundingBox computeQuadBoundsReference(const SpriteDrawable& drawable) {
+	glm::mat4 quad = glm::mat4(
+	    glm::vec4(drawable.basis.x, drawable.basis.y, 0.0f, 0.0f),
+	    glm::vec4(drawable.basis.z, drawable.basis.w, 0.0f, 0.0f),
+	    glm::vec4(0.0f, 0.0f, 1.0f, 0.0f),
+	    glm::vec4(drawable.translation, 0.0f, 1.0f)
+	);
+	return transformBoundsReference(quad, { .min = glm::vec2(-0.5f), .max = glm::vec2(0.5f) });
+}
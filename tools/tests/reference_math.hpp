@@ -0,0 +1,16 @@
+#pragma once
+
+#include "animation/squash_system.hpp"
+#include "math.hpp"
+#include "physics/bounding_box.hpp"
+#include "rendering/sprite_drawable.hpp"
+
+// The glm::mat4 code that the optimized paths replaced, the tests compare against it and the benchmarks time it
+
+// The matrix Squisher built t seconds into a jiggle, multiplied with the transform of the drawable
+[[nodiscard]] glm::mat4 squashReference(const SquashSettings& settings, const glm::mat4& transform, float t, float intensity);
+
+// The transform kernels as mat4 code, every corner of a box is transformed on its own
+[[nodiscard]] glm::vec2 transformPointReference(const glm::mat4& matrix, glm::vec2 point);
+[[nodiscard]] BoundingBox transformBoundsReference(const glm::mat4& matrix, const BoundingBox& box);
+[[nodiscard]] BoundingBox computeQuadBoundsReference(const SpriteDrawable& drawable);
@@ -0,0 +1,57 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <print>
+#include <vector>
+
+#include "harness.hpp"
+#include "physics/clickable_region.hpp"
+
+// Moves a number of overlapping pets around for some frames and then keeps them still, merging only happens while they move
+BENCHMARK(clickableRegionThroughput) {
+	using Clock = std::chrono::steady_clock;
+	using Milliseconds = std::chrono::duration<double, std::milli>;
+
+	constexpr unsigned PetCount = 256;
+	constexpr unsigned FrameCount = 500;
+
+	// A round blob of rows, about what the mask of a pet sprite turns into
+	std::vector<IntBoundingBox> mask;
+	for(int y = -32; y < 32; y += 4) {
+		int halfWidth = int(std::sqrt(float((32 * 32) - ((y + 2) * (y + 2)))));
+		mask.push_back({ .min = glm::ivec2(-halfWidth, y), .max = glm::ivec2(halfWidth, y + 4) });
+	}
+
+	ClickableRegion region;
+	auto runFrames = [&](bool moving) {
+		Clock::time_point start = Clock::now();
+		for(unsigned frame = 0; frame < FrameCount; ++frame) {
+			for(unsigned pet = 0; pet < PetCount; ++pet) {
+				// Pets are packed close enough to overlap their neighbours
+				glm::ivec2 position = glm::ivec2(int(pet % 32) * 48, int(pet / 32) * 48);
+				if(moving) position.x += int((frame * (pet % 7 + 1)) % 200);
+				region.add(mask, position);
+			}
+			if(region.update()) region.markSubmitted();
+		}
+		return Milliseconds(Clock::now() - start).count() / double(FrameCount);
+	};
+
+	double movingMilliseconds = runFrames(true);
+	ClickableRegion::Stats moving = region.getStats();
+	double idleMilliseconds = runFrames(false);
+	ClickableRegion::Stats idle = region.getStats();
+
+	std::println(
+	    "Clickable region: {} pets, {} rects merged into {}, moving {:.3f} ms/frame with {} submissions, idle {:.3f} ms/frame with {} merges and {} "
+	    "submissions",
+	    PetCount,
+	    PetCount * mask.size(),
+	    region.getRects().size(),
+	    movingMilliseconds,
+	    moving.submissions,
+	    idleMilliseconds,
+	    idle.merges - moving.merges,
+	    idle.submissions - moving.submissions
+	);
+}
@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <format>
+#include <vector>
+
+#include "harness.hpp"
+#include "physics/clickable_region.hpp"
+#include "physics/rect_region.hpp"
+
+namespace {
+	// Every test rect lies within this area
+	constexpr glm::ivec2 AreaMin = glm::ivec2(-16);
+	constexpr glm::ivec2 AreaMax = glm::ivec2(64);
+
+	IntBoundingBox rect(int minX, int minY, int maxX, int maxY) {
+		return { .min = glm::ivec2(minX, minY), .max = glm::ivec2(maxX, maxY) };
+	}
+
+	// How many of the rects cover each pixel of the area
+	std::vector<int> rasterize(std::span<const IntBoundingBox> rects) {
+		glm::ivec2 size = AreaMax - AreaMin;
+		std::vector<int> pixels(size_t(size.x) * size_t(size.y), 0);
+		for(const IntBoundingBox& rect : rects) {
+			for(int y = std::max(rect.min.y, AreaMin.y); y < std::min(rect.max.y, AreaMax.y); ++y) {
+				for(int x = std::max(rect.min.x, AreaMin.x); x < std::min(rect.max.x, AreaMax.x); ++x)
+					++pixels[(size_t(y - AreaMin.y) * size.x) + (x - AreaMin.x)];
+			}
+		}
+		return pixels;
+	}
+
+	// The region has to cover exactly the pixels of the union, with every pixel in a single rect
+	void checkUnion(std::span<const IntBoundingBox> rects, std::string_view name) {
+		RectRegion region;
+		region.build(rects);
+
+		std::vector<int> expected = rasterize(rects);
+		std::ranges::transform(expected, expected.begin(), [](int count) { return count > 0 ? 1 : 0; });
+		if(rasterize(region.getRects()) != expected) test::fail(std::format("The {} region does not cover the union of its rects", name));
+
+		for(const IntBoundingBox& result : region.getRects())
+			if(result.min.x >= result.max.x || result.min.y >= result.max.y) test::fail(std::format("The {} region has an empty rect", name));
+
+		// The same pixels in any order and split up differently give the same rects
+		std::vector<IntBoundingBox> reversed(rects.rbegin(), rects.rend());
+		RectRegion reversedRegion;
+		reversedRegion.build(reversed);
+		if(!(reversedRegion == region)) test::fail(std::format("The {} region depends on the order of its rects", name));
+
+		std::vector<IntBoundingBox> pixelRows;
+		glm::ivec2 size = AreaMax - AreaMin;
+		for(int y = 0; y < size.y; ++y) {
+			for(int x = 0; x < size.x; ++x) {
+				if(expected[(size_t(y) * size.x) + x] != 0)
+					pixelRows.push_back(rect(x + AreaMin.x, y + AreaMin.y, x + AreaMin.x + 1, y + AreaMin.y + 1));
+			}
+		}
+		RectRegion pixelRegion;
+		pixelRegion.build(pixelRows);
+		if(!(pixelRegion == region)) test::fail(std::format("The {} region differs when it is built from single pixels", name));
+	}
+} // namespace
+
+TEST(rectRegionMatchesPixelUnion) {
+	checkUnion({}, "empty");
+	checkUnion(std::vector{ rect(0, 0, 0, 8), rect(4, 4, 2, 8), rect(3, 3, 3, 3) }, "degenerate");
+	checkUnion(std::vector{ rect(0, 0, 8, 8) }, "single");
+	checkUnion(std::vector{ rect(0, 0, 8, 8), rect(4, 4, 12, 12), rect(2, 2, 6, 6) }, "overlapping");
+	checkUnion(std::vector{ rect(0, 0, 8, 8), rect(8, 0, 16, 8), rect(0, 8, 16, 12) }, "touching");
+	checkUnion(std::vector{ rect(0, 0, 8, 4), rect(0, 10, 8, 14), rect(20, 2, 24, 12) }, "gaps between bands");
+	checkUnion(std::vector{ rect(0, 0, 30, 30), rect(10, 10, 20, 20) }, "contained");
+	checkUnion(std::vector{ rect(-10, -10, 2, 2), rect(-4, 0, 0, 40), rect(0, 0, 0, 0) }, "negative");
+
+	// Touching rects of the same height end up as one
+	RectRegion region;
+	const std::vector<IntBoundingBox> touching = { rect(0, 0, 8, 8), rect(8, 0, 16, 8) };
+	region.build(touching);
+	CHECK(region.getRects().size() == 1);
+
+	// Scattered rects from a fixed seed, so a failure is always the same case
+	uint32_t seed = 1;
+	auto next = [&](int range) {
+		seed = (seed * 1664525u) + 1013904223u;
+		return int((seed >> 8) % uint32_t(range));
+	};
+	std::vector<IntBoundingBox> rects;
+	for(unsigned round = 0; round < 50; ++round) {
+		rects.clear();
+		unsigned count = 1 + unsigned(next(12));
+		for(unsigned i = 0; i < count; ++i) {
+			glm::ivec2 min = AreaMin + glm::ivec2(next(60), next(60));
+			rects.push_back({ .min = min, .max = min + glm::ivec2(next(16), next(16)) });
+		}
+		checkUnion(rects, std::format("random {}", round));
+	}
+}
+
+TEST(clickableRegionReportsChanges) {
+	const std::vector<IntBoundingBox> mask = { rect(0, 0, 8, 4), rect(-2, 4, 10, 12) };
+	ClickableRegion region;
+
+	// The first frame is always new, the same rects after it are not
+	region.add(mask, glm::ivec2(10, 10));
+	region.add(mask, glm::ivec2(14, 12));
+	CHECK(region.update());
+	region.markSubmitted();
+
+	for(unsigned frame = 0; frame < 3; ++frame) {
+		region.add(mask, glm::ivec2(10, 10));
+		region.add(mask, glm::ivec2(14, 12));
+		CHECK(!region.update());
+	}
+	CHECK(region.getStats().merges == 1);
+
+	// Swapping the two pets changes the rects but not the region
+	region.add(mask, glm::ivec2(14, 12));
+	region.add(mask, glm::ivec2(10, 10));
+	CHECK(!region.update());
+	CHECK(region.getStats().merges == 2);
+
+	region.add(mask, glm::ivec2(11, 10));
+	region.add(mask, glm::ivec2(14, 12));
+	CHECK(region.update());
+	// Until the region was submitted it keeps being reported
+	region.add(mask, glm::ivec2(11, 10));
+	region.add(mask, glm::ivec2(14, 12));
+	CHECK(region.update());
+	region.markSubmitted();
+
+	CHECK(region.getStats().submissions == 2);
+
+	// Once every pet is gone the region is empty, which is a change as well
+	CHECK(region.update());
+	CHECK(region.getRects().empty());
+}
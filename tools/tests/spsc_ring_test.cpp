@@ -0,0 +1,61 @@
+#include <cstdint>
+#include <limits>
+#include <thread>
+
+#include "harness.hpp"
+#include "spsc_ring.hpp"
+
+TEST(spscRingFullAndEmpty) {
+	SpscRing<uint32_t, 4> ring;
+	CHECK(!ring.pop());
+
+	for(uint32_t i = 0; i < 4; ++i) CHECK(ring.push(i));
+	CHECK(!ring.push(4));
+
+	// Popping one makes room for exactly one more
+	CHECK(ring.pop() == 0u);
+	CHECK(ring.push(4));
+	CHECK(!ring.push(5));
+
+	for(uint32_t i = 1; i < 5; ++i) CHECK(ring.pop() == i);
+	CHECK(!ring.pop());
+}
+
+// The indices run past UINT32_MAX while the ring is full, which only works because the capacity divides 2^32
+TEST(spscRingWrapsIndices) {
+	SpscRing<uint32_t, 4> ring(std::numeric_limits<uint32_t>::max() - 1);
+	for(uint32_t round = 0; round < 3; ++round) {
+		for(uint32_t i = 0; i < 4; ++i) CHECK(ring.push((round * 4) + i));
+		CHECK(!ring.push(0));
+		for(uint32_t i = 0; i < 4; ++i) CHECK(ring.pop() == (round * 4) + i);
+		CHECK(!ring.pop());
+	}
+}
+
+// The consumer has to see every value once and in order while the producer keeps filling the ring, the indices wrap on the way
+TEST(spscRingKeepsOrderAcrossThreads) {
+	constexpr uint32_t Count = 1 << 20;
+	SpscRing<uint32_t, 64> ring(std::numeric_limits<uint32_t>::max() - 1000);
+
+	std::thread producer([&]() {
+		for(uint32_t i = 0; i < Count; ++i) {
+			while(!ring.push(i)) std::this_thread::yield();
+		}
+	});
+
+	uint32_t expected = 0;
+	bool ordered = true;
+	while(expected < Count) {
+		std::optional<uint32_t> value = ring.pop();
+		if(!value) {
+			std::this_thread::yield();
+			continue;
+		}
+		ordered = ordered && *value == expected;
+		++expected;
+	}
+	producer.join();
+
+	CHECK(ordered);
+	CHECK(!ring.pop());
+}
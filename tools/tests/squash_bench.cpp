@@ -0,0 +1,72 @@
+#include <chrono>
+#include <glm/gtc/matrix_transform.hpp>
+#include <print>
+#include <vector>
+
+#include "affine2d.hpp"
+#include "harness.hpp"
+#include "reference_math.hpp"
+#include "time.hpp"
+
+// The time per thousand drawables of the squash system next to building the matrices like Squisher did
+BENCHMARK(squashThroughput) {
+	using Clock = std::chrono::steady_clock;
+	using Milliseconds = std::chrono::duration<double, std::milli>;
+
+	constexpr unsigned DrawableCount = 4096;
+	constexpr unsigned FrameCount = 600;
+	constexpr double FrameTime = 1.0 / 60.0;
+	constexpr SquashSettings Settings = { .amplitude = 0.25f, .frequency = 5.0f, .falloff = 14.0f, .origin = glm::vec2(0.0f, 0.5f) };
+
+	SquashSystem system;
+	std::vector<SpriteDrawable> drawables(DrawableCount);
+	std::vector<SquashSystem::Handle> handles(DrawableCount);
+	for(unsigned i = 0; i < DrawableCount; ++i) handles[i] = system.add(Settings, drawables[i]);
+	std::vector<double> starts(DrawableCount, 0.0);
+	std::vector<float> intensities(DrawableCount, 0.0f);
+
+	std::vector<glm::mat4> transforms(DrawableCount);
+	for(unsigned i = 0; i < DrawableCount; ++i) {
+		glm::vec3 translation = glm::vec3(float(i % 64) * 48.0f, float(i / 64) * 48.0f, 0.0f);
+		transforms[i] = glm::scale(glm::translate(glm::mat4(1.0f), translation), glm::vec3(96.0f, 96.0f, 1.0f));
+	}
+
+	// Starting the jiggles and resetting the transforms is part of both loops
+	Time time;
+	auto beginFrame = [&](unsigned frame) {
+		time.set(double(frame) * FrameTime, float(FrameTime));
+		for(unsigned i = 0; i < DrawableCount; ++i) {
+			if((frame + i) % 60 == 0) {
+				intensities[i] = i % 2 == 0 ? 2.5f : -1.0f;
+				starts[i] = time.time();
+				system.squish(handles[i], time, intensities[i]);
+			}
+			drawables[i].setTransform(Affine2D::fromMatrix(transforms[i]));
+		}
+	};
+
+	Clock::time_point start = Clock::now();
+	for(unsigned frame = 0; frame < FrameCount; ++frame) {
+		beginFrame(frame);
+		for(unsigned i = 0; i < DrawableCount; ++i) {
+			float t = float(time.time() - starts[i]);
+			drawables[i].setTransform(Affine2D::fromMatrix(squashReference(Settings, transforms[i], t, intensities[i])));
+		}
+	}
+	double matrixMilliseconds = Milliseconds(Clock::now() - start).count();
+
+	start = Clock::now();
+	for(unsigned frame = 0; frame < FrameCount; ++frame) {
+		beginFrame(frame);
+		system.update(time);
+	}
+	double systemMilliseconds = Milliseconds(Clock::now() - start).count();
+
+	double thousands = double(DrawableCount) * double(FrameCount) / 1000.0;
+	std::println(
+	    "Squash: {} drawables, matrices {:.4f} ms per thousand, system {:.4f} ms per thousand",
+	    DrawableCount,
+	    matrixMilliseconds / thousands,
+	    systemMilliseconds / thousands
+	);
+}
@@ -0,0 +1,54 @@
+#include <algorithm>
+#include <glm/gtc/matrix_transform.hpp>
+#include <vector>
+
+#include "affine2d.hpp"
+#include "harness.hpp"
+#include "reference_math.hpp"
+#include "time.hpp"
+
+// Two seconds of jiggles have to come out like the matrices of Squisher did, within a thousandth of a pixel
+TEST(squashSystemMatchesMatrices) {
+	constexpr unsigned Count = 256;
+	constexpr double FrameTime = 1.0 / 60.0;
+	constexpr SquashSettings Settings = { .amplitude = 0.25f, .frequency = 5.0f, .falloff = 14.0f, .origin = glm::vec2(0.0f, 0.5f) };
+
+	SquashSystem system;
+	std::vector<SpriteDrawable> drawables(Count);
+	std::vector<SquashSystem::Handle> handles(Count);
+	for(unsigned i = 0; i < Count; ++i) handles[i] = system.add(Settings, drawables[i]);
+	std::vector<double> starts(Count, 0.0);
+	std::vector<float> intensities(Count, 0.0f);
+
+	// Sprite sized and laid out in rows
+	std::vector<glm::mat4> transforms(Count);
+	for(unsigned i = 0; i < Count; ++i) {
+		glm::vec3 translation = glm::vec3(float(i % 16) * 48.0f, float(i / 16) * 48.0f, 0.0f);
+		transforms[i] = glm::scale(glm::translate(glm::mat4(1.0f), translation), glm::vec3(96.0f, 96.0f, 1.0f));
+	}
+
+	Time time;
+	float maxError = 0.0f;
+	for(unsigned frame = 0; frame < 120; ++frame) {
+		time.set(double(frame) * FrameTime, float(FrameTime));
+		for(unsigned i = 0; i < Count; ++i) {
+			// The jiggles start at different times so the frames cover the whole curve, squishing stretches first and squashing flattens first
+			if((frame + i) % 60 == 0) {
+				intensities[i] = i % 2 == 0 ? 2.5f : -1.0f;
+				starts[i] = time.time();
+				system.squish(handles[i], time, intensities[i]);
+			}
+			// Like the entities, the transforms are set again every frame before the system applies the squash
+			drawables[i].setTransform(Affine2D::fromMatrix(transforms[i]));
+		}
+		system.update(time);
+
+		for(unsigned i = 0; i < Count; ++i) {
+			SpriteDrawable expected;
+			expected.setTransform(Affine2D::fromMatrix(squashReference(Settings, transforms[i], float(time.time() - starts[i]), intensities[i])));
+			float error = glm::length(drawables[i].basis - expected.basis) + glm::length(drawables[i].translation - expected.translation);
+			maxError = std::max(maxError, error);
+		}
+	}
+	CHECK_NEAR(maxError, 0.0f, 1e-3f);
+}
@@ -0,0 +1,70 @@
+#include <algorithm>
+#include <chrono>
+#include <glm/gtc/matrix_transform.hpp>
+#include <print>
+#include <vector>
+
+#include "affine2d.hpp"
+#include "cpu_features.hpp"
+#include "harness.hpp"
+#include "reference_math.hpp"
+#include "transform_kernels.hpp"
+
+// The time per thousand elements of every kernel next to the glm::mat4 code it replaces
+BENCHMARK(transformThroughput) {
+	using Clock = std::chrono::steady_clock;
+	using Milliseconds = std::chrono::duration<double, std::milli>;
+
+	constexpr unsigned Count = 4096;
+	constexpr unsigned Iterations = 1000;
+
+	const Affine2D transform = Affine2D::translate(glm::vec2(300.0f, 200.0f)) * Affine2D::rotate(0.3f) * Affine2D::scale(glm::vec2(2.0f, -1.5f));
+	glm::mat4 matrix = glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(300.0f, 200.0f, 0.0f)), 0.3f, glm::vec3(0.0f, 0.0f, 1.0f));
+	matrix = glm::scale(matrix, glm::vec3(2.0f, -1.5f, 1.0f));
+
+	// Points spread over a screen, boxes and drawables of sprite size
+	std::vector<glm::vec2> inputPoints(Count);
+	std::vector<BoundingBox> boxes(Count);
+	std::vector<SpriteDrawable> drawables(Count);
+	for(unsigned i = 0; i < Count; ++i) {
+		inputPoints[i] = glm::vec2(float((i * 7919) % 1920), float((i * 104729) % 1080));
+		boxes[i] = { .min = inputPoints[i], .max = inputPoints[i] + glm::vec2(float(i % 64 + 1), float(i % 48 + 1)) };
+		Affine2D placement = Affine2D::translate(inputPoints[i]) * Affine2D::rotate(float(i % 360));
+		drawables[i].setTransform(placement * Affine2D::scale(glm::vec2(float(i % 128 + 16))));
+	}
+
+	std::vector<glm::vec2> points(Count);
+	std::vector<BoundingBox> bounds(Count);
+
+	auto measure = [&](auto&& function) {
+		Clock::time_point start = Clock::now();
+		for(unsigned i = 0; i < Iterations; ++i) function();
+		return Milliseconds(Clock::now() - start).count() * 1000.0 / (double(Count) * double(Iterations));
+	};
+
+	double matrixPoints = measure([&]() {
+		for(unsigned i = 0; i < Count; ++i) points[i] = transformPointReference(matrix, inputPoints[i]);
+	});
+	double kernelPoints = measure([&]() { transform_kernels::transformPoints(transform, inputPoints, points); });
+	double matrixBounds = measure([&]() {
+		for(unsigned i = 0; i < Count; ++i) bounds[i] = transformBoundsReference(matrix, boxes[i]);
+	});
+	double kernelBounds = measure([&]() { transform_kernels::transformBounds(transform, boxes, bounds); });
+	double matrixQuads = measure([&]() {
+		for(unsigned i = 0; i < Count; ++i) bounds[i] = computeQuadBoundsReference(drawables[i]);
+	});
+	double kernelQuads = measure([&]() { transform_kernels::computeQuadBounds(drawables, bounds); });
+
+	std::println(
+	    "Transform kernels ({}): {} elements, mat4 and kernel ms per thousand: points {:.4f} and {:.4f}, bounds {:.4f} and {:.4f}, sprite quads "
+	    "{:.4f} and {:.4f}",
+	    cpu_features::hasAvx() ? "AVX" : "SSE",
+	    Count,
+	    matrixPoints,
+	    kernelPoints,
+	    matrixBounds,
+	    kernelBounds,
+	    matrixQuads,
+	    kernelQuads
+	);
+}
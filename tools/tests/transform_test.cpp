@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <glm/gtc/matrix_transform.hpp>
+#include <vector>
+
+#include "affine2d.hpp"
+#include "harness.hpp"
+#include "reference_math.hpp"
+#include "transform_kernels.hpp"
+
+namespace {
+	// Tolerance of every kernel against the mat4 path, in pixels
+	constexpr float Tolerance = 1e-3f;
+
+	// The same transform as the Affine2D the kernels take and as the glm::mat4 they replace
+	const Affine2D Transform = Affine2D::translate(glm::vec2(300.0f, 200.0f)) * Affine2D::rotate(0.3f) * Affine2D::scale(glm::vec2(2.0f, -1.5f));
+
+	glm::mat4 getMatrix() {
+		glm::mat4 matrix = glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(300.0f, 200.0f, 0.0f)), 0.3f, glm::vec3(0.0f, 0.0f, 1.0f));
+		return glm::scale(matrix, glm::vec3(2.0f, -1.5f, 1.0f));
+	}
+
+	// Spread over a screen
+	glm::vec2 getPoint(unsigned i) {
+		return glm::vec2(float((i * 7919) % 1920), float((i * 104729) % 1080));
+	}
+
+	float getBoxError(const BoundingBox& a, const BoundingBox& b) {
+		return std::max(glm::length(a.min - b.min), glm::length(a.max - b.max));
+	}
+} // namespace
+
+// A count that is not a multiple of the vector width, so the scalar tail runs as well
+TEST(transformKernelsMatchMatrices) {
+	constexpr unsigned Count = 1027;
+	const glm::mat4 matrix = getMatrix();
+
+	// Boxes and drawables of sprite size
+	std::vector<glm::vec2> inputPoints(Count);
+	std::vector<BoundingBox> boxes(Count);
+	std::vector<SpriteDrawable> drawables(Count);
+	for(unsigned i = 0; i < Count; ++i) {
+		inputPoints[i] = getPoint(i);
+		boxes[i] = { .min = inputPoints[i], .max = inputPoints[i] + glm::vec2(float(i % 64 + 1), float(i % 48 + 1)) };
+		Affine2D placement = Affine2D::translate(inputPoints[i]) * Affine2D::rotate(float(i % 360));
+		drawables[i].setTransform(placement * Affine2D::scale(glm::vec2(float(i % 128 + 16))));
+	}
+
+	std::vector<glm::vec2> points(Count);
+	transform_kernels::transformPoints(Transform, inputPoints, points);
+	float pointError = 0.0f;
+	for(unsigned i = 0; i < Count; ++i)
+		pointError = std::max(pointError, glm::length(points[i] - transformPointReference(matrix, inputPoints[i])));
+	CHECK_NEAR(pointError, 0.0f, Tolerance);
+
+	std::vector<BoundingBox> bounds(Count);
+	transform_kernels::transformBounds(Transform, boxes, bounds);
+	float boundsError = 0.0f;
+	for(unsigned i = 0; i < Count; ++i)
+		boundsError = std::max(boundsError, getBoxError(bounds[i], transformBoundsReference(matrix, boxes[i])));
+	CHECK_NEAR(boundsError, 0.0f, Tolerance);
+
+	std::vector<BoundingBox> quads(Count);
+	transform_kernels::computeQuadBounds(drawables, quads);
+	float quadError = 0.0f;
+	BoundingBox merged = { .min = glm::vec2(INFINITY), .max = glm::vec2(-INFINITY) };
+	for(unsigned i = 0; i < Count; ++i) {
+		BoundingBox expected = computeQuadBoundsReference(drawables[i]);
+		quadError = std::max(quadError, getBoxError(quads[i], expected));
+		merged = { .min = glm::min(merged.min, quads[i].min), .max = glm::max(merged.max, quads[i].max) };
+	}
+	CHECK_NEAR(quadError, 0.0f, Tolerance);
+	CHECK(transform_kernels::mergeBounds(quads) == merged);
+
+	// The output may be the input itself
+	transform_kernels::transformPoints(Transform, inputPoints, inputPoints);
+	CHECK(inputPoints == points);
+	transform_kernels::transformBounds(Transform, boxes, boxes);
+	CHECK(boxes == bounds);
+}
+
+TEST(transformKernelsHandleEmptyInput) {
+	std::vector<glm::vec2> points;
+	transform_kernels::transformPoints(Transform, points, points);
+	BoundingBox merged = transform_kernels::mergeBounds({});
+	CHECK(merged.min.x > merged.max.x && merged.min.y > merged.max.y);
+}
+
+TEST(affine2dInverse) {
+	Affine2D identity = Transform.inverse() * Transform;
+	for(unsigned i = 0; i < 64; ++i) CHECK_NEAR(glm::length(identity.apply(getPoint(i)) - getPoint(i)), 0.0f, Tolerance);
+	CHECK_NEAR(Transform.getDeterminant(), 2.0f * -1.5f, 1e-5f);
+}